@@ -1,71 +1,124 @@
 /**********************************************************
  * Reads in the hit charge and time information from file 
  * and runs through the steps in the reconstruction.
+ * Usage: clever geometry.csv pdf.csv hits.csv [results.bin|-] [nThreads]
+ * (see libtexthitreader.hpp for the file formats)
  * *******************************************************/
 
 #include <iostream>
-#include <libhitinfo.hpp>
-#include <libhitselect.hpp>
+#include <thread>
+#include <memory>
 #include <libgeometry.hpp>
 #include <libconstants.hpp>
-#include <libtestpointcalc.hpp>
+#include <libpdf.hpp>
+#include <libeventhits.hpp>
+#include <libeventloop.hpp>
+#include <libboundedqueue.hpp>
+#include <libtexthitreader.hpp>
+#include <libreconstructioncontext.hpp>
 
-int main(){
+#include "clever.hpp"
+
+int main(int argc, char **argv){
+
+	if (argc < 4)
+	{
+		printf("usage: %s geometry.csv pdf.csv hits.csv [results.bin|-] [nThreads]\n",argv[0]);
+		return -1;
+	}
 
 	// Get number of PMTs in detector, plus x, y and z positions of all of them.
-	int nPMTs = 0;
+	TextHitReader hitReader;
 	vector<float> pmt_x;
 	vector<float> pmt_y;
 	vector<float> pmt_z;
+	int nPMTs = hitReader.ReadGeometry(argv[1],pmt_x,pmt_y,pmt_z);
+	if (nPMTs <= 0)
+	{
+		printf("can't read the PMT positions from %s\n",argv[1]);
+		return -1;
+	}
 	
 	// Set the inner-volume geometry using the detector PMT information.
 	Geometry geo;
 	geo.SetGeometry(nPMTs,pmt_x,pmt_y,pmt_z);
-	float traverseTmax = geo.max_traverse_time();
-	float dTmax = geo.max_pmt_deltaT();
-	float dRmax = geo.max_pmt_deltaR();
-	float zmax = geo.search_radius();
-	float rmax2 = geo.search_height();
-
-//	for (int hit=0;hit<nevents;hit++ TODO will need to loop over events.
-	
-	// Get number of hits, plus time, charge, pmtx, pmty and pmtz for all hits.
-	//TODO feed in a set of values for the hit information
-	
-	// Select the hits which will be used to calculate starting points (initial
-	// test vertices) for the search.
-	HitSelect select;
-	int nhits = 0;
-	vector<float> times;
-	vector<float>charges;
-	vector<float> pmtx;
-	vector<float> pmty;
-	vector<float> pmtz;
-	vector<HitInfo> hitinfo;
+	geo.SetAttenuationLength(hitReader.AttenuationLength());
 
-	int nselected =	select.SelectHits(nhits,times,charges,pmtx,pmty,pmtz,hitinfo,traverseTmax,dTmax,dRmax);
+	// Get the time-residual pdf.
+	TimeResidualPDF pdf;
+	vector<float> pdfVector;
+	float tMin, tMax;
+	if (hitReader.ReadPDF(argv[2],pdfVector,tMin,tMax) < 0)
+	{
+		printf("can't read the time-residual pdf from %s\n",argv[2]);
+		return -1;
+	}
+	pdf.SetPDF(pdfVector,tMin,tMax);
 
-	// Make sure at least 4 hits have made the final selection.
-	if (nselected<=libConstants::min_selected_hits)
+	if (hitReader.Open(argv[3]) < 0)
 	{
-		return(-1); //continue; TODO when looping over events
+		printf("can't open %s\n",argv[3]);
+		return -1;
 	}
 
-	// TODO info logging - cout hitinfo for the selected hits.
+	// The reconstruction runs as a pipeline, as in clever_rat: a reader 
+	// thread parses the hits file in chunks, a pool of workers reconstructs
+	// the events and a writer thread writes the results.
+	BoundedQueue<EventHits> hitsQueue(libConstants::sQueueCapacity);
+	BoundedQueue<ReconstructedEvent> resultQueue(libConstants::sQueueCapacity);
+	EventDispatcher dispatcher(hitsQueue);
+	// The results are written in input order, so the reader may only get 
+	// as far ahead of the writer as the writer can hold results.
+	int nThreads = (argc > 5) ? atoi(argv[5]) : libConstants::sNThreads;
+	EventLoop loop(nThreads);
+	dispatcher.SetMaxPending(MaxPendingEvents(loop.NThreads()));
+
+	// Reader: get number of hits, plus time, charge, pmtx, pmty and pmtz for
+	// all hits of each event. The dispatcher sends them on most expensive
+	// first. With sUseTrigger, each event is a stream of hits which is 
+	// split into candidate events first.
+	thread reader([&] ()
+	{
+		EventHits hits;
+		SlidingWindowTrigger trigger;
+		vector<EventHits> candidatesVector;
+		int nhits;
+		while ((nhits = hitReader.ReadEvent(hits)) >= 0)
+		{
+			DispatchEvent(hits, trigger, candidatesVector, dispatcher);
+		}
+		if (nhits == TextHitReader::sParseError)
+		{
+			printf("%s: can't read event at line %d, stopping\n",argv[3],hitReader.LineNumber());
+		}
+		dispatcher.Close();
+	});
 
-	// Calculate the initial test vertices fr the search.
-	TestPointCalc testpointcalc;
-	vector<vector<float>> testpoints;
-	testpointcalc.CalculateTestPoints(hitinfo,  rmax2, zmax, testpoints);
+	// Writer: write the vertex and additional variables of each event to
+	// the results file, or print them.
+	const char* resultsFilename = (argc > 4) ? argv[4] : NULL;
+	thread writer([&] ()
+	{
+		WriteResults(resultQueue, dispatcher, resultsFilename);
+	});
 
-	// TODO perform the maximum likelihood fit starting from the final list
-	// of testpoints calculated in the previous steps.
-	// Initial search
-	// Coarse search
-	// Fine search
-	// Final search
+	// Workers: each thread has its own reconstruction context. The loops of
+	// large events are shared between the workers by the scheduler.
+	TaskScheduler scheduler(loop.NThreads());
+	vector<unique_ptr<ReconstructionContext>> contexts;
+	for (int iThread = 0; iThread < loop.NThreads(); iThread++)
+	{
+		contexts.push_back(make_unique<ReconstructionContext>(geo, pdf));
+		contexts[iThread]->SetScheduler(scheduler, iThread);
+	}
+	loop.RunWorkers([&] (int thread)
+	{
+		ReconstructEvents(*contexts[thread], scheduler, thread, dispatcher, hitsQueue, resultQueue);
+	});
 
-	// Get the vertex and additional variables.
+	reader.join();
+	resultQueue.Close();
+	writer.join();
 	
 	return 0;
 }
@@ -0,0 +1,179 @@
+#ifndef CLEVER_H
+#define CLEVER_H
+
+/**********************************************************
+ * Definitions shared by the clever executables.
+ * *******************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <thread>
+
+#include <libconstants.hpp>
+#include <libeventhits.hpp>
+#include <libfitresult.hpp>
+#include <libboundedqueue.hpp>
+#include <libreorderbuffer.hpp>
+#include <libresultswriter.hpp>
+#include <libreconstructioncontext.hpp>
+#include <libtaskscheduler.hpp>
+#include <libeventdispatcher.hpp>
+#include <libslidingwindowtrigger.hpp>
+
+// Result passed from the reconstruction workers to the writer, with the
+// position of its event in the input.
+struct ReconstructedEvent
+{
+	long sequence;
+	int nselected;
+	FitResult result;
+};
+
+// Events which can be between the reader and the writer at once: a
+// dispatch window, both queues and a batch on each worker. The writer
+// holds this many results to put them back in input order, and the
+// dispatcher holds the reader back so that no more are pending.
+inline long MaxPendingEvents(int nThreads)
+{
+	return(libConstants::sDispatchWindow + 2*libConstants::sQueueCapacity + nThreads*libConstants::sBatchSize);
+}
+
+inline void PrintResult(ReconstructedEvent& reconstructed)
+{
+	FitResult& result = reconstructed.result;
+	// Skip sub-events with too few selected hits to reconstruct.
+	if (reconstructed.nselected < 0)
+	{
+		printf("event %d sub-event %d: not reconstructed (%d of %d hits selected)\n",result.event,result.subEvent,result.nSelected,result.nHits);
+		return;
+	}
+	printf("event %d sub-event %d: vertex (%4.1f, %4.1f, %4.1f) cm t0 %4.1f ns nll %6.2f n_eff %4.1f goodness %4.2f\n",result.event,result.subEvent,result.x,result.y,result.z,result.t0,result.nll,result.nEffective,result.goodness);
+}
+
+// Reader stage of the pipeline: send an event read from file on to the 
+// workers, first splitting it into candidate events if it is a continuous
+// stream of hits (sUseTrigger).
+inline void DispatchEvent(EventHits& hits, SlidingWindowTrigger& trigger, vector<EventHits>& candidatesVector, EventDispatcher& dispatcher)
+{
+	if (!libConstants::sUseTrigger)
+	{
+		dispatcher.Push(hits);
+		return;
+	}
+	int nCandidates = trigger.SplitEvents(hits, candidatesVector);
+	for (int iCandidate = 0; iCandidate < nCandidates; iCandidate++)
+	{
+		dispatcher.Push(candidatesVector[iCandidate]);
+	}
+}
+
+// Worker stage of the pipeline: take the events waiting in the queue (up to
+// sBatchSize at a time, without waiting for more) and reconstruct them 
+// together, so that small events share the likelihood loops. The events 
+// arrive most expensive first, and a batch is only filled up to 
+// sBatchCostLimit of predicted time, so that expensive events are shared
+// out between the workers. While there are no events waiting, help the 
+// other workers with their large events.
+inline void ReconstructEvents(ReconstructionContext& context, TaskScheduler& scheduler, int thread, EventDispatcher& dispatcher, BoundedQueue<EventHits>& hitsQueue, BoundedQueue<ReconstructedEvent>& resultQueue)
+{
+	vector<EventHits> eventsVector(libConstants::sBatchSize);
+	vector<FitResult> fitResultsVector;
+	vector<int> nSelectedVector;
+	for (;;)
+	{
+		if (!hitsQueue.TryPop(eventsVector[0]))
+		{
+			if (scheduler.RunTask(thread))
+			{
+				continue;
+			}
+			if (!hitsQueue.IsClosed())
+			{
+				this_thread::yield();
+				continue;
+			}
+			// Events pushed before Close may have arrived since.
+			if (!hitsQueue.TryPop(eventsVector[0]))
+			{
+				break;
+			}
+		}
+		int nEvents = 1;
+		float batchCost = dispatcher.PredictCost(eventsVector[0]);
+		while (nEvents < libConstants::sBatchSize && batchCost < libConstants::sBatchCostLimit && hitsQueue.TryPop(eventsVector[nEvents]))
+		{
+			batchCost += dispatcher.PredictCost(eventsVector[nEvents]);
+			nEvents++;
+		}
+		context.ReconstructBatch(eventsVector, nEvents, fitResultsVector, nSelectedVector);
+		for (int iEvent = 0; iEvent < nEvents; iEvent++)
+		{
+			dispatcher.Record(fitResultsVector[iEvent]);
+			ReconstructedEvent reconstructed;
+			reconstructed.sequence = eventsVector[iEvent].sequence;
+			reconstructed.nselected = nSelectedVector[iEvent];
+			reconstructed.result = fitResultsVector[iEvent];
+			resultQueue.Push(reconstructed);
+		}
+	}
+	scheduler.Retire(thread);
+}
+
+// Take the next result in input order, holding back the results which 
+// arrive before it, and tell the dispatcher how far the writer has got. 
+// Returns false once the workers have finished.
+inline bool PopInOrder(BoundedQueue<ReconstructedEvent>& resultQueue, ReorderBuffer<ReconstructedEvent>& reorderBuffer, EventDispatcher& dispatcher, ReconstructedEvent& reconstructed)
+{
+	while (!reorderBuffer.TryPop(reconstructed))
+	{
+		if (!resultQueue.Pop(reconstructed))
+		{
+			return(false);
+		}
+		reorderBuffer.Insert(reconstructed.sequence, reconstructed);
+	}
+	dispatcher.SetNWritten(reorderBuffer.NextSequence());
+	return(true);
+}
+
+// Writer stage of the pipeline: write the results in input order to the
+// columnar results file (see libresultswriter.hpp), or print them if no 
+// file is given ("-"). The dispatcher must limit the pending events
+// (SetMaxPending), which sizes the reorder buffer.
+inline int WriteResults(BoundedQueue<ReconstructedEvent>& resultQueue, EventDispatcher& dispatcher, const char* filename)
+{
+	ReconstructedEvent reconstructed;
+	ReorderBuffer<ReconstructedEvent> reorderBuffer(dispatcher.MaxPending());
+	if (filename == NULL || strcmp(filename, "-") == 0)
+	{
+		while (PopInOrder(resultQueue, reorderBuffer, dispatcher, reconstructed))
+		{
+			PrintResult(reconstructed);
+		}
+		return(0);
+	}
+
+	ResultsWriter writer;
+	if (writer.Open(filename) < 0)
+	{
+		printf("can't write results to %s\n",filename);
+		// Keep taking results so that the reader and workers can finish.
+		while (PopInOrder(resultQueue, reorderBuffer, dispatcher, reconstructed));
+		return(-1);
+	}
+	while (PopInOrder(resultQueue, reorderBuffer, dispatcher, reconstructed))
+	{
+		writer.Add(reconstructed.result, reconstructed.nselected >= 0);
+	}
+	long nWritten = writer.Close();
+	if (nWritten < 0)
+	{
+		printf("error writing results to %s\n",filename);
+		return(-1);
+	}
+	printf("Wrote %ld results to %s\n",nWritten,filename);
+	return(0);
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**********************************************************
+ * Converts a RAT ROOT file to the native columnar hit file
+ * (see libhitfile.hpp), keeping only the PMT id, time and
+ * charge of the inner-PMT hits of each sub-event, so that
+ * repeated reconstruction passes do not have to read the 
+ * ROOT file again.
+ * Usage: clever_convert input.root output.hits
+ * *******************************************************/
+
+#include <iostream>
+
+#include <vector>
+
+#include <libhitfilewriter.hpp>
+
+using namespace std;
+
+/*#include <RAT/DS/Run.hh>
+#include <RAT/DS/PMTInfo.hh>
+#include <RAT/DS/Root.hh>
+#include <RAT/DS/EV.hh>
+#include <RAT/DS/PMT.hh>*/
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TTree.h>
+
+//Need to separate the Inner-Detector tubes from the Outer-Detector tubes
+static const int innerPMTcode = 1;
+
+
+int main(int argc, char **argv){
+
+	if (argc < 3)
+	{
+		printf("usage: %s input.root output.hits\n",argv[0]);
+		return -1;
+	}
+
+	// ROOT stuff
+	TFile *f;
+	TTree *rat_tree,*run_tree;
+	Int_t n_events;
+
+	// rat stuff
+	RAT::DS::Root *ds=new RAT::DS::Root();
+	RAT::DS::Run  *run=new RAT::DS::Run();
+	RAT::DS::EV *ev;
+	RAT::DS::PMTInfo *pmtinfo;
+	RAT::DS::PMT *pmt;
+
+	/***********************************************************************/
+	// Open input file and get trees
+	f= new TFile(argv[1]);
+	
+	rat_tree=(TTree*) f->Get("T");
+	run_tree=(TTree*) f->Get("runT");
+	if (rat_tree==0x0 || run_tree==0x0)
+	{
+		printf("can't find trees T and runT in this file\n");
+		return -1;
+	}
+	rat_tree->SetBranchAddress("ds", &ds);
+	run_tree->SetBranchAddress("run", &run);
+	if (run_tree->GetEntries() != 1)
+	{
+		printf("More than one run! Ignoring all but the geometry for the first run\n");
+	}
+	run_tree->GetEntry(0);
+
+
+	/**********************************************************************/
+	// Number the inner PMTs and store their positions in cm.
+	pmtinfo=run->GetPMTInfo();
+	int nPMTs_all = pmtinfo->GetPMTCount();
+	vector<int> innerIndex(nPMTs_all,-1);
+	vector<float> pmt_x;
+	vector<float> pmt_y;
+	vector<float> pmt_z;
+	for(int pmtindex=0; pmtindex<nPMTs_all; pmtindex++)
+	{
+		if(pmtinfo->GetType(pmtindex)==innerPMTcode)
+		{
+			TVector3 pos = pmtinfo->GetPosition(pmtindex);
+			innerIndex[pmtindex] = pmt_x.size();
+			pmt_x.push_back(pos[0]*0.1);
+			pmt_y.push_back(pos[1]*0.1);
+			pmt_z.push_back(pos[2]*0.1);
+		}
+	}
+
+	HitFileWriter writer;
+	if (writer.SetPMTs(pmt_x,pmt_y,pmt_z) < 0)
+	{
+		printf("too many inner PMTs (%zu) for 16-bit PMT ids\n",pmt_x.size());
+		return -1;
+	}
+
+
+	/************************************************************************/
+	// Store the inner-PMT hits of every sub-event.
+	vector<int> pmtIds;
+	vector<float> times;
+	vector<float> charges;
+	n_events = rat_tree->GetEntries();
+	for (int event = 0; event < n_events; event++)
+	{
+		rat_tree->GetEntry(event);
+		// loop over all subevents
+		for(int sub_event=0;sub_event<ds->GetEVCount();sub_event++)
+		{
+			ev = ds->GetEV(sub_event);
+			pmtIds.clear();
+			times.clear();
+			charges.clear();
+			int nhit =ev->GetPMTCount();
+			// loop over all PMT hits for this subevent
+			for(int hit=0; hit<nhit; hit++)
+			{
+				pmt=ev->GetPMT(hit);
+				int id = pmt->GetID();
+				//only use information from the inner pmts
+				if(innerIndex[id] >= 0)
+				{
+					pmtIds.push_back(innerIndex[id]);
+					times.push_back(pmt->GetTime());
+					charges.push_back(pmt->GetCharge());
+				}
+			}
+			if (writer.AddEvent(event,sub_event,pmtIds,times,charges) < 0)
+			{
+				printf("event %d sub-event %d: hits more than %4.1f ns apart, not stored\n",event,sub_event,libHitFile::sMaximumTimeDelta);
+			}
+		} // End of loop over sub events.
+	}
+
+	if (writer.Write(argv[2]) < 0)
+	{
+		printf("can't write %s\n",argv[2]);
+		return -1;
+	}
+	printf("Wrote %lu events with %lu hits to %s\n",(unsigned long)writer.NEvents(),(unsigned long)writer.NHits(),argv[2]);
+
+	return 0;
+}
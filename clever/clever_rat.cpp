@@ -1,17 +1,27 @@
 /**********************************************************
  * Reads in the hit charge and time information from file 
  * and runs through the steps in the reconstruction.
+ * Usage: clever_rat hits.root|hits.bin pdf.root [results.bin|-]
+ * 			[nThreads] [attenuationLength]
  * *******************************************************/
 
 #include <iostream>
 
 #include <vector>
+#include <thread>
+#include <memory>
 
-#include <libhitinfo.hpp>
-#include <libhitselect.hpp>
 #include <libgeometry.hpp>
 #include <libconstants.hpp>
-#include <libtestpointcalc.hpp>
+#include <libpdf.hpp>
+#include <libeventhits.hpp>
+#include <libfitresult.hpp>
+#include <libeventloop.hpp>
+#include <libboundedqueue.hpp>
+#include <libhitfilereader.hpp>
+#include <libreconstructioncontext.hpp>
+
+#include "clever.hpp"
 
 using namespace std;
 
@@ -26,6 +36,7 @@ using namespace std;
 #include <TROOT.h>
 #include <TFile.h>
 #include <TTree.h>
+#include <TH1.h>
 
 //Need to separate the Inner-Detector tubes from the Outer-Detector tubes
 static const int innerPMTcode = 1;
@@ -54,157 +65,209 @@ int main(int argc, char **argv){
 	RAT::DS::PMT *pmt;
 
 	/***********************************************************************/
-	// Open input file and get trees
-	f= new TFile(argv[1]);
-	
-	rat_tree=(TTree*) f->Get("T");
-	rat_tree->SetBranchAddress("ds", &ds);
-	if (rat_tree==0x0 || run_tree==0x0)
-	{
-		printf("can't find trees T and runT in this file\n");
-		return -1;
-	}
-	
-	run_tree=(TTree*) f->Get("runT");
-	run_tree->SetBranchAddress("run", &run);
-	if (run_tree->GetEntries() != 1)
-	{
-		printf("More than one run! Ignoring all but the geometry for the first run\n");
-	}
-	run_tree->GetEntry(0);
-
+	// The input is either a native hit file (see libhitfile.hpp, written by
+	// clever_convert) or a RAT ROOT file.
+	HitFileReader hitFile;
+	bool nativeInput = (hitFile.Open(argv[1]) >= 0);
 
-	/**********************************************************************/
-	// Set the inner-volume geometry using the detector PMT information.
-
-	// Get number of inner PMTs in detector, plus their x, y and z positions.
-	pmtinfo=run->GetPMTInfo();
-	int nPMTs_all = pmtinfo->GetPMTCount();
 	int nPMTs = 0;
 	vector<float> pmt_x;
 	vector<float> pmt_y;
 	vector<float> pmt_z;
 
-	float pmtBoundR = 0;
-	float pmtBoundZ = 0;
-
-	// Loop over all of the PMTs
-	for(int pmtindex=0; pmtindex<nPMTs_all; pmtindex++)
+	if (nativeInput)
 	{
-		// Get positions of inner PMTs
-		if(pmtinfo->GetType(pmtindex)==innerPMTcode)
+		// The positions of the inner PMTs are stored with the hits.
+		nPMTs = hitFile.NPMTs();
+		for (int pmtindex=0; pmtindex<nPMTs; pmtindex++)
 		{
-			// Positions in cm.
-			vector<float> pos=pmtinfo->GetPosition(pmtindex);
-			pmt_x.push_back(pos[0]);
-			pmt_y.push_back(pos[1]);
-			pmt_z.push_back(pos[2]);
-			// Check the dimensions of the support structure
-			// (we can remove this later as this is done by SetGeometry).
-			if (pos[0]>pmtBoundR) 
-			{
-				pmtBoundR = pos[0];
-			}
-			if (pos[2]>pmtBoundZ) 
-			{
-				pmtBoundZ = pos[2];
-			}
-			nPMTs++;
+			pmt_x.push_back(hitFile.PMTX(pmtindex));
+			pmt_y.push_back(hitFile.PMTY(pmtindex));
+			pmt_z.push_back(hitFile.PMTZ(pmtindex));
 		}
+		printf("Read %lu events from hit file %s\n",(unsigned long)hitFile.NEvents(),argv[1]);
 	}
+	else
+	{
+		/***********************************************************************/
+		// Open input file and get trees
+		f= new TFile(argv[1]);
+	
+		rat_tree=(TTree*) f->Get("T");
+		rat_tree->SetBranchAddress("ds", &ds);
+		if (rat_tree==0x0 || run_tree==0x0)
+		{
+			printf("can't find trees T and runT in this file\n");
+			return -1;
+		}
+	
+		run_tree=(TTree*) f->Get("runT");
+		run_tree->SetBranchAddress("run", &run);
+		if (run_tree->GetEntries() != 1)
+		{
+			printf("More than one run! Ignoring all but the geometry for the first run\n");
+		}
+		run_tree->GetEntry(0);
 
-	printf("Inner PMT boundary (r,z):(%4.1f cm %4.1f, cm)\n",pmtBoundR,pmtBoundZ);
-	printf("Inner search boundary (r,z):(%4.1f cm %4.1f, cm)\n",pmtBoundR-50,pmtBoundZ-50);
 
-	Geometry geo;
-	geo.SetGeometry(nPMTs,pmt_x,pmt_y,pmt_z);
-	float traverseTmax = geo.max_traverse_time();
-	float dTmax = geo.max_pmt_deltaT();
-	float dRmax = geo.max_pmt_deltaR();
-	float zmax = geo.search_radius();
-	float rmax = geo.search_height();
-	float rmax2 = rmax*rmax;
+		/**********************************************************************/
+		// Set the inner-volume geometry using the detector PMT information.
 
-	printf("Inner search boundary from geo (r,z):(%4.1f cm %4.1f, cm)\n",pmtBoundR,pmtBoundZ);
+		// Get number of inner PMTs in detector, plus their x, y and z positions.
+		pmtinfo=run->GetPMTInfo();
+		int nPMTs_all = pmtinfo->GetPMTCount();
 
+		float pmtBoundR = 0;
+		float pmtBoundZ = 0;
 
-	/************************************************************************/
-	// Get number of hits, plus time, charge, pmtx, pmty and pmtz for all hits.
-	
-	int nhits = 0;
-	vector<float> times;
-	vector<float>charges;
-	vector<float> pmtx;
-	vector<float> pmty;
-	vector<float> pmtz;
-  		
-	// TODO Loop over all events.
-	//n_events = rat_tree->GetEntries();
-  	//for (event = 0; event < n_events; event++)
-	// Just look at the first event for now.
-	for (int event = 0; event < 1; event++)
-    {
-		rat_tree->GetEntry(event);
-      	// loop over all subevents
-		for(int sub_event=0;sub_event<ds->GetEVCount();sub_event++)
+		// Loop over all of the PMTs
+		for(int pmtindex=0; pmtindex<nPMTs_all; pmtindex++)
 		{
-			ev = ds->GetEV(sub_event);
-			int nhit =ev->GetPMTCount();
-			// loop over all PMT hits for this subevent
-        	for(int hit=0; hit<nhit; hit++)
-          	{
-          		pmt=ev->GetPMT(hit);
-          		int id = pmt->GetID();
-				//only use information from the inner pmts
-				if(pmtinfo->GetType(id) == innerPMTcode)
-            	{
-					TVector3 pos = pmtinfo->GetPosition(id);
-					pmtx.push_back(pos[0]*0.1);    			//x
-              		pmty.push_back(pos[1]*0.1);       		//y
-					pmtz.push_back(pos[2]*0.1);       		//z
-					times.push_back(pmt->GetTime());   		//t
-					charges.push_back(pmt->GetCharge());	//q
-              		nhits++;
-        		}
+			// Get positions of inner PMTs
+			if(pmtinfo->GetType(pmtindex)==innerPMTcode)
+			{
+				// Positions in cm.
+				vector<float> pos=pmtinfo->GetPosition(pmtindex);
+				pmt_x.push_back(pos[0]);
+				pmt_y.push_back(pos[1]);
+				pmt_z.push_back(pos[2]);
+				// Check the dimensions of the support structure
+				// (we can remove this later as this is done by SetGeometry).
+				if (pos[0]>pmtBoundR) 
+				{
+					pmtBoundR = pos[0];
+				}
+				if (pos[2]>pmtBoundZ) 
+				{
+					pmtBoundZ = pos[2];
+				}
+				nPMTs++;
 			}
-
 		}
 
-	// TODO 
-	for (int i=0;i<nhits;i++)
+		printf("Inner PMT boundary (r,z):(%4.1f cm %4.1f, cm)\n",pmtBoundR,pmtBoundZ);
+		printf("Inner search boundary (r,z):(%4.1f cm %4.1f, cm)\n",pmtBoundR-50,pmtBoundZ-50);
+	}
 
-	
+	Geometry geo;
+	geo.SetGeometry(nPMTs,pmt_x,pmt_y,pmt_z);
+	// The attenuation length of the medium (cm) is not in the run
+	// information, so is given on the command line.
+	geo.SetAttenuationLength((argc > 5) ? atof(argv[5]) : 0);
 
-	
-	// Select the hits which will be used to calculate starting points (initial
-	// test vertices) for the search.
-	vector<HitInfo> hitinfo;
-	HitSelect select;
-	int nselected =	select.SelectHits(nhits,times,charges,pmtx,pmty,pmtz,hitinfo,traverseTmax,dTmax,dRmax);
-
-	// Make sure at least 4 hits have made the final selection.
-	if (nselected<=libConstants::min_selected_hits)
+	printf("Inner search boundary from geo (r,z):(%4.1f cm %4.1f, cm)\n",geo.search_radius(),geo.search_height());
+
+
+	/************************************************************************/
+	// Get the time-residual pdf (histogram "pdf" in the second file).
+	TimeResidualPDF pdf;
+	TFile *pdfFile = new TFile(argv[2]);
+	TH1 *pdfHist = (TH1*) pdfFile->Get("pdf");
+	if (pdfHist==0x0)
+	{
+		printf("can't find the time-residual pdf in %s\n",argv[2]);
+		return -1;
+	}
+	vector<float> pdfVector;
+	for (int bin=1; bin<=pdfHist->GetNbinsX(); bin++)
 	{
-		return(-1); //continue; TODO when looping over events
+		pdfVector.push_back(pdfHist->GetBinContent(bin));
 	}
+	pdf.SetPDF(pdfVector,pdfHist->GetXaxis()->GetXmin(),pdfHist->GetXaxis()->GetXmax());
+	pdfFile->Close();
 
-	// TODO info logging - cout hitinfo for the selected hits.
 
-	// Calculate the initial test vertices fr the search.
-	TestPointCalc testpointcalc;
-	vector<vector<float>> testpoints;
-	testpointcalc.CalculateTestPoints(hitinfo,  rmax2, zmax, testpoints);
+	/************************************************************************/
+	// The reconstruction runs as a pipeline so that reading and decompressing
+	// the file overlaps with the fit: a reader thread decodes the RAT events
+	// into hit lists, a pool of workers reconstructs them and a writer thread
+	// writes the results. The stages are connected by bounded queues, so a 
+	// stage which gets ahead waits for the next one instead of buffering the
+	// whole file.
+	BoundedQueue<EventHits> hitsQueue(libConstants::sQueueCapacity);
+	BoundedQueue<ReconstructedEvent> resultQueue(libConstants::sQueueCapacity);
+	EventDispatcher dispatcher(hitsQueue);
+	// The results are written in input order, so the reader may only get 
+	// as far ahead of the writer as the writer can hold results.
+	int nThreads = (argc > 4) ? atoi(argv[4]) : libConstants::sNThreads;
+	EventLoop loop(nThreads);
+	dispatcher.SetMaxPending(MaxPendingEvents(loop.NThreads()));
+
+	// Reader: get number of hits, plus time, charge, pmtx, pmty and pmtz for
+	// all hits of every sub-event in the file. Only one thread reads, as the
+	// tree can not be read from several threads at once. The dispatcher 
+	// sends the events on most expensive first. With sUseTrigger, each 
+	// sub-event is a stream of hits which is split into candidate events 
+	// first.
+	thread reader([&] ()
+	{
+		SlidingWindowTrigger trigger;
+		vector<EventHits> candidatesVector;
+		if (nativeInput)
+		{
+			// The hits of each event are decoded straight from the mapped file.
+			for (uint64_t index = 0; index < hitFile.NEvents(); index++)
+			{
+				EventHits hits;
+				hitFile.GetEventHits(index, hits);
+				DispatchEvent(hits, trigger, candidatesVector, dispatcher);
+			}
+			dispatcher.Close();
+			return;
+		}
+		n_events = rat_tree->GetEntries();
+		for (int event = 0; event < n_events; event++)
+		{
+			rat_tree->GetEntry(event);
+			// loop over all subevents
+			for(int sub_event=0;sub_event<ds->GetEVCount();sub_event++)
+			{
+				ev = ds->GetEV(sub_event);
+				EventHits hits(event,sub_event);
+				int nhit =ev->GetPMTCount();
+				// loop over all PMT hits for this subevent
+				for(int hit=0; hit<nhit; hit++)
+				{
+					pmt=ev->GetPMT(hit);
+					int id = pmt->GetID();
+					//only use information from the inner pmts
+					if(pmtinfo->GetType(id) == innerPMTcode)
+					{
+						TVector3 pos = pmtinfo->GetPosition(id);
+						hits.add_hit(pmt->GetTime(), pmt->GetCharge(), pos[0]*0.1, pos[1]*0.1, pos[2]*0.1);
+					}
+				}
+				DispatchEvent(hits, trigger, candidatesVector, dispatcher);
+			} // End of loop over sub events.
+		}
+		dispatcher.Close();
+	});
 
-	// TODO perform the maximum likelihood fit starting from the final list
-	// of testpoints calculated in the previous steps.
-	// Initial search
-	// Coarse search
-	// Fine search
-	// Final search
+	// Writer: write the vertex and additional variables of each event to
+	// the results file, or print them.
+	const char* resultsFilename = (argc > 3) ? argv[3] : NULL;
+	thread writer([&] ()
+	{
+		WriteResults(resultQueue, dispatcher, resultsFilename);
+	});
+
+	// Workers: each thread has its own reconstruction context. The loops of
+	// large events are shared between the workers by the scheduler.
+	TaskScheduler scheduler(loop.NThreads());
+	vector<unique_ptr<ReconstructionContext>> contexts;
+	for (int iThread = 0; iThread < loop.NThreads(); iThread++)
+	{
+		contexts.push_back(make_unique<ReconstructionContext>(geo, pdf));
+		contexts[iThread]->SetScheduler(scheduler, iThread);
+	}
+	loop.RunWorkers([&] (int thread)
+	{
+		ReconstructEvents(*contexts[thread], scheduler, thread, dispatcher, hitsQueue, resultQueue);
+	});
 
-	// Get the vertex and additional variables.
-	
-	} // End of loop over sub events.
+	reader.join();
+	resultQueue.Close();
+	writer.join();
 	
 	return 0;
 }
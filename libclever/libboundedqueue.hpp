@@ -0,0 +1,181 @@
+#ifndef LIBBOUNDEDQUEUE_H
+#define LIBBOUNDEDQUEUE_H
+
+//includes
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstddef>
+
+using namespace std;
+
+/*
+ * class BoundedQueue
+ * Fixed-capacity multi-producer, multi-consumer queue which connects the
+ * stages of the reconstruction pipeline (reader, workers, writer).
+ * Each slot carries a sequence number which tells producers and consumers
+ * whether it is free or full, so pushes and pops only need one atomic 
+ * compare-and-swap on the head or tail and no locks.
+ * Push waits while the queue is full, which holds back a fast stage until
+ * the next one catches up (backpressure), so memory stays bounded.
+ * Once the producers have finished, Close lets Pop return false when the
+ * queue has been emptied.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+template <typename T>
+class BoundedQueue
+{
+
+
+	// define the public functions and variables
+	public:
+
+		// The capacity is rounded up to a power of two.
+		BoundedQueue(size_t capacity)
+		{
+			mCapacity = 1;
+			while (mCapacity < capacity)
+			{
+				mCapacity *= 2;
+			}
+			mMask = mCapacity - 1;
+			mSlots.reset(new Slot[mCapacity]);
+			for (size_t i = 0; i < mCapacity; i++)
+			{
+				mSlots[i].sequence.store(i, memory_order_relaxed);
+			}
+			mHead.store(0, memory_order_relaxed);
+			mTail.store(0, memory_order_relaxed);
+			mClosed.store(false, memory_order_relaxed);
+		};
+		~BoundedQueue() {};
+
+		// Add an item if there is a free slot. Returns false if full.
+		bool TryPush(T& item)
+		{
+			size_t position = mTail.load(memory_order_relaxed);
+			for (;;)
+			{
+				Slot& slot = mSlots[position & mMask];
+				size_t sequence = slot.sequence.load(memory_order_acquire);
+				long difference = (long)sequence - (long)position;
+				if (difference == 0)
+				{
+					// The slot is free: claim it by moving the tail on.
+					if (mTail.compare_exchange_weak(position, position+1, memory_order_relaxed))
+					{
+						slot.item = move(item);
+						slot.sequence.store(position+1, memory_order_release);
+						return(true);
+					}
+				}
+				else if (difference < 0)
+				{
+					// The slot still holds an item from one lap ago.
+					return(false);
+				}
+				else
+				{
+					position = mTail.load(memory_order_relaxed);
+				}
+			}
+		}
+
+		// Take the oldest item if there is one. Returns false if empty.
+		bool TryPop(T& item)
+		{
+			size_t position = mHead.load(memory_order_relaxed);
+			for (;;)
+			{
+				Slot& slot = mSlots[position & mMask];
+				size_t sequence = slot.sequence.load(memory_order_acquire);
+				long difference = (long)sequence - (long)(position+1);
+				if (difference == 0)
+				{
+					// The slot is full: claim it by moving the head on.
+					if (mHead.compare_exchange_weak(position, position+1, memory_order_relaxed))
+					{
+						item = move(slot.item);
+						slot.sequence.store(position+mCapacity, memory_order_release);
+						return(true);
+					}
+				}
+				else if (difference < 0)
+				{
+					return(false);
+				}
+				else
+				{
+					position = mHead.load(memory_order_relaxed);
+				}
+			}
+		}
+
+		// Add an item, waiting for a free slot while the queue is full.
+		void Push(T& item)
+		{
+			while (!TryPush(item))
+			{
+				this_thread::yield();
+			}
+		}
+
+		// Take the oldest item, waiting while the queue is empty. Returns
+		// false once the queue has been closed and emptied.
+		bool Pop(T& item)
+		{
+			for (;;)
+			{
+				if (TryPop(item))
+				{
+					return(true);
+				}
+				if (mClosed.load(memory_order_acquire))
+				{
+					// Items pushed before Close may have arrived since.
+					return(TryPop(item));
+				}
+				this_thread::yield();
+			}
+		}
+
+		// Called once all producers have finished.
+		inline void Close(void){
+			mClosed.store(true, memory_order_release);
+		}
+
+		inline bool IsClosed(void){
+			return(mClosed.load(memory_order_acquire));
+		}
+
+		inline size_t Capacity(void){
+			return(mCapacity);
+		}
+
+	// define the private functions and variables
+	private:
+
+		struct Slot
+		{
+			atomic<size_t> sequence;
+			T item;
+		};
+
+		size_t mCapacity;
+		size_t mMask;
+		unique_ptr<Slot[]> mSlots;
+		// Keep the head and tail on separate cache lines so that producers
+		// and consumers do not invalidate each other's line.
+		alignas(64) atomic<size_t> mHead;
+		alignas(64) atomic<size_t> mTail;
+		alignas(64) atomic<bool> mClosed;
+
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**************************************************
+ * Unit tests for BoundedQueue class
+ *
+ * *************************************************/
+
+#include <libboundedqueue.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+namespace{
+
+TEST(BoundedQueueTest,TestFirstInFirstOut){
+
+	// Capacity is rounded up to a power of two, items come out in the
+	// order they went in and a full queue refuses new items.
+	BoundedQueue<int> queue(3);
+	EXPECT_EQ(queue.Capacity(), 4);
+	for (int i = 0; i < 4; i++)
+	{
+		EXPECT_TRUE(queue.TryPush(i));
+	}
+	int item = 99;
+	EXPECT_FALSE(queue.TryPush(item));
+	for (int i = 0; i < 4; i++)
+	{
+		EXPECT_TRUE(queue.TryPop(item));
+		EXPECT_EQ(item, i);
+	}
+	EXPECT_FALSE(queue.TryPop(item));
+
+	// Pop returns false once the queue is closed and empty.
+	item = 7;
+	queue.Push(item);
+	queue.Close();
+	EXPECT_TRUE(queue.Pop(item));
+	EXPECT_EQ(item, 7);
+	EXPECT_FALSE(queue.Pop(item));
+
+}
+
+TEST(BoundedQueueTest,TestManyProducersAndConsumers){
+
+	// Every item pushed by several producers through a small queue is 
+	// popped exactly once by the consumers.
+	BoundedQueue<int> queue(8);
+	int nProducers = 3;
+	int nConsumers = 3;
+	int nItems = 10000;
+	vector<atomic<int>> countVector(nProducers*nItems);
+	for (auto& count : countVector)
+	{
+		count = 0;
+	}
+
+	vector<thread> producerVector;
+	for (int producer = 0; producer < nProducers; producer++)
+	{
+		producerVector.emplace_back([&queue, producer, nItems] ()
+		{
+			for (int i = 0; i < nItems; i++)
+			{
+				int item = producer*nItems + i;
+				queue.Push(item);
+			}
+		});
+	}
+	vector<thread> consumerVector;
+	for (int consumer = 0; consumer < nConsumers; consumer++)
+	{
+		consumerVector.emplace_back([&queue, &countVector] ()
+		{
+			int item;
+			while (queue.Pop(item))
+			{
+				countVector[item]++;
+			}
+		});
+	}
+	for (thread& producer : producerVector)
+	{
+		producer.join();
+	}
+	queue.Close();
+	for (thread& consumer : consumerVector)
+	{
+		consumer.join();
+	}
+
+	for (auto& count : countVector)
+	{
+		EXPECT_EQ(count, 1);
+	}
+
+}
+
+}
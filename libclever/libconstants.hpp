@@ -16,6 +16,52 @@ namespace libConstants{
 	// This is where the runtime settings are defined.
 	const int sUseCharge = 0; // Whether or not to use charge as well as timing
 	const int sUseAngle = 1; // Whether or not to use angular constraint on likelihood
+	const int sInterpolatePDF = 1; // Whether or not to interpolate between pdf bins
+	const float sEventTimeBudget = 0; // Wall-clock budget per event in ms (0 = none)
+	const int sDeadlineCheckInterval = 16; // Test points evaluated between checks of the budget
+	const int sNThreads = 0; // Number of events reconstructed at once (0 = one per core)
+	const int sQueueCapacity = 256; // Events held between pipeline stages
+	const int sTextChunkSize = 1 << 20; // Bytes read at a time from text input
+	const int sResultsBlockSize = 4096; // Events written at a time to the results file
+	const int sBatchSize = 16; // Events taken at a time by each worker
+	// Small events of a batch can have their initial test points ranked 
+	// together by an approximate likelihood (see libeventbatch.hpp), and 
+	// only the best searched. The ranking can end a fit in a different 
+	// basin, so it is off (0 seeds = keep all test points) by default.
+	const int sBatchMaximumHits = 60; // Events with more selected hits are not ranked
+	const int sBatchSeeds = 0; // Initial test points kept for each ranked event
+	// Events with at least this many hits share their loops with idle 
+	// workers, in tasks of the given size (see libtaskscheduler.hpp).
+	const int sParallelMinimumHits = 200;
+	const int sClusterSeedGrain = 4; // Cluster seed hits per task
+	const int sFourHitGrain = 2; // First hits of four-hit combinations per task
+	const int sLikelihoodTileSize = 32; // Test points per likelihood task
+	// Events are sent to the workers most expensive first, sorting each
+	// window of events by the time predicted by the cost model (see 
+	// libcostmodel.hpp). The model is refitted to the measured step times
+	// every calibration interval of events. A worker stops adding events
+	// to its batch once their predicted time reaches the batch limit.
+	const int sDispatchWindow = 256;
+	const int sCostCalibrationInterval = 256;
+	const float sBatchCostLimit = 50; // ms
+	// Starting coefficients of the cost model (ms per unit of each term),
+	// the fraction of hits selected and the number of test points at which
+	// the maximisation term stops growing with the number of combinations.
+	const float sCostSelection = 1e-3;
+	const float sCostCombination = 1e-4;
+	const float sCostFit = 5e-5;
+	const float sCostSelectedFraction = 0.3;
+	const int sCostMaximumTestPoints = 2000;
+	// Treat each event read as a continuous stream of hits and split it 
+	// into candidate events with a sliding-window trigger (see 
+	// libslidingwindowtrigger.hpp): a candidate is formed where more than
+	// sTriggerThreshold hits fall within sTriggerWindow, and takes the hits
+	// from sTriggerPreWindow before to sTriggerPostWindow after the window.
+	const int sUseTrigger = 0;
+	const float sTriggerWindow = 200; // ns
+	const int sTriggerThreshold = 25;
+	const float sTriggerPreWindow = 100; // ns
+	const float sTriggerPostWindow = 300; // ns
 
 	// This is where the basic constants are defined.
 	// These shouldn't need changing.
@@ -65,6 +111,22 @@ namespace libConstants{
 	// Set radial distances of dodecahedron vertices for successive searches.
 	const float sCoarseRmax 	= 50; // cm
 	const float sFineRmax 		= 30; // cm
+	// Shell of new test points placed around each survivor (see libshells.hpp):
+	// 0 = dodecahedron (20), 1 = icosahedron (12), 2 = geodesic (32).
+	const int sShellType = 0;
+	// Rotation of the shell per search stage (0 = same orientation each time).
+	const float sShellRotationAngle = 0; // degrees
+	// Reuse the likelihood of test points which fall within the same grid
+	// cell as a point already evaluated in the event. The cell size is this
+	// fraction of the radius of the shells in the current search.
+	const int sUseLikelihoodCache = 1;
+	const float sCacheResolutionFraction = 0.05;
+	// Reject new test points as soon as their partial likelihood sum shows
+	// that they cannot beat the worst survivor of the last skim (plus the
+	// margin). The sum is checked after each block of hits.
+	const int sUseBoundedNLL = 1;
+	const float sBoundedNLLMargin = 0;
+	const int sBoundedNLLBlockSize = 16;
 	// Set the likelihood skim fraction for successive searches.
 	// TODO This is the fraction to keep/remove?
 	const float sCoarseSkimFraction 	= 0.04;
@@ -75,10 +137,46 @@ namespace libConstants{
 	const float sCoarseDlike	= 0.4;
 	const float sFineDlike		= 0.5;
 	const float sFinalDlike 	= 0.01;
+	// After each skim, merge survivors closer than the radius of the next
+	// search (keeping the best) and keep at most this many basins.
+	const int sUseBasinMerging = 1;
+	const int sMaximumBasins = 20;
+	// Skip the remaining shell searches once the best NLL improves by less
+	// than sConvergenceNLL and the best vertex moves less than 
+	// sConvergenceDistance from one stage to the next.
+	const int sUseConvergence = 1;
+	const float sConvergenceNLL = 0.1;
+	const float sConvergenceDistance = 5.0; // cm
 	// Set the bin width and range for the fit to the peak of the time-of-flight
 	// subtracted timing distribution.
 	const float sBinwidthPeakFitTTOF = 0.4; // ns
 	const float sRangePeakFitTTOF = 12.0; // ns
+	// Method used to find t0 for each test point (see libtzero.hpp):
+	// 0 = peak fit, 1 = mean shift, 2 = incremental mean shift.
+	const int sTZeroMethod = 0;
+	// Half-width of the mean shift window and the maximum number of shifts.
+	const float sMeanShiftBandwidth = 2.0; // ns
+	const int sMeanShiftIterations = 5;
+	const float sMeanShiftPrecision = 0.01; // ns
+	// Maximum vertex movement for which the incremental method starts from
+	// the previous t0 rather than from the histogram peak.
+	const float sIncrementalTZeroDistance = 50.0; // cm
+	// Smallest probability stored in the time-residual pdf table, so that
+	// empty bins give a finite negative log likelihood.
+	const float sMinimumProbabilityPDF = 1e-6;
+	// Add the dark noise of each event to the time-residual pdf. The noise
+	// fraction of the hits is rounded to a multiple of the tolerance, and
+	// one table is kept for each multiple.
+	const int sUseDarkNoise = 1;
+	const float sMaximumNoiseFraction = 0.9;
+	const float sNoiseFractionTolerance = 0.01;
+
+	// Settings for the gradient-based local refinement in the final search.
+	const int sFinalSearchStarts = 3; // number of best survivors to refine
+	const int sFinalMaxIterations = 10; // maximum L-BFGS iterations per start
+	const int sFinalHistorySize = 4; // number of L-BFGS correction pairs kept
+	const float sFinalMaxStep = 20.0; // maximum step per iteration in cm
+	const float sFinalConvergence = 0.5; // stop when the step is below this in cm
 
 	// Constraining angle and angular corrections for non-isotropic light.
 	// TODO these were optimised for Super-Kamiokande and may need to be 
@@ -86,5 +184,17 @@ namespace libConstants{
 	const float sConstrainingAngle = 90.0; // degrees
 	const float sPositiveAngleCorrection = 8.0; // degrees
 	const float sNegativeAngleCorrection = 19.12; // degrees
+	// Number of cos theta bins used to find the weighted median angle of the
+	// hits around the direction centroid.
+	const int sCosThetaBins = 200;
+
+	// Energy estimator (effective number of hits, N_eff) found at the best
+	// vertex: time residual window around t0 and per-hit corrections. (The
+	// attenuation length is part of the detector Geometry.)
+	const float sEnergyWindowMin = -10.0; // ns
+	const float sEnergyWindowMax = 40.0; // ns
+	const float sMinimumCosIncidence = 0.1; // cap on the angle correction
+	// Time resolution used for the goodness of fit of the final vertex.
+	const float sGoodnessSigma = 5.0; // ns
 }
 #endif
@@ -0,0 +1,112 @@
+/**************************************************
+ * Predicts the reconstruction time of an event from
+ * its number of hits and selected hits.
+ * Inputs: numbers of hits and selected hits, the
+ * 			measured step times of reconstructed
+ * 			events for calibration
+ * Outputs: predicted time in ms
+ *
+ * *************************************************/
+#include <iostream>
+#include <algorithm>
+
+#include <libconstants.hpp>
+#include <libcostmodel.hpp>
+
+//constructor function
+CostModel::CostModel()
+{
+	SetCoefficients(libConstants::sCostSelection, libConstants::sCostCombination, libConstants::sCostFit);
+	mSelectedFraction = libConstants::sCostSelectedFraction;
+	mNSamples = 0;
+	fill(mSumSelection, mSumSelection+2, 0);
+	fill(mSumCombination, mSumCombination+2, 0);
+	fill(mSumFit, mSumFit+2, 0);
+	mSumHits = 0;
+	mSumSelected = 0;
+}
+
+//destructor function
+CostModel::~CostModel()
+{
+}
+
+float CostModel::Predict(int nHits, int nSelected)
+{
+	return(mSelectionCost*SelectionTerm(nHits) + mCombinationCost*CombinationTerm(nSelected) + mFitCost*FitTerm(nSelected));
+}
+
+float CostModel::Predict(int nHits)
+{
+	return(Predict(nHits, (int)(mSelectedFraction*nHits + 0.5)));
+}
+
+void CostModel::AddSample(FitResult& fitResult)
+{
+	// Events which were not reconstructed (nSelected < 0) only took the
+	// selection time.
+	int nSelected = max(fitResult.nSelected, 0);
+	double selectionTerm = SelectionTerm(fitResult.nHits);
+	double combinationTerm = CombinationTerm(nSelected);
+	double fitTerm = FitTerm(nSelected);
+	mSumSelection[0] += selectionTerm*fitResult.selectTime;
+	mSumSelection[1] += selectionTerm*selectionTerm;
+	mSumCombination[0] += combinationTerm*fitResult.testPointTime;
+	mSumCombination[1] += combinationTerm*combinationTerm;
+	mSumFit[0] += fitTerm*fitResult.maximiseTime;
+	mSumFit[1] += fitTerm*fitTerm;
+	mSumHits += fitResult.nHits;
+	mSumSelected += nSelected;
+	mNSamples++;
+}
+
+int CostModel::Calibrate()
+{
+	// Each coefficient c minimises sum((c*term - time)^2) over the events,
+	// so c = sum(term*time)/sum(term^2).
+	if (mSumSelection[1] > 0)
+	{
+		mSelectionCost = mSumSelection[0]/mSumSelection[1];
+	}
+	if (mSumCombination[1] > 0)
+	{
+		mCombinationCost = mSumCombination[0]/mSumCombination[1];
+	}
+	if (mSumFit[1] > 0)
+	{
+		mFitCost = mSumFit[0]/mSumFit[1];
+	}
+	if (mSumHits > 0)
+	{
+		mSelectedFraction = mSumSelected/mSumHits;
+	}
+	return(mNSamples);
+}
+
+void CostModel::SetCoefficients(float selectionCost, float combinationCost, float fitCost)
+{
+	mSelectionCost = selectionCost;
+	mCombinationCost = combinationCost;
+	mFitCost = fitCost;
+}
+
+double CostModel::SelectionTerm(int nHits)
+{
+	return((double)nHits*nHits);
+}
+
+double CostModel::CombinationTerm(int nSelected)
+{
+	if (nSelected < 4)
+	{
+		return(0);
+	}
+	double n = nSelected;
+	return(n*(n-1)*(n-2)*(n-3)/24);
+}
+
+double CostModel::FitTerm(int nSelected)
+{
+	double nTestPoints = min(CombinationTerm(nSelected), (double)libConstants::sCostMaximumTestPoints);
+	return(nTestPoints*nSelected);
+}
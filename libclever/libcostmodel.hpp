@@ -0,0 +1,94 @@
+#ifndef LIBCOSTMODEL_H
+#define LIBCOSTMODEL_H
+
+//includes
+#include <vector>
+#include <libfitresult.hpp>
+
+using namespace std;
+
+/*
+ * class CostModel
+ * Cheap prediction of the time taken to reconstruct an event, from its
+ * number of hits N and number of selected hits n. Each step of the
+ * reconstruction has its own term:
+ * 		hit selection		~ N^2 (pairs of hits)
+ * 		test points		~ C(n,4) (four-hit combinations)
+ * 		maximisation		~ (test points) x n
+ * where the number of test points is C(n,4), up to sCostMaximumTestPoints.
+ * The coefficient of each term (ms per unit) is fitted by least squares to
+ * the measured time of its step (see FitResult) in the events added with
+ * AddSample. Before n is known, it is estimated from N by the mean
+ * fraction of hits selected.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class CostModel
+{
+
+
+	// define the public functions and variables
+	public:
+
+		CostModel();
+		~CostModel();
+
+		// Main function called from outside class.
+		// Predicted time in ms to reconstruct an event.
+		float Predict(int nHits, int nSelected);
+		float Predict(int nHits);
+
+		// Add the measured step times of a reconstructed event, then fit
+		// the coefficients to all of the events added so far. Calibrate
+		// returns the number of events fitted (coefficients with nothing
+		// to fit to are left unchanged).
+		void AddSample(FitResult& fitResult);
+		int Calibrate();
+
+		void SetCoefficients(float selectionCost, float combinationCost, float fitCost);
+
+		inline float SelectionCost(void){
+			return(mSelectionCost);
+		}
+
+		inline float CombinationCost(void){
+			return(mCombinationCost);
+		}
+
+		inline float FitCost(void){
+			return(mFitCost);
+		}
+
+		inline float SelectedFraction(void){
+			return(mSelectedFraction);
+		}
+
+		// The terms of the model for N hits and n selected hits.
+		static double SelectionTerm(int nHits);
+		static double CombinationTerm(int nSelected);
+		static double FitTerm(int nSelected);
+
+	// define the private functions and variables
+	private:
+
+		float mSelectionCost;
+		float mCombinationCost;
+		float mFitCost;
+		float mSelectedFraction;
+
+		// Sums for the least-squares fit of each coefficient:
+		// sum(term*time) and sum(term^2).
+		int mNSamples;
+		double mSumSelection[2];
+		double mSumCombination[2];
+		double mSumFit[2];
+		double mSumHits;
+		double mSumSelected;
+
+};
+
+#endif
@@ -0,0 +1,73 @@
+/**************************************************
+ * Unit tests for CostModel class
+ *
+ * *************************************************/
+
+#include <libcostmodel.hpp>
+#include <libconstants.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace{
+
+// Result of an event whose steps took the times given by the coefficients.
+FitResult MakeResult(int nHits, int nSelected, float selectionCost, float combinationCost, float fitCost){
+
+	FitResult fitResult;
+	fitResult.nHits = nHits;
+	fitResult.nSelected = nSelected;
+	fitResult.selectTime = selectionCost*CostModel::SelectionTerm(nHits);
+	fitResult.testPointTime = combinationCost*CostModel::CombinationTerm(nSelected);
+	fitResult.maximiseTime = fitCost*CostModel::FitTerm(nSelected);
+	return(fitResult);
+
+}
+
+TEST(CostModelTest,TestTerms){
+
+	EXPECT_DOUBLE_EQ(CostModel::SelectionTerm(100),1e4);
+	EXPECT_DOUBLE_EQ(CostModel::CombinationTerm(3),0);
+	EXPECT_DOUBLE_EQ(CostModel::CombinationTerm(10),210);
+	EXPECT_DOUBLE_EQ(CostModel::FitTerm(10),2100);
+	// The number of test points stops growing with the combinations.
+	EXPECT_DOUBLE_EQ(CostModel::FitTerm(100),100.*libConstants::sCostMaximumTestPoints);
+
+}
+
+TEST(CostModelTest,TestCalibrate){
+
+	// Events timed exactly by the model give back its coefficients.
+	CostModel model;
+	EXPECT_EQ(model.Calibrate(),0);
+	EXPECT_FLOAT_EQ(model.SelectionCost(),libConstants::sCostSelection);
+	for (int nHits = 20; nHits <= 400; nHits += 20)
+	{
+		int nSelected = (nHits % 40 == 0) ? nHits/4 : -1;
+		FitResult fitResult = MakeResult(nHits,nSelected,2e-3,3e-4,1e-5);
+		model.AddSample(fitResult);
+	}
+	EXPECT_EQ(model.Calibrate(),20);
+	EXPECT_NEAR(model.SelectionCost(),2e-3,1e-8);
+	EXPECT_NEAR(model.CombinationCost(),3e-4,1e-9);
+	EXPECT_NEAR(model.FitCost(),1e-5,1e-10);
+	// Half of the events selected a quarter of their hits.
+	EXPECT_NEAR(model.SelectedFraction(),0.25*2200/4200,1e-6);
+
+	float predicted = model.Predict(200,50);
+	FitResult expected = MakeResult(200,50,2e-3,3e-4,1e-5);
+	EXPECT_NEAR(predicted,expected.selectTime+expected.testPointTime+expected.maximiseTime,1e-3*predicted);
+
+}
+
+TEST(CostModelTest,TestOrdering){
+
+	// More hits always predict a longer reconstruction.
+	CostModel model;
+	for (int nHits = 10; nHits < 1000; nHits += 10)
+	{
+		EXPECT_LT(model.Predict(nHits),model.Predict(nHits+10));
+	}
+
+}
+
+}
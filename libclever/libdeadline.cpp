@@ -0,0 +1,53 @@
+/**************************************************
+ * Keeps track of the time budget for one event.
+ * Inputs: time budget in ms
+ * Outputs: whether the budget has run out and the
+ * 			fraction of the budget remaining
+ *
+ * *************************************************/
+#include <iostream>
+#include <algorithm>
+
+#include <libdeadline.hpp>
+
+//constructor function
+Deadline::Deadline()
+{
+	Start(0);
+}
+
+//destructor function
+Deadline::~Deadline()
+{
+}
+
+void Deadline::Start(float budgetMilliseconds, float spentMilliseconds)
+{
+	mStartTime = chrono::steady_clock::now() - chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float, milli>(spentMilliseconds));
+	mBudget = budgetMilliseconds;
+}
+
+float Deadline::ElapsedMilliseconds()
+{
+	chrono::duration<float, milli> elapsed = chrono::steady_clock::now() - mStartTime;
+	return(elapsed.count());
+}
+
+bool Deadline::HasExpired()
+{
+	return(mBudget > 0 && ElapsedMilliseconds() >= mBudget);
+}
+
+float Deadline::RemainingFraction()
+{
+	if (mBudget <= 0)
+	{
+		return(1);
+	}
+	return(clamp(1 - ElapsedMilliseconds()/mBudget, 0.f, 1.f));
+}
+
+int Deadline::ScaleBudget(int budget, int minimum)
+{
+	return(max(minimum, (int)(budget*RemainingFraction())));
+}
@@ -0,0 +1,56 @@
+#ifndef LIBDEADLINE_H
+#define LIBDEADLINE_H
+
+//includes
+#include <chrono>
+
+using namespace std;
+
+/*
+ * class Deadline
+ * Wall-clock time budget for the reconstruction of one event. Each stage
+ * checks it and scales down its own work (cluster seeds, four-hit 
+ * combinations, survivors, refinement steps) as the budget runs out, so 
+ * that an answer is always available within the budget.
+ * Without a budget the deadline never expires.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class Deadline
+{
+
+
+	// define the public functions and variables
+	public:
+
+		Deadline();
+		~Deadline();
+
+		// Start the clock with a budget in ms (0 = no budget), of which
+		// the given time has already been spent.
+		void Start(float budgetMilliseconds, float spentMilliseconds = 0);
+
+		bool HasExpired();
+		float ElapsedMilliseconds();
+
+		// Fraction of the budget still remaining, between 0 and 1
+		// (always 1 without a budget).
+		float RemainingFraction();
+
+		// Scale a work budget (e.g. a number of test points) by the
+		// remaining fraction, keeping at least the minimum.
+		int ScaleBudget(int budget, int minimum = 1);
+
+	// define the private functions and variables
+	private:
+
+		chrono::steady_clock::time_point mStartTime;
+		float mBudget; // ms
+
+};
+
+#endif
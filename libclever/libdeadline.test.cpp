@@ -0,0 +1,37 @@
+/**************************************************
+ * Unit tests for Deadline class
+ *
+ * *************************************************/
+
+#include <libdeadline.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace{
+
+TEST(DeadlineTest,TestNoBudget){
+
+	// Without a budget the deadline never expires and nothing is scaled.
+	Deadline deadline;
+	EXPECT_FALSE(deadline.HasExpired());
+	EXPECT_FLOAT_EQ(deadline.RemainingFraction(),1.);
+	EXPECT_EQ(deadline.ScaleBudget(20),20);
+
+}
+
+TEST(DeadlineTest,TestExpiry){
+
+	Deadline deadline;
+	deadline.Start(5);
+	EXPECT_GT(deadline.RemainingFraction(),0.);
+	this_thread::sleep_for(chrono::milliseconds(10));
+
+	EXPECT_TRUE(deadline.HasExpired());
+	EXPECT_FLOAT_EQ(deadline.RemainingFraction(),0.);
+	// Budgets are scaled down to the minimum.
+	EXPECT_EQ(deadline.ScaleBudget(20),1);
+	EXPECT_EQ(deadline.ScaleBudget(20,3),3);
+
+}
+
+}
@@ -0,0 +1,233 @@
+/**************************************************
+ * Finds the likelihood of the initial test points
+ * of several small events together.
+ * Inputs: selected hits and test points of each
+ * 			event, time-residual pdf
+ * Outputs: negative log likelihood of each test
+ * 			point, best seeds of each event
+ *
+ * *************************************************/
+#include <iostream>
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+#include <libconstants.hpp>
+#include <libeventbatch.hpp>
+
+//constructor function
+EventBatch::EventBatch()
+{
+	mNLanes = 0;
+	mMaxHits = 0;
+	mMaxPoints = 0;
+}
+
+//destructor function
+EventBatch::~EventBatch()
+{
+}
+
+void EventBatch::Clear()
+{
+	mHitInfoPointers.clear();
+	mTestPointsPointers.clear();
+	mNLanes = 0;
+	mMaxHits = 0;
+	mMaxPoints = 0;
+}
+
+int EventBatch::AddEvent(vector<HitInfo>& hitInfoVector, vector<vector<float>>& testPointsVector)
+{
+	mHitInfoPointers.push_back(&hitInfoVector);
+	mTestPointsPointers.push_back(&testPointsVector);
+	return(mHitInfoPointers.size()-1);
+}
+
+void EventBatch::Pack()
+{
+	int nEvents = NEvents();
+	mNLanes = ((nEvents + sLaneWidth - 1)/sLaneWidth)*sLaneWidth;
+	mNHits.assign(mNLanes, 0);
+	mNPoints.assign(mNLanes, 0);
+	mMaxHits = 0;
+	mMaxPoints = 0;
+
+	// The events with the most test points take the first lanes.
+	mIndexVector.resize(nEvents);
+	for (int event = 0; event < nEvents; event++)
+	{
+		mIndexVector[event] = event;
+	}
+	stable_sort(mIndexVector.begin(), mIndexVector.end(), [&] (int a, int b)
+	{
+		return(mTestPointsPointers[a]->size() > mTestPointsPointers[b]->size());
+	});
+	mLanes.resize(nEvents);
+	for (int lane = 0; lane < nEvents; lane++)
+	{
+		int event = mIndexVector[lane];
+		mLanes[event] = lane;
+		mNHits[lane] = mHitInfoPointers[event]->size();
+		mNPoints[lane] = mTestPointsPointers[event]->size();
+		mMaxHits = max(mMaxHits, mNHits[lane]);
+		mMaxPoints = max(mMaxPoints, mNPoints[lane]);
+	}
+
+	// Padding slots are left at the origin with mask 0, so that every lane
+	// does the same (finite) arithmetic.
+	int nHitValues = mMaxHits*mNLanes;
+	mHitX.assign(nHitValues, 0);
+	mHitY.assign(nHitValues, 0);
+	mHitZ.assign(nHitValues, 0);
+	mHitTime.assign(nHitValues, 0);
+	mHitMask.assign(nHitValues, 0);
+	int nPointValues = mMaxPoints*mNLanes;
+	mPointX.assign(nPointValues, 0);
+	mPointY.assign(nPointValues, 0);
+	mPointZ.assign(nPointValues, 0);
+	mPointNLL.assign(nPointValues, numeric_limits<float>::max());
+
+	for (int event = 0; event < nEvents; event++)
+	{
+		int lane = mLanes[event];
+		vector<HitInfo>& hitInfoVector = *mHitInfoPointers[event];
+		for (int iHit = 0; iHit < mNHits[lane]; iHit++)
+		{
+			int index = iHit*mNLanes + lane;
+			mHitX[index] = hitInfoVector[iHit].pmtx;
+			mHitY[index] = hitInfoVector[iHit].pmty;
+			mHitZ[index] = hitInfoVector[iHit].pmtz;
+			mHitTime[index] = hitInfoVector[iHit].time;
+			mHitMask[index] = 1;
+		}
+		vector<vector<float>>& testPointsVector = *mTestPointsPointers[event];
+		for (int iPoint = 0; iPoint < mNPoints[lane]; iPoint++)
+		{
+			int index = iPoint*mNLanes + lane;
+			mPointX[index] = testPointsVector[iPoint][0];
+			mPointY[index] = testPointsVector[iPoint][1];
+			mPointZ[index] = testPointsVector[iPoint][2];
+		}
+	}
+
+	mTTof.resize(nHitValues);
+	mSum.resize(mNLanes);
+	mCount.resize(mNLanes);
+	mTZero.resize(mNLanes);
+	mNLL.resize(mNLanes);
+}
+
+void EventBatch::FindSeedLikelihoods(TimeResidualPDF& timeResidualPDF)
+{
+	Pack();
+	int nLanes = mNLanes;
+	float inverseCmPerNs = 1./libConstants::sCmPerNs;
+	float bandwidth = libConstants::sMeanShiftBandwidth;
+
+	// Test point slot iPoint of every lane is evaluated at once. The lanes
+	// are ordered by number of test points, so the ones left with test
+	// points in this slot come first.
+	int nActive = nLanes;
+	for (int iPoint = 0; iPoint < mMaxPoints; iPoint++)
+	{
+		while (nActive > sLaneWidth && mNPoints[nActive-sLaneWidth] <= iPoint)
+		{
+			nActive -= sLaneWidth;
+		}
+		float* pointX = &mPointX[iPoint*nLanes];
+		float* pointY = &mPointY[iPoint*nLanes];
+		float* pointZ = &mPointZ[iPoint*nLanes];
+
+		// Time - time of flight of each hit from the test point.
+		for (int iHit = 0; iHit < mMaxHits; iHit++)
+		{
+			int slot = iHit*nLanes;
+			for (int lane = 0; lane < nActive; lane++)
+			{
+				float dx = mHitX[slot+lane] - pointX[lane];
+				float dy = mHitY[slot+lane] - pointY[lane];
+				float dz = mHitZ[slot+lane] - pointZ[lane];
+				mTTof[slot+lane] = mHitTime[slot+lane] - sqrt(dx*dx + dy*dy + dz*dz)*inverseCmPerNs;
+			}
+		}
+
+		// t0 from the mean of the t-tof values, moved by mean shift (as in
+		// MeanShiftTZero) towards the peak.
+		fill(mSum.begin(), mSum.end(), 0);
+		fill(mCount.begin(), mCount.end(), 0);
+		for (int iHit = 0; iHit < mMaxHits; iHit++)
+		{
+			int slot = iHit*nLanes;
+			for (int lane = 0; lane < nActive; lane++)
+			{
+				mSum[lane] += mHitMask[slot+lane]*mTTof[slot+lane];
+				mCount[lane] += mHitMask[slot+lane];
+			}
+		}
+		for (int lane = 0; lane < nActive; lane++)
+		{
+			mTZero[lane] = (mCount[lane] > 0) ? mSum[lane]/mCount[lane] : 0;
+		}
+		for (int iteration = 0; iteration < libConstants::sMeanShiftIterations; iteration++)
+		{
+			fill(mSum.begin(), mSum.end(), 0);
+			fill(mCount.begin(), mCount.end(), 0);
+			for (int iHit = 0; iHit < mMaxHits; iHit++)
+			{
+				int slot = iHit*nLanes;
+				for (int lane = 0; lane < nActive; lane++)
+				{
+					float weight = (fabs(mTTof[slot+lane] - mTZero[lane]) < bandwidth) ? mHitMask[slot+lane] : 0;
+					mSum[lane] += weight*mTTof[slot+lane];
+					mCount[lane] += weight;
+				}
+			}
+			for (int lane = 0; lane < nActive; lane++)
+			{
+				mTZero[lane] = (mCount[lane] > 0) ? mSum[lane]/mCount[lane] : mTZero[lane];
+			}
+		}
+
+		// Negative log likelihood of the time residuals.
+		fill(mNLL.begin(), mNLL.end(), 0);
+		for (int iHit = 0; iHit < mMaxHits; iHit++)
+		{
+			int slot = iHit*nLanes;
+			for (int lane = 0; lane < nActive; lane++)
+			{
+				mNLL[lane] += mHitMask[slot+lane]*timeResidualPDF.NegativeLogLikelihood(mTTof[slot+lane] - mTZero[lane]);
+			}
+		}
+		for (int lane = 0; lane < nActive; lane++)
+		{
+			if (iPoint < mNPoints[lane])
+			{
+				mPointNLL[iPoint*nLanes + lane] = mNLL[lane];
+			}
+		}
+	}
+}
+
+void EventBatch::GetBestSeeds(int event, int nSeeds, vector<vector<float>>& testPointsVector)
+{
+	int lane = mLanes[event];
+	int nPoints = mNPoints[lane];
+	nSeeds = min(nSeeds, nPoints);
+	mIndexVector.resize(nPoints);
+	for (int iPoint = 0; iPoint < nPoints; iPoint++)
+	{
+		mIndexVector[iPoint] = iPoint;
+	}
+	partial_sort(mIndexVector.begin(), mIndexVector.begin()+nSeeds, mIndexVector.end(), [&] (int a, int b)
+	{
+		return(mPointNLL[a*mNLanes + lane] < mPointNLL[b*mNLanes + lane]);
+	});
+
+	testPointsVector.resize(nSeeds);
+	for (int iSeed = 0; iSeed < nSeeds; iSeed++)
+	{
+		int index = mIndexVector[iSeed]*mNLanes + lane;
+		testPointsVector[iSeed] = {mPointX[index], mPointY[index], mPointZ[index]};
+	}
+}
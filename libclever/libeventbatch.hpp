@@ -0,0 +1,112 @@
+#ifndef LIBEVENTBATCH_H
+#define LIBEVENTBATCH_H
+
+//includes
+#include <vector>
+#include <libhitinfo.hpp>
+#include <libpdf.hpp>
+
+using namespace std;
+
+/*
+ * class EventBatch
+ * Packs the selected hits and initial test points of several small events
+ * into shared structure-of-arrays buffers, so that the likelihood of the
+ * test points can be found for all of the events in lock-step. Each event
+ * is one lane: the buffers are laid out slot-major (slot*NLanes() + lane),
+ * so the inner loop runs over the events with the same arithmetic in
+ * every lane. Events with fewer hits than the largest are masked off in
+ * the remaining slots, and the lanes are padded to a multiple of
+ * sLaneWidth. The lanes are ordered by number of test points, most first,
+ * so that each test point slot only runs over the lanes (in groups of
+ * sLaneWidth) which still have test points.
+ * The likelihood found here (time residuals only, with t0 from a mean
+ * shift) is used to keep the best seeds of each event for the full search.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class EventBatch
+{
+
+
+	// define the public functions and variables
+	public:
+
+		EventBatch();
+		~EventBatch();
+
+		// Forget the events of the last batch (the buffers are kept).
+		void Clear();
+
+		// Add the selected hits and initial test points ({x, y, z, ...}) of
+		// an event and return its index in the batch. The vectors are read
+		// when the likelihoods are found, so must be kept until then.
+		int AddEvent(vector<HitInfo>& hitInfoVector, vector<vector<float>>& testPointsVector);
+
+		// Pack the events and find the negative log likelihood of every
+		// test point of every event.
+		void FindSeedLikelihoods(TimeResidualPDF& timeResidualPDF);
+
+		// Replace the test points with the (at most nSeeds) test points of
+		// the event with the lowest negative log likelihood, best first.
+		void GetBestSeeds(int event, int nSeeds, vector<vector<float>>& testPointsVector);
+
+		inline int NEvents(void){
+			return(mHitInfoPointers.size());
+		}
+
+		inline int NLanes(void){
+			return(mNLanes);
+		}
+
+		inline float SeedNLL(int event, int point){
+			return(mPointNLL[point*mNLanes + mLanes[event]]);
+		}
+
+		// Lanes are padded to a multiple of this (one AVX register of floats).
+		static constexpr int sLaneWidth = 8;
+
+	// define the private functions and variables
+	private:
+
+		// Copy the hits and test points into the slot-major buffers.
+		void Pack();
+
+		vector<vector<HitInfo>*> mHitInfoPointers;
+		vector<vector<vector<float>>*> mTestPointsPointers;
+
+		int mNLanes;
+		int mMaxHits;
+		int mMaxPoints;
+		vector<int> mLanes; // per event
+		vector<int> mNHits; // per lane
+		vector<int> mNPoints; // per lane
+
+		// Hits, slot-major, with mask 1 for a hit and 0 for padding.
+		vector<float> mHitX;
+		vector<float> mHitY;
+		vector<float> mHitZ;
+		vector<float> mHitTime;
+		vector<float> mHitMask;
+
+		// Test points, slot-major, and their likelihoods.
+		vector<float> mPointX;
+		vector<float> mPointY;
+		vector<float> mPointZ;
+		vector<float> mPointNLL;
+
+		// Workspace for one test point slot of every lane.
+		vector<float> mTTof; // slot-major
+		vector<float> mSum;
+		vector<float> mCount;
+		vector<float> mTZero;
+		vector<float> mNLL;
+		vector<int> mIndexVector;
+
+};
+
+#endif
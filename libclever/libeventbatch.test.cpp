@@ -0,0 +1,87 @@
+/**************************************************
+ * Unit tests for EventBatch class
+ *
+ * *************************************************/
+
+#include <libeventbatch.hpp>
+#include <libconstants.hpp>
+#include <libtesthelpers.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+namespace{
+
+TEST(EventBatchTest,TestBestSeeds){
+
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+
+	// Two events of different sizes, each with its true vertex among
+	// other test points.
+	vector<HitInfo> hits1, hits2;
+	MakeHits({100,0,0},25,hits1);
+	MakeHits({0,-200,50},60,hits2);
+	vector<vector<float>> points1 = {{-200,0,0},{100,0,0},{0,300,0}};
+	vector<vector<float>> points2 = {{0,200,-50},{150,150,150},{0,0,0},{0,-200,50},{-300,0,0}};
+
+	EventBatch batch;
+	EXPECT_EQ(batch.AddEvent(hits1,points1),0);
+	EXPECT_EQ(batch.AddEvent(hits2,points2),1);
+	batch.FindSeedLikelihoods(pdf);
+	EXPECT_EQ(batch.NLanes(),EventBatch::sLaneWidth);
+
+	batch.GetBestSeeds(0,1,points1);
+	ASSERT_EQ(points1.size(),1);
+	EXPECT_FLOAT_EQ(points1[0][0],100);
+	batch.GetBestSeeds(1,2,points2);
+	ASSERT_EQ(points2.size(),2);
+	EXPECT_FLOAT_EQ(points2[0][1],-200);
+	EXPECT_FLOAT_EQ(points2[0][2],50);
+
+}
+
+TEST(EventBatchTest,TestMaskedLanes){
+
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+
+	vector<HitInfo> hits1, hits2;
+	MakeHits({50,50,0},20,hits1);
+	MakeHits({-100,0,100},45,hits2);
+	vector<vector<float>> points1 = {{50,50,0},{0,0,0}};
+	vector<vector<float>> points2 = {{-100,0,100},{0,0,0},{100,100,100},{0,0,-100}};
+
+	// The likelihoods of an event do not depend on the other events in
+	// the batch.
+	EventBatch single;
+	single.AddEvent(hits1,points1);
+	single.FindSeedLikelihoods(pdf);
+
+	EventBatch batch;
+	batch.AddEvent(hits2,points2);
+	batch.AddEvent(hits1,points1);
+	batch.FindSeedLikelihoods(pdf);
+
+	for (int point = 0; point < 2; point++)
+	{
+		EXPECT_NEAR(batch.SeedNLL(1,point),single.SeedNLL(0,point),1e-3);
+	}
+	// Slots beyond the test points of an event are never chosen.
+	EXPECT_GT(batch.SeedNLL(1,3),1e30);
+	batch.GetBestSeeds(1,10,points1);
+	EXPECT_EQ(points1.size(),2);
+
+	// Nor on the order in which the events are added.
+	EventBatch reversed;
+	EXPECT_EQ(reversed.AddEvent(hits1,points1),0);
+	EXPECT_EQ(reversed.AddEvent(hits2,points2),1);
+	reversed.FindSeedLikelihoods(pdf);
+	for (int point = 0; point < 4; point++)
+	{
+		EXPECT_EQ(reversed.SeedNLL(1,point),batch.SeedNLL(0,point));
+	}
+
+}
+
+}
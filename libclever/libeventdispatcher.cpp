@@ -0,0 +1,111 @@
+/**************************************************
+ * Sends events to the workers most expensive first,
+ * by their predicted reconstruction time.
+ * Inputs: events from the reader, fit results with
+ * 			measured step times from the workers
+ * Outputs: events on the queue for the workers
+ *
+ * *************************************************/
+#include <iostream>
+#include <algorithm>
+#include <numeric> //iota()
+#include <thread>
+
+#include <libconstants.hpp>
+#include <libeventdispatcher.hpp>
+
+//constructor function
+EventDispatcher::EventDispatcher(BoundedQueue<EventHits>& hitsQueue, int windowSize) : mHitsQueue(hitsQueue)
+{
+	mWindowSize = (windowSize > 0) ? windowSize : 1;
+	mWindow.reserve(mWindowSize);
+	mCostVector.reserve(mWindowSize);
+	mNRecorded = 0;
+	mNCalibrations = 0;
+	mNPushed = 0;
+	mNDispatched = 0;
+	mMaxPending = 0;
+	mNWritten.store(0, memory_order_relaxed);
+}
+
+//destructor function
+EventDispatcher::~EventDispatcher()
+{
+}
+
+void EventDispatcher::Push(EventHits& eventHits)
+{
+	eventHits.sequence = mNPushed++;
+	mCostVector.push_back(PredictCost(eventHits));
+	mWindow.push_back(move(eventHits));
+	if ((int)mWindow.size() >= mWindowSize)
+	{
+		Dispatch();
+	}
+}
+
+void EventDispatcher::Close()
+{
+	Dispatch();
+	mHitsQueue.Close();
+}
+
+void EventDispatcher::SetMaxPending(long maxPending)
+{
+	// A window is sent on as a whole, so it must fit for the writer to
+	// make progress.
+	mMaxPending = (maxPending > 0) ? max(maxPending, (long)mWindowSize) : 0;
+}
+
+void EventDispatcher::SetNWritten(long nWritten)
+{
+	mNWritten.store(nWritten, memory_order_release);
+}
+
+float EventDispatcher::PredictCost(EventHits& eventHits)
+{
+	lock_guard<mutex> lock(mMutex);
+	return(mCostModel.Predict(eventHits.nhits()));
+}
+
+void EventDispatcher::Record(FitResult& fitResult)
+{
+	lock_guard<mutex> lock(mMutex);
+	mCostModel.AddSample(fitResult);
+	mNRecorded++;
+	if (mNRecorded % libConstants::sCostCalibrationInterval == 0)
+	{
+		mCostModel.Calibrate();
+		mNCalibrations++;
+	}
+}
+
+void EventDispatcher::Dispatch()
+{
+	// Longest first; events predicted to take the same time keep the order
+	// in which they were read. The queue may make the reader wait here, so
+	// the cost model is not locked.
+	int nEvents = mWindow.size();
+
+	// With a limit, wait until the writer is close enough behind. The
+	// events before this window have all been sent, so it will catch up.
+	long windowEnd = mNDispatched + nEvents;
+	while (mMaxPending > 0 && windowEnd - mNWritten.load(memory_order_acquire) > mMaxPending)
+	{
+		this_thread::yield();
+	}
+
+	mOrderVector.resize(nEvents);
+	iota(mOrderVector.begin(), mOrderVector.end(), 0);
+	stable_sort(mOrderVector.begin(), mOrderVector.end(), [this] (int i, int j)
+	{
+		return(mCostVector[i] > mCostVector[j]);
+	});
+	for (int iEvent : mOrderVector)
+	{
+		mHitsQueue.Push(mWindow[iEvent]);
+	}
+	mWindow.clear();
+	mCostVector.clear();
+	mNDispatched = windowEnd;
+}
@@ -0,0 +1,104 @@
+#ifndef LIBEVENTDISPATCHER_H
+#define LIBEVENTDISPATCHER_H
+
+//includes
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <libconstants.hpp>
+#include <libeventhits.hpp>
+#include <libfitresult.hpp>
+#include <libboundedqueue.hpp>
+#include <libcostmodel.hpp>
+
+using namespace std;
+
+/*
+ * class EventDispatcher
+ * Sits between the reader and the queue of events for the workers. The
+ * events are held back in windows of sDispatchWindow and each window is
+ * sent most expensive first, by the time predicted by a CostModel. As the
+ * workers take the next event whenever they are free, the long events
+ * start first and the short ones fill in around them, so that the workers
+ * finish together rather than waiting on a few long events at the end.
+ * The workers record their results, and the model is refitted to the
+ * measured step times every sCostCalibrationInterval events.
+ * Each event is numbered in the order it was pushed, so that the results
+ * can be put back in input order (see ReorderBuffer). With a limit on the
+ * pending events, a window is held back until the writer has written all
+ * but that many of the events up to its end.
+ * Push and Close are called by the reader only; PredictCost and Record
+ * may be called by any worker, and SetNWritten by the writer.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class EventDispatcher
+{
+
+
+	// define the public functions and variables
+	public:
+
+		EventDispatcher(BoundedQueue<EventHits>& hitsQueue, int windowSize = libConstants::sDispatchWindow);
+		~EventDispatcher();
+
+		// Main function called from outside class.
+		// Add an event (which is moved from) and number it, sending the
+		// window on to the queue once it is full.
+		void Push(EventHits& eventHits);
+
+		// Send the last events and close the queue.
+		void Close();
+
+		// Predicted time in ms to reconstruct the event.
+		float PredictCost(EventHits& eventHits);
+
+		// Add the measured step times of a reconstructed event to the
+		// cost model.
+		void Record(FitResult& fitResult);
+
+		inline int NCalibrations(void){
+			return(mNCalibrations);
+		}
+
+		// Limit the events sent on but not yet written to maxPending (at 
+		// least one window; 0 = no limit). Must be set before the first 
+		// Push.
+		void SetMaxPending(long maxPending);
+
+		inline long MaxPending(void){
+			return(mMaxPending);
+		}
+
+		// Called by the writer once the first nWritten events (in input
+		// order) have been written.
+		void SetNWritten(long nWritten);
+
+	// define the private functions and variables
+	private:
+
+		void Dispatch();
+
+		BoundedQueue<EventHits>& mHitsQueue;
+		int mWindowSize;
+		vector<EventHits> mWindow;
+		vector<float> mCostVector;
+		vector<int> mOrderVector;
+		long mNPushed;
+		long mNDispatched;
+		long mMaxPending;
+		atomic<long> mNWritten;
+
+		// The cost model is shared by the reader and the workers.
+		mutex mMutex;
+		CostModel mCostModel;
+		int mNRecorded;
+		int mNCalibrations;
+
+};
+
+#endif
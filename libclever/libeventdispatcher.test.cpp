@@ -0,0 +1,131 @@
+/**************************************************
+ * Unit tests for EventDispatcher class
+ *
+ * *************************************************/
+
+#include <libeventdispatcher.hpp>
+#include <libconstants.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <thread>
+
+namespace{
+
+// Event with the given number of hits.
+EventHits MakeEvent(int event, int nHits){
+
+	EventHits eventHits(event,0);
+	for (int hit = 0; hit < nHits; hit++)
+	{
+		eventHits.add_hit(hit,1,0,0,0);
+	}
+	return(eventHits);
+
+}
+
+TEST(EventDispatcherTest,TestLongestFirst){
+
+	// Each window is sent on most hits first; events of the same size keep
+	// their order, and the last part-window is sent on Close.
+	BoundedQueue<EventHits> hitsQueue(16);
+	EventDispatcher dispatcher(hitsQueue,4);
+	vector<int> nHitsVector = {10,50,20,50,   5,30,   40};
+	for (int event = 0; event < (int)nHitsVector.size(); event++)
+	{
+		EventHits eventHits = MakeEvent(event,nHitsVector[event]);
+		dispatcher.Push(eventHits);
+	}
+	dispatcher.Close();
+
+	vector<int> order;
+	EventHits eventHits;
+	while (hitsQueue.Pop(eventHits))
+	{
+		order.push_back(eventHits.event);
+	}
+	vector<int> order_check = {1,3,2,0,6,5,4};
+	EXPECT_EQ(order,order_check);
+
+}
+
+TEST(EventDispatcherTest,TestSequence){
+
+	// Events are numbered in the order they were pushed, whatever order 
+	// they are sent on in.
+	BoundedQueue<EventHits> hitsQueue(16);
+	EventDispatcher dispatcher(hitsQueue,4);
+	vector<int> nHitsVector = {10,50,20,40,30};
+	for (int event = 0; event < (int)nHitsVector.size(); event++)
+	{
+		EventHits eventHits = MakeEvent(event,nHitsVector[event]);
+		dispatcher.Push(eventHits);
+	}
+	dispatcher.Close();
+
+	EventHits eventHits;
+	while (hitsQueue.Pop(eventHits))
+	{
+		EXPECT_EQ(eventHits.sequence,eventHits.event);
+	}
+
+}
+
+TEST(EventDispatcherTest,TestMaxPending){
+
+	// The second window is held back until the writer has written the 
+	// first.
+	BoundedQueue<EventHits> hitsQueue(16);
+	EventDispatcher dispatcher(hitsQueue,4);
+	dispatcher.SetMaxPending(4);
+	EXPECT_EQ(dispatcher.MaxPending(),4);
+	thread reader([&] ()
+	{
+		for (int event = 0; event < 8; event++)
+		{
+			EventHits eventHits = MakeEvent(event,10);
+			dispatcher.Push(eventHits);
+		}
+		dispatcher.Close();
+	});
+
+	EventHits eventHits;
+	for (int event = 0; event < 4; event++)
+	{
+		EXPECT_TRUE(hitsQueue.Pop(eventHits));
+		EXPECT_LT(eventHits.sequence,4);
+	}
+	this_thread::sleep_for(chrono::milliseconds(20));
+	EXPECT_FALSE(hitsQueue.TryPop(eventHits));
+
+	dispatcher.SetNWritten(4);
+	int nPopped = 0;
+	while (hitsQueue.Pop(eventHits))
+	{
+		EXPECT_GE(eventHits.sequence,4);
+		nPopped++;
+	}
+	EXPECT_EQ(nPopped,4);
+	reader.join();
+
+}
+
+TEST(EventDispatcherTest,TestRecord){
+
+	// The cost model is refitted after every calibration interval.
+	BoundedQueue<EventHits> hitsQueue(4);
+	EventDispatcher dispatcher(hitsQueue);
+	EventHits eventHits = MakeEvent(0,100);
+	FitResult fitResult;
+	fitResult.nHits = 100;
+	fitResult.nSelected = -1;
+	fitResult.selectTime = 1;
+	for (int event = 0; event < libConstants::sCostCalibrationInterval; event++)
+	{
+		dispatcher.Record(fitResult);
+	}
+	EXPECT_EQ(dispatcher.NCalibrations(),1);
+	EXPECT_NEAR(dispatcher.PredictCost(eventHits),1,1e-4);
+
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef LIBEVENTHITS_H
+#define LIBEVENTHITS_H
+
+//includes
+#include <vector>
+
+using namespace std;
+
+/*
+ * Class EventHits
+ * Creates the event hits class for storing the hit times, charges and PMT
+ * positions of one (sub-)event as read from file, before hit selection
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class EventHits
+{
+
+
+	// define the public event hits class for storing all of the hits of 
+	// an event which are passed to the reconstruction
+	public:
+
+		int event;
+		int subEvent;
+		long sequence; // position in the input, set by EventDispatcher
+		vector<float> times;
+		vector<float> charges;
+		vector<float> pmtx;
+		vector<float> pmty;
+		vector<float> pmtz;
+
+		EventHits(){ event = 0, subEvent = 0, sequence = 0;};
+		EventHits(int ev, int subev){ event = ev, subEvent = subev, sequence = 0;};
+		~EventHits() {};
+
+		int nhits()
+		{
+			return times.size();
+		}
+
+		void add_hit(float t, float q, float x, float y, float z)
+		{
+			times.push_back(t);
+			charges.push_back(q);
+			pmtx.push_back(x);
+			pmty.push_back(y);
+			pmtz.push_back(z);
+		}
+
+	// define the private functions and variables
+	//private:
+
+};
+
+#endif
@@ -0,0 +1,71 @@
+/**************************************************
+ * Distributes the events of a file across a pool 
+ * of worker threads.
+ * Inputs: number of events and the task to run for
+ * 		   each event
+ * Outputs: none (the task stores its own results)
+ *
+ * *************************************************/
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#include <libeventloop.hpp>
+
+//constructor function
+EventLoop::EventLoop(int nThreads)
+{
+	mNThreads = nThreads;
+	if (mNThreads <= 0)
+	{
+		mNThreads = max(1u, thread::hardware_concurrency());
+	}
+}
+
+//destructor function
+EventLoop::~EventLoop()
+{
+}
+
+void EventLoop::Run(int nEvents, function<void(int, int)> task)
+{
+	// Each worker takes the next event from the shared counter until none
+	// are left.
+	atomic<int> nextEvent(0);
+	auto worker = [&nextEvent, nEvents, &task] (int iThread)
+	{
+		for (int event = nextEvent++; event < nEvents; event = nextEvent++)
+		{
+			task(event, iThread);
+		}
+	};
+
+	int nWorkers = min(mNThreads, max(nEvents, 1));
+	if (nWorkers == 1)
+	{
+		worker(0);
+		return;
+	}
+	vector<thread> threadVector;
+	for (int iThread = 0; iThread < nWorkers; iThread++)
+	{
+		threadVector.emplace_back(worker, iThread);
+	}
+	for (thread& workerThread : threadVector)
+	{
+		workerThread.join();
+	}
+}
+
+void EventLoop::RunWorkers(function<void(int)> task)
+{
+	vector<thread> threadVector;
+	for (int iThread = 0; iThread < mNThreads; iThread++)
+	{
+		threadVector.emplace_back(task, iThread);
+	}
+	for (thread& workerThread : threadVector)
+	{
+		workerThread.join();
+	}
+}
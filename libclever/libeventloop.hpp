@@ -0,0 +1,54 @@
+#ifndef LIBEVENTLOOP_H
+#define LIBEVENTLOOP_H
+
+//includes
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+/*
+ * class EventLoop
+ * Runs a task for every event of a file on a pool of worker threads.
+ * Events are handed out one at a time from a shared counter, so that 
+ * expensive events do not hold up the others, and each task is given the
+ * index of its thread so that it can use that thread's own reconstruction
+ * context. Results written by event index stay in input order.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class EventLoop
+{
+
+
+	// define the public functions and variables
+	public:
+
+		// Use nThreads workers (0 = one per hardware thread).
+		EventLoop(int nThreads = 0);
+		~EventLoop();
+
+		inline int NThreads(void){
+			return(mNThreads);
+		}
+
+		// Main function called from outside class.
+		// Calls task(event, thread) once for each event in [0, nEvents).
+		void Run(int nEvents, function<void(int, int)> task);
+
+		// Calls task(thread) once on each thread, e.g. for workers which take
+		// their events from a queue until it is closed.
+		void RunWorkers(function<void(int)> task);
+
+	// define the private functions and variables
+	private:
+
+		int mNThreads;
+
+};
+
+#endif
@@ -0,0 +1,53 @@
+/**************************************************
+ * Unit tests for EventLoop class
+ *
+ * *************************************************/
+
+#include <libeventloop.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace{
+
+TEST(EventLoopTest,TestAllEventsInOrder){
+
+	// Every event is run exactly once and results stored by event index 
+	// stay in input order, whatever the number of threads.
+	for (int nThreads : {1, 4})
+	{
+		EventLoop loop(nThreads);
+		int nEvents = 1000;
+		vector<int> resultVector(nEvents, -1);
+		vector<int> countVector(nEvents, 0);
+		loop.Run(nEvents, [&] (int event, int thread)
+		{
+			EXPECT_LT(thread, loop.NThreads());
+			resultVector[event] = 2*event;
+			countVector[event]++;
+		});
+		for (int event = 0; event < nEvents; event++)
+		{
+			EXPECT_EQ(resultVector[event], 2*event);
+			EXPECT_EQ(countVector[event], 1);
+		}
+	}
+
+}
+
+TEST(EventLoopTest,TestRunWorkers){
+
+	// The task is run once on each thread.
+	EventLoop loop(3);
+	vector<int> countVector(loop.NThreads(), 0);
+	loop.RunWorkers([&] (int thread)
+	{
+		countVector[thread]++;
+	});
+	for (int count : countVector)
+	{
+		EXPECT_EQ(count, 1);
+	}
+
+}
+
+}
@@ -0,0 +1,68 @@
+#ifndef LIBFITRESULT_H
+#define LIBFITRESULT_H
+
+//includes
+#include <vector>
+
+using namespace std;
+
+/*
+ * Class FitResult
+ * Creates the fit result class for storing the reconstructed vertex and
+ * information about the fit for each event
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class FitResult
+{
+
+
+	// define the public fit result class for storing all of the info 
+	// produced by the maximisation for one event
+	public:
+
+		// Search stages of the maximisation
+		static const int sInitialStage = 0;
+		static const int sCoarseStage = 1;
+		static const int sFineStage = 2;
+		static const int sFinalStage = 3;
+
+		int event;
+		int subEvent;
+		int nHits; // number of hits in the event
+		int nSelected; // number of hits selected for the fit
+		float x;
+		float y;
+		float z;
+		float t0; // emission time
+		float nll;
+		int stage; // stage after which the fit stopped
+		int converged; // whether it stopped because the vertex converged
+		int truncated; // whether the deadline was reached before the end
+		float nEffective; // effective number of hits (energy estimator)
+		int nWindowHits; // number of hits in the energy window around t0
+		float goodness; // time goodness of fit (0 to 1)
+		float dirx; // direction (unit vector)
+		float diry;
+		float dirz;
+		float theta; // polar angle of the direction in rad
+		float phi; // azimuthal angle of the direction in rad
+		float cosCone; // median cos of the angle between direction and hits
+		float dirGoodness; // magnitude of the direction centroid (0 to 1)
+		float selectTime; // wall-clock time of each reconstruction step in ms
+		float testPointTime;
+		float maximiseTime;
+
+		FitResult(){ event = 0, subEvent = 0, nHits = 0, nSelected = 0, x = 0, y = 0, z = 0, t0 = 0, nll = 0, stage = sInitialStage, converged = 0, truncated = 0, nEffective = 0, nWindowHits = -1, goodness = 0, dirx = 0, diry = 0, dirz = 0, theta = 0, phi = 0, cosCone = 0, dirGoodness = 0, selectTime = 0, testPointTime = 0, maximiseTime = 0;};
+		~FitResult() {};
+
+	// define the private functions and variables
+	//private:
+
+};
+
+#endif
@@ -18,7 +18,7 @@
 //constructor function
 FourHitCombos::FourHitCombos()
 {
-	GetFourHitCombos(hitinfo,combos_upper_bounds);
+	ncombos = 0;
 }
 
 //destructor function
@@ -49,7 +49,7 @@ int FourHitCombos::GetFourHitCombos(vector<HitInfo>& hitinfo, vector<int>& combo
 // These are the principal functions called by the main CalculateVertices
 // function.
 
-int FourHitCombos::FindRanges(vector<HitInfo> hitinfo, int nselected, int& ncombos, vector<int>& combos_upper_bounds)
+int FourHitCombos::FindRanges(vector<HitInfo>& hitinfo, int nselected, int& ncombos, vector<int>& combos_upper_bounds)
 {
 	// Find the time window which gives the number of combinations closest to 
 	// the optimal number of combinations within the maximum time window of 
@@ -200,7 +200,7 @@ int FourHitCombos::FindRanges(vector<HitInfo> hitinfo, int nselected, int& ncomb
 // These are the subsidiary functions called by the principal functions 
 // which are in turn called by the main CalculateVertices function.
 
-int FourHitCombos::FindNewCombinations(vector<HitInfo> hitinfo, int nselected, float lower_bound, float upper_bound, float time_window)
+int FourHitCombos::FindNewCombinations(vector<HitInfo>& hitinfo, int nselected, float lower_bound, float upper_bound, float time_window)
 {
 
 	float time_current;
@@ -219,7 +219,7 @@ int FourHitCombos::FindNewCombinations(vector<HitInfo> hitinfo, int nselected, f
 	// Predicate to find the first hit that cannot be combined with current hit
 	// (i.e. not between lower and upper bounds and with dt<=time_window).
 	// Use this (below) to find the index of the last hit that can be combined.
-	auto last_in_combo = [time_current,time_window](HitInfo const& h) 
+	auto last_in_combo = [&time_current,time_window](HitInfo const& h) 
 	{
 		return h.time-time_current<=time_window;
 	};
@@ -274,7 +274,7 @@ int FourHitCombos::FindNewCombinations(vector<HitInfo> hitinfo, int nselected, f
 	return(ncombos);
 }
 
-int FourHitCombos::SetNewInterval(vector<HitInfo> hitinfo, int nselected, float optimal_window, vector<int>& combos_upper_bounds)
+int FourHitCombos::SetNewInterval(vector<HitInfo>& hitinfo, int nselected, float optimal_window, vector<int>& combos_upper_bounds)
 {
 	// Saves a list of upper bounds in the ranges from which to draw the 4-hit 
 	// combinations for each hit in nselected.
@@ -282,12 +282,12 @@ int FourHitCombos::SetNewInterval(vector<HitInfo> hitinfo, int nselected, float
 	auto current = hitinfo.begin(); // Iterator over hitinfo.
 	int icurrent = 0; // Index of current hit
 	float time_current; 
-	int ncombos;
+	int ncombos = 0;
 
 	// Predicate to find the first hit that cannot be combined with current hit
 	// (i.e. not between lower and upper bounds and with dt<=time_window).
 	// Use this (below) to find the index of the last hit that can be combined.
-	auto last_in_combo = [time_current,optimal_window](HitInfo const& h) 
+	auto last_in_combo = [&time_current,optimal_window](HitInfo const& h) 
 	{
 		return h.time-time_current<=optimal_window;
 	};
@@ -39,11 +39,11 @@ class FourHitCombos
 		// which are called by the main CalculateTestPoints function.
 		// (Strictly private functions but public to be available for 
 		// running unit tests.)
-		int FindRanges(vector<HitInfo> hitinfo, int nsel, int& ncombos, vector<int>& combos_upper_bounds);
+		int FindRanges(vector<HitInfo>& hitinfo, int nsel, int& ncombos, vector<int>& combos_upper_bounds);
 		// Subsidiary functions called by the the principal functions
 		// to check that two hits are related.
-		int FindNewCombinations(vector<HitInfo> hitinfo, int nselected, float lower_bound, float upper_bound, float time_window);
-		int SetNewInterval(vector<HitInfo> hitinfo, int nselected, float optimal_window, vector<int>& combos_upper_bounds);
+		int FindNewCombinations(vector<HitInfo>& hitinfo, int nselected, float lower_bound, float upper_bound, float time_window);
+		int SetNewInterval(vector<HitInfo>& hitinfo, int nselected, float optimal_window, vector<int>& combos_upper_bounds);
 
 
 	// define the private functions and variables
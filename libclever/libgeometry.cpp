@@ -19,7 +19,13 @@
 //libGeometry constructor
 Geometry::Geometry()
 {
-	SetGeometry(numPMTs, pmtx, pmty, pmtz);
+	numPMTs = 0;
+	rmax = 0;
+	zmax = 0;
+	tmax = 0;
+	deltaRmax = 0;
+	deltaTmax = 0;
+	attenuationLength = 0;
 }
 
 //Geometry::~Geometry()
@@ -56,4 +62,8 @@ void Geometry::SetGeometry(int num_PMTs, vector<float> pmtx, vector<float> pmty,
 	zmax = z - dPMT; 
 
 }
- 
+
+void Geometry::SetAttenuationLength(float attenuation_length)
+{
+	attenuationLength = attenuation_length;
+}
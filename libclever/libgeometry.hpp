@@ -21,6 +21,9 @@ class Geometry
 		Geometry();
 
 		void SetGeometry(int numPMTs, vector<float> pmtx, vector<float> pmty, vector<float> pmtz);
+		// Set the attenuation length of the detector medium in cm
+		// (0 = not known).
+		void SetAttenuationLength(float attenuation_length);
 	
 		int numPMTs;
 		vector<float> pmtx;
@@ -32,6 +35,7 @@ class Geometry
 		float tmax; //maximum traverse time (time to cross diagonal)
 		float deltaRmax; //maximum distance to reject isolated hits
 		float deltaTmax; //maximum time to reject isolated hits
+		float attenuationLength; //attenuation length of the medium
 
 		// The following are the run-time 'constants' calculated as a function 
 		// of the detector dimensions and accessible outside the class.
@@ -64,6 +68,12 @@ class Geometry
 		inline float max_pmt_deltaR(void){
 			return(deltaRmax);
 		}
+
+		// attenuation length of the detector medium
+		// for the energy estimator (0 = not known)
+		inline float attenuation_length(void){
+			return(attenuationLength);
+		}
 		
 	private: 
 
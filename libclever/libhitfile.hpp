@@ -0,0 +1,63 @@
+#ifndef LIBHITFILE_H
+#define LIBHITFILE_H
+
+//includes
+#include <cstdint>
+
+/************************************
+ * filename: libhitfile.hpp
+ * purpose: layout of the native columnar hit file, which holds only what
+ * 			the reconstruction needs from each inner-PMT hit (PMT id, time,
+ * 			charge) so that repeated passes over a dataset do not have to
+ * 			deserialise the full RAT ROOT files again.
+ *
+ * class HitFileWriter (libhitfilewriter.hpp)
+ * class HitFileReader (libhitfilereader.hpp)
+ *
+ * The file is a fixed-size Header followed by sections, each starting on an
+ * 8-byte boundary at the byte offset given in the header:
+ * 	pmt			float[3*nPMTs]		x, y, z of each inner PMT in cm
+ * 	event		int32[2*nEvents]	event and sub-event number
+ * 	firstTime	float[nEvents]		time of the earliest hit in ns
+ * 	hitOffset	uint64[nEvents+1]	index of the first hit of each event
+ * 	pmtId		uint16[nHits]		index into the pmt section
+ * 	timeDelta	uint16[nHits]		time since the previous hit of the
+ * 									event in units of sTimeQuantum
+ * 	charge		float[nHits]		charge in p.e.
+ * Hits are stored in time order within each event, so the time deltas are
+ * never negative. All values are little-endian.
+ * **********************************/
+
+namespace libHitFile{
+
+	const char sMagic[8] = {'C','L','V','R','H','I','T','S'};
+	const uint32_t sVersion = 1;
+
+	const float sTimeQuantum = 0.05; // ns
+	// Largest time between consecutive hits of an event which can be stored.
+	const float sMaximumTimeDelta = 65535*sTimeQuantum; // ns
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t nPMTs;
+		uint64_t nEvents;
+		uint64_t nHits;
+		float timeQuantum;
+		uint32_t reserved;
+		// Byte offsets of the sections from the start of the file.
+		uint64_t pmtOffset;
+		uint64_t eventOffset;
+		uint64_t firstTimeOffset;
+		uint64_t hitOffsetOffset;
+		uint64_t pmtIdOffset;
+		uint64_t timeDeltaOffset;
+		uint64_t chargeOffset;
+		uint64_t fileSize;
+	};
+
+	static_assert(sizeof(Header) == 104, "hit file header must not be padded");
+
+}
+#endif
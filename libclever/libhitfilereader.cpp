@@ -0,0 +1,174 @@
+/**************************************************
+ * Reads the native columnar hit file through a
+ * memory mapping.
+ * Inputs: hit file
+ * Outputs: PMT positions and the hits of each event
+ *
+ * *************************************************/
+#include <iostream>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <libhitfilereader.hpp>
+
+//constructor function
+HitFileReader::HitFileReader()
+{
+	mFileDescriptor = -1;
+	mMapping = MAP_FAILED;
+	mMappingSize = 0;
+	mHeader = NULL;
+}
+
+//destructor function
+HitFileReader::~HitFileReader()
+{
+	Close();
+}
+
+int HitFileReader::Open(const char* filename)
+{
+	Close();
+	mFileDescriptor = open(filename, O_RDONLY);
+	if (mFileDescriptor < 0)
+	{
+		return(-1);
+	}
+	struct stat status;
+	if (fstat(mFileDescriptor, &status) != 0 || (size_t)status.st_size < sizeof(libHitFile::Header))
+	{
+		Close();
+		return(-1);
+	}
+	mMappingSize = status.st_size;
+	mMapping = mmap(NULL, mMappingSize, PROT_READ, MAP_SHARED, mFileDescriptor, 0);
+	if (mMapping == MAP_FAILED)
+	{
+		Close();
+		return(-1);
+	}
+	// Events are usually read in order.
+	madvise(mMapping, mMappingSize, MADV_SEQUENTIAL);
+
+	const char* base = (const char*)mMapping;
+	mHeader = (const libHitFile::Header*)base;
+	if (memcmp(mHeader->magic, libHitFile::sMagic, sizeof(mHeader->magic)) != 0
+		|| mHeader->version != libHitFile::sVersion
+		|| mHeader->fileSize != mMappingSize)
+	{
+		Close();
+		return(-1);
+	}
+
+	// Every section must lie inside the file, so that no event can be read
+	// from outside the mapping.
+	uint64_t nPMTs = mHeader->nPMTs;
+	uint64_t nEvents = mHeader->nEvents;
+	uint64_t nHits = mHeader->nHits;
+	if (nEvents >= mMappingSize || nHits >= mMappingSize
+		|| !HasSection(mHeader->pmtOffset, 3*nPMTs, sizeof(float))
+		|| !HasSection(mHeader->eventOffset, 2*nEvents, sizeof(int32_t))
+		|| !HasSection(mHeader->firstTimeOffset, nEvents, sizeof(float))
+		|| !HasSection(mHeader->hitOffsetOffset, nEvents+1, sizeof(uint64_t))
+		|| !HasSection(mHeader->pmtIdOffset, nHits, sizeof(uint16_t))
+		|| !HasSection(mHeader->timeDeltaOffset, nHits, sizeof(uint16_t))
+		|| !HasSection(mHeader->chargeOffset, nHits, sizeof(float)))
+	{
+		Close();
+		return(-1);
+	}
+	mPMTs = (const float*)(base + mHeader->pmtOffset);
+	mEvents = (const int32_t*)(base + mHeader->eventOffset);
+	mFirstTimes = (const float*)(base + mHeader->firstTimeOffset);
+	mHitOffsets = (const uint64_t*)(base + mHeader->hitOffsetOffset);
+	mPMTIds = (const uint16_t*)(base + mHeader->pmtIdOffset);
+	mTimeDeltas = (const uint16_t*)(base + mHeader->timeDeltaOffset);
+	mCharges = (const float*)(base + mHeader->chargeOffset);
+
+	// The events must cover the hits in order, and each hit must be on a
+	// PMT of the pmt section.
+	if (mHitOffsets[0] != 0 || mHitOffsets[nEvents] != nHits)
+	{
+		Close();
+		return(-1);
+	}
+	for (uint64_t index = 0; index < nEvents; index++)
+	{
+		if (mHitOffsets[index+1] < mHitOffsets[index])
+		{
+			Close();
+			return(-1);
+		}
+	}
+	for (uint64_t hit = 0; hit < nHits; hit++)
+	{
+		if (mPMTIds[hit] >= nPMTs)
+		{
+			Close();
+			return(-1);
+		}
+	}
+	return(nEvents);
+}
+
+bool HitFileReader::HasSection(uint64_t offset, uint64_t nValues, size_t valueSize)
+{
+	return(offset % 8 == 0 && offset <= mMappingSize && nValues <= (mMappingSize - offset)/valueSize);
+}
+
+void HitFileReader::Close()
+{
+	if (mMapping != MAP_FAILED)
+	{
+		munmap(mMapping, mMappingSize);
+		mMapping = MAP_FAILED;
+	}
+	if (mFileDescriptor >= 0)
+	{
+		close(mFileDescriptor);
+		mFileDescriptor = -1;
+	}
+	mHeader = NULL;
+}
+
+HitFileReader::EventSpan HitFileReader::GetEventSpan(uint64_t index)
+{
+	EventSpan span;
+	uint64_t first = mHitOffsets[index];
+	span.event = mEvents[2*index];
+	span.subEvent = mEvents[2*index+1];
+	span.nHits = mHitOffsets[index+1] - first;
+	span.firstTime = mFirstTimes[index];
+	span.pmtIds = mPMTIds + first;
+	span.timeDeltas = mTimeDeltas + first;
+	span.charges = mCharges + first;
+	return(span);
+}
+
+void HitFileReader::GetEventHits(uint64_t index, EventHits& hits)
+{
+	EventSpan span = GetEventSpan(index);
+	hits.event = span.event;
+	hits.subEvent = span.subEvent;
+	hits.times.resize(span.nHits);
+	hits.charges.assign(span.charges, span.charges + span.nHits);
+	hits.pmtx.resize(span.nHits);
+	hits.pmty.resize(span.nHits);
+	hits.pmtz.resize(span.nHits);
+
+	float quantum = mHeader->timeQuantum;
+	long quantised = 0;
+	for (int i = 0; i < span.nHits; i++)
+	{
+		quantised += span.timeDeltas[i];
+		hits.times[i] = span.firstTime + quantised*quantum;
+		int pmtId = span.pmtIds[i];
+		hits.pmtx[i] = PMTX(pmtId);
+		hits.pmty[i] = PMTY(pmtId);
+		hits.pmtz[i] = PMTZ(pmtId);
+	}
+}
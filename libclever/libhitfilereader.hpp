@@ -0,0 +1,109 @@
+#ifndef LIBHITFILEREADER_H
+#define LIBHITFILEREADER_H
+
+//includes
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <libhitfile.hpp>
+#include <libeventhits.hpp>
+
+using namespace std;
+
+/*
+ * class HitFileReader
+ * Reads the native columnar hit file (see libhitfile.hpp) by mapping it 
+ * into memory, so that nothing is copied or deserialised when the file is
+ * opened. The columns of each event are available directly as spans of the
+ * mapped file, and GetEventHits decodes them into the EventHits passed to
+ * the reconstruction. The reader only reads from the mapping, so one 
+ * reader can be shared by several threads.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class HitFileReader
+{
+
+
+	// define the public functions and variables
+	public:
+
+		// Columns of the hits of one event, pointing into the mapped file.
+		struct EventSpan
+		{
+			int event;
+			int subEvent;
+			int nHits;
+			float firstTime;
+			const uint16_t* pmtIds;
+			const uint16_t* timeDeltas;
+			const float* charges;
+		};
+
+		HitFileReader();
+		~HitFileReader();
+
+		// Map the file and check its header and sections. Returns -1 if 
+		// the file can not be opened, is not a hit file of a supported 
+		// version, or has a section outside the file, hit offsets out of 
+		// order or a PMT id with no PMT.
+		int Open(const char* filename);
+		void Close();
+
+		// Sizes of the open file (0 if none is open).
+		inline uint64_t NEvents(void){
+			return((mHeader != NULL) ? mHeader->nEvents : 0);
+		}
+
+		inline uint64_t NHits(void){
+			return((mHeader != NULL) ? mHeader->nHits : 0);
+		}
+
+		inline int NPMTs(void){
+			return((mHeader != NULL) ? mHeader->nPMTs : 0);
+		}
+
+		// Position of an inner PMT in cm.
+		inline float PMTX(int pmtId){
+			return(mPMTs[3*pmtId]);
+		}
+		inline float PMTY(int pmtId){
+			return(mPMTs[3*pmtId+1]);
+		}
+		inline float PMTZ(int pmtId){
+			return(mPMTs[3*pmtId+2]);
+		}
+
+		EventSpan GetEventSpan(uint64_t index);
+
+		// Decode the hits of an event (times and PMT positions) into hits,
+		// reusing its buffers.
+		void GetEventHits(uint64_t index, EventHits& hits);
+
+	// define the private functions and variables
+	private:
+
+		// Whether nValues values of the given size starting at the offset
+		// lie inside the mapping, on an 8-byte boundary.
+		bool HasSection(uint64_t offset, uint64_t nValues, size_t valueSize);
+
+		int mFileDescriptor;
+		void* mMapping;
+		size_t mMappingSize;
+
+		const libHitFile::Header* mHeader;
+		const float* mPMTs;
+		const int32_t* mEvents;
+		const float* mFirstTimes;
+		const uint64_t* mHitOffsets;
+		const uint16_t* mPMTIds;
+		const uint16_t* mTimeDeltas;
+		const float* mCharges;
+
+};
+
+#endif
@@ -0,0 +1,141 @@
+/**************************************************
+ * Unit tests for HitFileReader class
+ *
+ * *************************************************/
+
+#include <libhitfilereader.hpp>
+#include <libhitfilewriter.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+
+namespace{
+
+// Copy the file with the value at the byte offset replaced.
+template <class T>
+string PatchFile(string filename, string name, size_t offset, T value)
+{
+	vector<char> bytes;
+	FILE* file = fopen(filename.c_str(), "rb");
+	char buffer[4096];
+	size_t nRead;
+	while ((nRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		bytes.insert(bytes.end(), buffer, buffer+nRead);
+	}
+	fclose(file);
+	memcpy(bytes.data()+offset, &value, sizeof(value));
+	string patched = testing::TempDir() + name;
+	file = fopen(patched.c_str(), "wb");
+	fwrite(bytes.data(), 1, bytes.size(), file);
+	fclose(file);
+	return(patched);
+}
+
+TEST(HitFileReaderTest,TestWriteRead){
+
+	// Write two events and read them back through the mapping.
+	vector<float> pmtx = {100, 0, -100};
+	vector<float> pmty = {0, 100, 0};
+	vector<float> pmtz = {-50, 0, 50};
+	HitFileWriter writer;
+	EXPECT_EQ(writer.SetPMTs(pmtx, pmty, pmtz), 3);
+
+	vector<int> pmtIds = {2, 0, 1};
+	vector<float> times = {12.34, 10.0, 250.5};
+	vector<float> charges = {1.5, 2.0, 0.5};
+	EXPECT_EQ(writer.AddEvent(7, 0, pmtIds, times, charges), 3);
+	vector<int> emptyIds;
+	vector<float> emptyVector;
+	EXPECT_EQ(writer.AddEvent(7, 1, emptyIds, emptyVector, emptyVector), 0);
+
+	// Events with bad PMT ids or hits too far apart are refused.
+	vector<int> badIds = {3};
+	vector<float> badTimes = {0};
+	EXPECT_EQ(writer.AddEvent(8, 0, badIds, badTimes, charges), -1);
+	vector<int> farIds = {0, 1};
+	vector<float> farTimes = {0, 2*libHitFile::sMaximumTimeDelta};
+	EXPECT_EQ(writer.AddEvent(8, 0, farIds, farTimes, charges), -1);
+
+	string filename = testing::TempDir() + "clever_hits.bin";
+	EXPECT_EQ(writer.Write(filename.c_str()), 2);
+
+	HitFileReader reader;
+	EXPECT_EQ(reader.Open(filename.c_str()), 2);
+	EXPECT_EQ(reader.NHits(), 3);
+	EXPECT_EQ(reader.NPMTs(), 3);
+
+	// The hits come back in time order, with times to within the quantum.
+	HitFileReader::EventSpan span = reader.GetEventSpan(0);
+	EXPECT_EQ(span.event, 7);
+	EXPECT_EQ(span.subEvent, 0);
+	EXPECT_EQ(span.nHits, 3);
+	EXPECT_EQ(span.pmtIds[0], 0);
+	EXPECT_EQ(span.pmtIds[1], 2);
+	EXPECT_EQ(span.pmtIds[2], 1);
+
+	EventHits hits;
+	reader.GetEventHits(0, hits);
+	EXPECT_EQ(hits.nhits(), 3);
+	vector<float> expectedTimes = {10.0, 12.34, 250.5};
+	vector<float> expectedCharges = {2.0, 1.5, 0.5};
+	for (int i = 0; i < 3; i++)
+	{
+		EXPECT_NEAR(hits.times[i], expectedTimes[i], 0.5*libHitFile::sTimeQuantum);
+		EXPECT_FLOAT_EQ(hits.charges[i], expectedCharges[i]);
+	}
+	EXPECT_FLOAT_EQ(hits.pmtx[1], -100);
+	EXPECT_FLOAT_EQ(hits.pmtz[1], 50);
+
+	reader.GetEventHits(1, hits);
+	EXPECT_EQ(hits.subEvent, 1);
+	EXPECT_EQ(hits.nhits(), 0);
+
+	// Anything else is not opened.
+	EXPECT_EQ(reader.Open((testing::TempDir() + "clever_missing.bin").c_str()), -1);
+
+}
+
+TEST(HitFileReaderTest,TestCorruptFiles){
+
+	vector<float> pmtx = {100, 0}, pmty = {0, 100}, pmtz = {0, 0};
+	HitFileWriter writer;
+	writer.SetPMTs(pmtx, pmty, pmtz);
+	vector<int> pmtIds = {0, 1};
+	vector<float> times = {10, 20};
+	vector<float> charges = {1, 2};
+	writer.AddEvent(1, 0, pmtIds, times, charges);
+	string filename = testing::TempDir() + "clever_good_hits.bin";
+	EXPECT_EQ(writer.Write(filename.c_str()), 1);
+	libHitFile::Header header;
+	FILE* file = fopen(filename.c_str(), "rb");
+	ASSERT_EQ(fread(&header, sizeof(header), 1, file), 1);
+	fclose(file);
+
+	// Nothing is read before a file is open.
+	HitFileReader reader;
+	EXPECT_EQ(reader.NEvents(), 0);
+	EXPECT_EQ(reader.NHits(), 0);
+	EXPECT_EQ(reader.NPMTs(), 0);
+	EXPECT_EQ(reader.Open(filename.c_str()), 1);
+
+	// Sections running past the end of the file.
+	string corrupt = PatchFile(filename, "clever_corrupt_hits.bin", offsetof(libHitFile::Header, chargeOffset), header.fileSize);
+	EXPECT_EQ(reader.Open(corrupt.c_str()), -1);
+	EXPECT_EQ(reader.NEvents(), 0);
+	corrupt = PatchFile(filename, "clever_corrupt_hits.bin", offsetof(libHitFile::Header, nEvents), (uint64_t)1000);
+	EXPECT_EQ(reader.Open(corrupt.c_str()), -1);
+	// Hit offsets which do not match the number of hits.
+	corrupt = PatchFile(filename, "clever_corrupt_hits.bin", header.hitOffsetOffset + sizeof(uint64_t), (uint64_t)3);
+	EXPECT_EQ(reader.Open(corrupt.c_str()), -1);
+	// A hit on a PMT which is not in the file.
+	corrupt = PatchFile(filename, "clever_corrupt_hits.bin", header.pmtIdOffset + sizeof(uint16_t), (uint16_t)2);
+	EXPECT_EQ(reader.Open(corrupt.c_str()), -1);
+	EXPECT_EQ(reader.NPMTs(), 0);
+
+}
+
+}
@@ -0,0 +1,143 @@
+/**************************************************
+ * Writes the hits of each event to the native 
+ * columnar hit file.
+ * Inputs: inner PMT positions and the PMT ids, times
+ * 		   and charges of the hits of each event
+ * Outputs: hit file
+ *
+ * *************************************************/
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <numeric> //iota()
+
+#include <libhitfilewriter.hpp>
+
+//constructor function
+HitFileWriter::HitFileWriter()
+{
+	mHitOffsetVector.push_back(0);
+}
+
+//destructor function
+HitFileWriter::~HitFileWriter()
+{
+}
+
+int HitFileWriter::SetPMTs(vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz)
+{
+	// PMT ids are stored in 16 bits.
+	if (pmtx.size() > 65536 || pmty.size() != pmtx.size() || pmtz.size() != pmtx.size())
+	{
+		return(-1);
+	}
+	mPMTVector.clear();
+	for (size_t i = 0; i < pmtx.size(); i++)
+	{
+		mPMTVector.push_back(pmtx[i]);
+		mPMTVector.push_back(pmty[i]);
+		mPMTVector.push_back(pmtz[i]);
+	}
+	return(pmtx.size());
+}
+
+int HitFileWriter::AddEvent(int event, int subEvent, vector<int>& pmtIds, vector<float>& times, vector<float>& charges)
+{
+	int nhits = times.size();
+	int nPMTs = mPMTVector.size()/3;
+
+	// Store the hits in time order so that the time deltas are positive.
+	mOrderVector.resize(nhits);
+	iota(mOrderVector.begin(), mOrderVector.end(), 0);
+	sort(mOrderVector.begin(), mOrderVector.end(), [&times](int i, int j)
+	{
+		return times[i] < times[j];
+	});
+
+	float firstTime = (nhits > 0) ? times[mOrderVector[0]] : 0;
+	float quantum = libHitFile::sTimeQuantum;
+	// Check the whole event before adding any of it.
+	long previous = 0;
+	for (int i : mOrderVector)
+	{
+		long quantised = lround((times[i]-firstTime)/quantum);
+		if (pmtIds[i] < 0 || pmtIds[i] >= nPMTs || quantised - previous > 65535)
+		{
+			return(-1);
+		}
+		previous = quantised;
+	}
+
+	// Deltas are taken between the quantised times so that rounding errors
+	// do not add up along the event.
+	previous = 0;
+	for (int i : mOrderVector)
+	{
+		long quantised = lround((times[i]-firstTime)/quantum);
+		mPMTIdVector.push_back(pmtIds[i]);
+		mTimeDeltaVector.push_back(quantised - previous);
+		mChargeVector.push_back(charges[i]);
+		previous = quantised;
+	}
+	mEventVector.push_back(event);
+	mEventVector.push_back(subEvent);
+	mFirstTimeVector.push_back(firstTime);
+	mHitOffsetVector.push_back(mPMTIdVector.size());
+	return(nhits);
+}
+
+// Start of the next section, on an 8-byte boundary.
+static uint64_t NextOffset(uint64_t offset, uint64_t size)
+{
+	return((offset + size + 7) & ~(uint64_t)7);
+}
+
+// Write a section followed by the padding up to the next section.
+static bool WriteSection(FILE* file, const void* data, uint64_t size, uint64_t offset)
+{
+	static const char padding[8] = {0};
+	uint64_t nPadding = NextOffset(offset, size) - offset - size;
+	return(fwrite(data, 1, size, file) == size && fwrite(padding, 1, nPadding, file) == nPadding);
+}
+
+int HitFileWriter::Write(const char* filename)
+{
+	libHitFile::Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, libHitFile::sMagic, sizeof(header.magic));
+	header.version = libHitFile::sVersion;
+	header.nPMTs = mPMTVector.size()/3;
+	header.nEvents = NEvents();
+	header.nHits = NHits();
+	header.timeQuantum = libHitFile::sTimeQuantum;
+
+	header.pmtOffset = NextOffset(0, sizeof(header));
+	header.eventOffset = NextOffset(header.pmtOffset, mPMTVector.size()*sizeof(float));
+	header.firstTimeOffset = NextOffset(header.eventOffset, mEventVector.size()*sizeof(int32_t));
+	header.hitOffsetOffset = NextOffset(header.firstTimeOffset, mFirstTimeVector.size()*sizeof(float));
+	header.pmtIdOffset = NextOffset(header.hitOffsetOffset, mHitOffsetVector.size()*sizeof(uint64_t));
+	header.timeDeltaOffset = NextOffset(header.pmtIdOffset, mPMTIdVector.size()*sizeof(uint16_t));
+	header.chargeOffset = NextOffset(header.timeDeltaOffset, mTimeDeltaVector.size()*sizeof(uint16_t));
+	header.fileSize = NextOffset(header.chargeOffset, mChargeVector.size()*sizeof(float));
+
+	FILE* file = fopen(filename, "wb");
+	if (file == NULL)
+	{
+		return(-1);
+	}
+	bool ok = WriteSection(file, &header, sizeof(header), 0)
+		&& WriteSection(file, mPMTVector.data(), mPMTVector.size()*sizeof(float), header.pmtOffset)
+		&& WriteSection(file, mEventVector.data(), mEventVector.size()*sizeof(int32_t), header.eventOffset)
+		&& WriteSection(file, mFirstTimeVector.data(), mFirstTimeVector.size()*sizeof(float), header.firstTimeOffset)
+		&& WriteSection(file, mHitOffsetVector.data(), mHitOffsetVector.size()*sizeof(uint64_t), header.hitOffsetOffset)
+		&& WriteSection(file, mPMTIdVector.data(), mPMTIdVector.size()*sizeof(uint16_t), header.pmtIdOffset)
+		&& WriteSection(file, mTimeDeltaVector.data(), mTimeDeltaVector.size()*sizeof(uint16_t), header.timeDeltaOffset)
+		&& WriteSection(file, mChargeVector.data(), mChargeVector.size()*sizeof(float), header.chargeOffset);
+	if (fclose(file) != 0 || !ok)
+	{
+		return(-1);
+	}
+	return(header.nEvents);
+}
@@ -0,0 +1,69 @@
+#ifndef LIBHITFILEWRITER_H
+#define LIBHITFILEWRITER_H
+
+//includes
+#include <vector>
+#include <cstdint>
+#include <libhitfile.hpp>
+
+using namespace std;
+
+/*
+ * class HitFileWriter
+ * Writes events to the native columnar hit file (see libhitfile.hpp).
+ * The columns are collected in memory (8 bytes per hit) and written out 
+ * in one go by Close, when the number of events and hits is known.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class HitFileWriter
+{
+
+
+	// define the public functions and variables
+	public:
+
+		HitFileWriter();
+		~HitFileWriter();
+
+		// Set the positions of the inner PMTs. The PMT ids of the hits are
+		// indices into these vectors.
+		int SetPMTs(vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz);
+
+		// Add the hits of one (sub-)event. Returns -1 if the event can not 
+		// be stored, i.e. a PMT id is out of range or two consecutive hits
+		// are more than libHitFile::sMaximumTimeDelta apart.
+		int AddEvent(int event, int subEvent, vector<int>& pmtIds, vector<float>& times, vector<float>& charges);
+
+		// Write the file. Returns -1 if it could not be written.
+		int Write(const char* filename);
+
+		inline uint64_t NEvents(void){
+			return(mEventVector.size()/2);
+		}
+
+		inline uint64_t NHits(void){
+			return(mPMTIdVector.size());
+		}
+
+	// define the private functions and variables
+	private:
+
+		vector<float> mPMTVector;
+		vector<int32_t> mEventVector;
+		vector<float> mFirstTimeVector;
+		vector<uint64_t> mHitOffsetVector;
+		vector<uint16_t> mPMTIdVector;
+		vector<uint16_t> mTimeDeltaVector;
+		vector<float> mChargeVector;
+
+		// Buffer for sorting the hits of an event by time.
+		vector<int> mOrderVector;
+
+};
+
+#endif
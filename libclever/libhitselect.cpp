@@ -4,7 +4,6 @@
 #include <iostream>
 #include <libconstants.hpp>
 #include <libhitselect.hpp>
-#include <libgeometry.hpp>
 #include <libhitinfo.hpp>
 #include <cmath> //size()
 #include <algorithm> //count()
@@ -23,8 +22,7 @@ HitSelect::HitSelect()
 {
 	nhits_isolated_removed = 0;
 	nhits_causally_related = 0;
-	SelectHits(nhits_all, times_all, charges_all, pmtx, pmty, pmtz, hitinfo, traverseTmax, dTmax, dRmax);
-
+	nhits = 0;
 }
 
 //destructor function
@@ -38,8 +36,10 @@ HitSelect::~HitSelect()
 	nhits_causally_related = 0;
 }
 
-int HitSelect::SelectHits(int nhits_all, vector<float> times_all, vector<float> charges_all, vector<float> pmtx, vector<float> pmty, vector <float> pmtz, vector<HitInfo>& hitinfo, float traverseTmax, float dTmax, float dRmax)
+int HitSelect::SelectHits(int nhits_all, vector<float>& times_all, vector<float>& charges_all, vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz, vector<HitInfo>& hitinfo, float traverseTmax, float dTmax, float dRmax)
 {
+	truncated = 0;
+
 	// Do not proceed with reconstruction if nhits outside reconstructable range
 	if (nhits_all < minhits || nhits_all > maxhits) 
 	{
@@ -205,13 +205,16 @@ int HitSelect::GetCausallyRelatedHits(int nhits_isolated_removed,vector<HitInfo>
 	}
 	
 	// Now remove the hits which are related to fewer than 3 other events.
-	hitinfo.erase(remove_if(hitinfo.begin(),hitinfo.end(),[](HitInfo const& hit)
+	vector<int> kept_hits;
+	for (int i = 0; i< nhits_isolated_removed; i++)
 	{
-		return hit.nrelated < 3;
+		if (hitinfo[i].nrelated >= 3)
+		{
+			kept_hits.push_back(i);
+		}
 	}
-	),hitinfo.end());
 
-	nhits_causally_related = size(hitinfo);
+	nhits_causally_related = size(kept_hits);
 
 	// return if there are not enough causally related hits
 	if (nhits_causally_related<=minhits)
@@ -229,8 +232,10 @@ int HitSelect::GetCausallyRelatedHits(int nhits_isolated_removed,vector<HitInfo>
 	// sort by charge in descending order.
 	// This is to make the cluster-finding step more efficient. In general,
 	// the hits that have the most relations will create the biggest clusters.
-	auto sortRule = [](HitInfo const& h1, HitInfo const& h2) -> bool
+	auto sortRule = [&hitinfo](int i, int j) -> bool
 	{
+		HitInfo const& h1 = hitinfo[i];
+		HitInfo const& h2 = hitinfo[j];
 		// if the numbers of related pmts are equal, sort by charge
 		if (h1.nrelated==h2.nrelated)
 		{
@@ -243,7 +248,8 @@ int HitSelect::GetCausallyRelatedHits(int nhits_isolated_removed,vector<HitInfo>
 		}
 	};
 
-	sort(hitinfo.begin(), hitinfo.end(), sortRule);
+	sort(kept_hits.begin(), kept_hits.end(), sortRule);
+	KeepHits(kept_hits, hitinfo);
 	
 	return(nhits_causally_related);
 
@@ -268,158 +274,17 @@ int HitSelect::FindHitClusters(int nhits_causally_related, vector<HitInfo>& hiti
 	// If there are sufficient interrelated hits in the cluster, then the 
 	// cluster vector will be added to all_clusters.
 
-	// Set the minimum cluster size to minhits (3). This will later be updated 
-	// to the size of the maximum cluster found and will be used to avoid 
-	// going through all of the loops.
-	int min_cluster_size = minhits;
-	// Make a vector to store the number of other related 
-	// cluster hits for each hit in the cluster and 
-	// intialise to zero.
-	vector<int> nrel_cluster(nhits_causally_related);
-
-	// Now loop over the hits and treat each pair of related hits as seeds 
-	// for a cluster
-	for (int seed1=0; seed1<nhits_causally_related-1; seed1++)
+	// Find the clusters, sharing the seed loop with idle workers for large
+	// events. The size of the biggest cluster found is returned.
+	int min_cluster_size;
+	if (scheduler != nullptr && nhits_causally_related >= libConstants::sParallelMinimumHits)
 	{
-
-		// Check that nrelated is greater than the maximum cluster size
-		// so far. This saves time since we are only going to use the first 
-		// occurrence of a cluster with the maximum cluster size.
-		if (hitinfo[seed1].nrelated<min_cluster_size)
-		{
-			continue;
-		}
-		for (int seed2=seed1+1; seed2<nhits_causally_related; seed2++)
-		{   
-			memset(&nrel_cluster[0], 0, nrel_cluster.size() * sizeof nrel_cluster[0]);
-			// TODO logging information
-			// Create a vector to store which hits are in the cluster.
-			vector <int> cluster(nhits_causally_related);
-			int candidate_size;
-			
-			// If two hits are related then use the pair as a seed to check 
-			// for a cluster. Also check that the second seed has sufficient
-			// related hits (greater than or equal to the current max cluster 
-			// size) to be in a cluster. 
-			if (hitinfo[seed1].is_related[seed2] && hitinfo[seed2].nrelated>=min_cluster_size)
-			{
-				candidate_size = FindClusterCandidate(nhits_causally_related,seed1,seed2,hitinfo,cluster);
-			} 
-
-			// Skip to the next seed pair if not related or not enough hit
-			if (candidate_size<minhits)
-			{
-				//TODO info logging
-				cout << "Candidate cluster contains too few hits. Skipping to next seed pair" << endl;
-				continue;
-			}
-
-			// Now that we have looked at all cluster candidates for the seed
-			// pair, loop over all cluster candidates and check that they are 
-			// all related to each other. (We already know they are related 
-			// to the seed pair.)
-
-
-			for (int hit1 = 0; hit1<nhits_causally_related-1; hit1++)
-			{
-				for (int hit2 = hit1+1; hit2<nhits_causally_related; hit2++)
-				{
-					// See how many other hits in the cluster each candidate 
-					// is related to. 
-					if ( cluster[hit1] && cluster[hit2] && hitinfo[hit1].is_related[hit2])
-					{
-						nrel_cluster[hit1]++;
-						nrel_cluster[hit2]++;
-					}
-				}
-			
-			}
-
-			// Loop over the rest of the cluster hits (not the seed hits).
-			for (int hit1 = 2; hit1<nhits_causally_related; hit1++)
-			{
-				// For each hit, if the number of related hits in the same 
-				// cluster (nrelated) is less than the number of hits in the 
-				// cluster, then remove unrelated hits from the cluster in order
-				// of descending number of unrelated hits.
-
-				// First see how many (if any) other hits in the cluster are
-				// unrelated.
-				int unrelated = count(cluster.begin(),cluster.end(),1)-(nrel_cluster[hit1]+1);
-				for (int hit2 = hit1+1; hit2<nhits_causally_related; hit2++)
-				{
-					while (unrelated>0) // Stop checking if there are no (more) 
-										//unrelated hits.
-					{
-						// If hit 1 and hit 2 are unrelated
-						if (!hitinfo[hit1].is_related[hit2])
-						{
-							// Remove the one with the fewest relations.
-							// Or both if the numbers of relations are the same.
-							// No need to remove is_related because these hits
-							// will be removed from the cluster anyway.
-							if (nrel_cluster[hit1]==nrel_cluster[hit2])
-							{
-								cluster[hit1] = 0;
-								cluster[hit2] = 0;
-								// remove 2 from the nrel tallies
-								for(auto& nrel : nrel_cluster)
-								{
-									if (nrel>1)
-									{
-								    	nrel-=2;	
-									}
-									else if (nrel>0)
-									{
-										nrel--;
-									}
-								}
-							}
-							else if (nrel_cluster[hit1] < nrel_cluster[hit2])
-							{
-								cluster[hit1] = 0;
-								// remove 1 from the nrel tallies
-								for(auto& nrel : nrel_cluster)
-								{
-									if (nrel>0)
-									{
-								    	nrel --;	
-									}
-								}
-							}
-							else 
-							{
-								cluster[hit2] = 0;
-								// remove 1 from the nrel tallies
-								for(auto& nrel : nrel_cluster)
-								{
-									if (nrel>0)
-									{
-								    	nrel --;	
-									}
-								}
-							}
-							// remove this hit from the tally of 
-							// unrelated hits for hit 1.
-						}
-						unrelated--;
-					}
-				}
-			}
-
-			// Save the cluster for this seed pair if it's big enough.
-			//
-			// Iterate backwards over the vectors and subtract from tally each
-			// hit for which hitinfo[i].nrelations+1<min_cluster_size.
-			int cluster_size = count(cluster.begin(),cluster.end(),1);
-			if (cluster_size>=min_cluster_size)
-			{
-				all_clusters.push_back(cluster);
-				min_cluster_size = cluster_size; // set min_cluster_size to largest so far
-			}
-			nrel_cluster.clear();
-		} // End loop over second hit seed2.
-	} //end loop over first hit seed1
+		min_cluster_size = FindClustersParallel(nhits_causally_related, hitinfo, all_clusters);
+	}
+	else
+	{
+		min_cluster_size = FindClusters(nhits_causally_related, hitinfo, all_clusters);
+	}
 
 	// Unify all found clusters and note how often a PMT appears in a cluster
 	// (hitsel.cc:526) 
@@ -454,6 +319,10 @@ int HitSelect::FindHitClusters(int nhits_causally_related, vector<HitInfo>& hiti
 	// Get the total number of clusters with the size of the biggest cluster.
 	// This is used to define which hits have a high occurence in clusters.
 	nclusters = (int)all_clusters.size();
+	if (nclusters == 0)
+	{
+		return(-1);
+	}
 	// Mark the hits that are in the final cluster of all_clusters by updating
 	// is_selected.
 	// TODO this is what is done in BONSAI but is there a better way to select
@@ -465,20 +334,44 @@ int HitSelect::FindHitClusters(int nhits_causally_related, vector<HitInfo>& hiti
 	{
 		hitinfo[i].is_selected = all_clusters[nclusters-1][i];
 	}
+
+	// Note the number of other hits in the final cluster that each hit is
+	// related to.
+	vector<int>& best_cluster = all_clusters[nclusters-1];
+	for (int hit1 = 0; hit1<nhits_causally_related; hit1++)
+	{
+		hitinfo[hit1].nselected = 0;
+		for (int hit2 = 0; hit2<nhits_causally_related; hit2++)
+		{
+			if (hit1 != hit2 && best_cluster[hit1] && best_cluster[hit2] && hitinfo[hit1].is_related[hit2])
+			{
+				hitinfo[hit1].nselected++;
+			}
+		}
+	}
 	
 	// Select all hits with high occurrence in clusters. Remove remainder.
 	// TODO BONSAI mentions selecting those with medium occurrence if their 
 	// charge is within a reasonable range but this is commented out. Should
 	// consider whether this will be useful.
 	int min_occurrence = 1+2*(nclusters-1)/3;
-	hitinfo.erase(remove_if(hitinfo.begin(), hitinfo.end(), [nclusters, min_occurrence](HitInfo const& hit)
+	vector<int> kept_hits;
+	for (int hit = 0; hit<nhits_causally_related; hit++)
 	{
 		// TODO how is this defined????
-		return hit.noccurrence<min_occurrence; 
+		if (hitinfo[hit].noccurrence>=min_occurrence)
+		{
+			kept_hits.push_back(hit);
+		}
 	}
-	), hitinfo.end());
+	KeepHits(kept_hits, hitinfo);
 
 	int nhits_high_occurrence = size(hitinfo);
+	vector<int> nrel_cluster(nhits_high_occurrence);
+	for (int hit = 0; hit<nhits_high_occurrence; hit++)
+	{
+		nrel_cluster[hit] = hitinfo[hit].nselected;
+	}
 
 	// With hits of low to medium occurrence removed, check that each
 	// hit in the cluster has the minimum number of related hits within the
@@ -584,22 +477,246 @@ int HitSelect::FindHitClusters(int nhits_causally_related, vector<HitInfo>& hiti
 }
 
 
+int HitSelect::FindClusters(int nhits_causally_related, vector<HitInfo>& hitinfo, vector<vector<int>>& all_clusters)
+{
+	// Set the minimum cluster size to minhits (3). This will later be updated 
+	// to the size of the maximum cluster found and will be used to avoid 
+	// going through all of the loops.
+	int min_cluster_size = minhits;
+	// A cluster vector is filled for each related pair of hits seed1 and 
+	// seed2, with the number of other related cluster hits for each hit.
+	vector<int> cluster(nhits_causally_related);
+	vector<int> nrel_cluster(nhits_causally_related);
+
+	// Now loop over the hits and treat each pair of related hits as seeds 
+	// for a cluster
+	for (int seed1=0; seed1<nhits_causally_related-1; seed1++)
+	{
+		// Stop seeding new clusters once the time budget has run out, as 
+		// long as a cluster has already been found.
+		if (all_clusters.size() > 0 && deadline.HasExpired())
+		{
+			truncated = 1;
+			break;
+		}
+
+		// Check that nrelated is greater than the maximum cluster size
+		// so far. This saves time since we are only going to use the first 
+		// occurrence of a cluster with the maximum cluster size.
+		if (hitinfo[seed1].nrelated<min_cluster_size)
+		{
+			continue;
+		}
+		for (int seed2=seed1+1; seed2<nhits_causally_related; seed2++)
+		{   
+			// If two hits are related then use the pair as a seed to check 
+			// for a cluster. Also check that the second seed has sufficient
+			// related hits (greater than or equal to the current max cluster 
+			// size) to be in a cluster. 
+			if (!hitinfo[seed1].is_related[seed2] || hitinfo[seed2].nrelated<min_cluster_size)
+			{
+				continue;
+			}
+			int cluster_size = BuildCluster(nhits_causally_related,seed1,seed2,hitinfo,cluster,nrel_cluster);
+
+			// Save the cluster for this seed pair if it's big enough.
+			if (cluster_size>=min_cluster_size)
+			{
+				all_clusters.push_back(cluster);
+				min_cluster_size = cluster_size; // set min_cluster_size to largest so far
+			}
+		} // End loop over second hit seed2.
+	} //end loop over first hit seed1
+
+	return(min_cluster_size);
+}
+
+int HitSelect::FindClustersParallel(int nhits_causally_related, vector<HitInfo>& hitinfo, vector<vector<int>>& all_clusters)
+{
+	// The seed1 loop of FindClusters is split into tasks. Each task keeps
+	// the clusters which are at least as big as any found before them in
+	// the task, which includes every cluster that FindClusters would keep
+	// (the biggest cluster so far can only be bigger across all tasks).
+	// The clusters are then taken in seed order with the same tests as in
+	// FindClusters, so that the same clusters are selected.
+	int grain = libConstants::sClusterSeedGrain;
+	int nseeds = nhits_causally_related-1;
+	int ntasks = (nseeds+grain-1)/grain;
+	vector<vector<vector<int>>> task_clusters(ntasks);
+	vector<vector<int>> task_seeds(ntasks); // {seed1, seed2, size} per cluster
+	vector<int> task_truncated(ntasks, 0);
+
+	scheduler->ParallelFor(worker, nseeds, grain, [&] (int, int first, int last)
+	{
+		int task = first/grain;
+		int min_cluster_size = minhits;
+		vector<int> cluster(nhits_causally_related);
+		vector<int> nrel_cluster(nhits_causally_related);
+		for (int seed1=first; seed1<last; seed1++)
+		{
+			if (task_clusters[task].size() > 0 && deadline.HasExpired())
+			{
+				task_truncated[task] = 1;
+				break;
+			}
+			if (hitinfo[seed1].nrelated<min_cluster_size)
+			{
+				continue;
+			}
+			for (int seed2=seed1+1; seed2<nhits_causally_related; seed2++)
+			{
+				if (!hitinfo[seed1].is_related[seed2] || hitinfo[seed2].nrelated<min_cluster_size)
+				{
+					continue;
+				}
+				int cluster_size = BuildCluster(nhits_causally_related,seed1,seed2,hitinfo,cluster,nrel_cluster);
+				if (cluster_size>=min_cluster_size)
+				{
+					task_clusters[task].push_back(cluster);
+					task_seeds[task].insert(task_seeds[task].end(), {seed1, seed2, cluster_size});
+					min_cluster_size = cluster_size;
+				}
+			}
+		}
+	});
+
+	int min_cluster_size = minhits;
+	int current_seed1 = -1;
+	int seed1_min_cluster_size = minhits;
+	for (int task = 0; task < ntasks; task++)
+	{
+		truncated |= task_truncated[task];
+		for (int clus = 0; clus < (int)task_clusters[task].size(); clus++)
+		{
+			int seed1 = task_seeds[task][3*clus];
+			int seed2 = task_seeds[task][3*clus+1];
+			int cluster_size = task_seeds[task][3*clus+2];
+			// FindClusters tests seed1 against the biggest cluster found
+			// before its loop over seed2 started.
+			if (seed1 != current_seed1)
+			{
+				current_seed1 = seed1;
+				seed1_min_cluster_size = min_cluster_size;
+			}
+			if (hitinfo[seed1].nrelated<seed1_min_cluster_size || hitinfo[seed2].nrelated<min_cluster_size || cluster_size<min_cluster_size)
+			{
+				continue;
+			}
+			all_clusters.push_back(task_clusters[task][clus]);
+			min_cluster_size = cluster_size;
+		}
+	}
+	return(min_cluster_size);
+}
+
 // ******************************************************************** //
 // These are the subsidiary functions called by the principal functions 
 // which are in turn called by the main HitSelect function.
 
-int HitSelect::CheckCoincidence(int i, int j, vector<HitInfo> hitinfo, float dTmax,float dRmax)
+int HitSelect::BuildCluster(int nhits_causally_related, int seed1, int seed2, vector<HitInfo>& hitinfo, vector<int>& cluster, vector<int>& nrel_cluster)
+{
+	// Builds the cluster of hits related to the seed pair and returns its
+	// size (0 if there are too few hits).
+	fill(cluster.begin(), cluster.end(), 0);
+	fill(nrel_cluster.begin(), nrel_cluster.end(), 0);
+	int candidate_size = FindClusterCandidate(nhits_causally_related,seed1,seed2,hitinfo,cluster);
+
+	// Skip to the next seed pair if there are not enough hits
+	if (candidate_size<minhits)
+	{
+		//TODO info logging
+		//cout << "Candidate cluster contains too few hits. Skipping to next seed pair" << endl;
+		return(0);
+	}
+
+	for (int hit1 = 0; hit1<nhits_causally_related-1; hit1++)
+	{
+		for (int hit2 = hit1+1; hit2<nhits_causally_related; hit2++)
+		{
+			// See how many other hits in the cluster each candidate 
+			// is related to. 
+			if ( cluster[hit1] && cluster[hit2] && hitinfo[hit1].is_related[hit2])
+			{
+				nrel_cluster[hit1]++;
+				nrel_cluster[hit2]++;
+			}
+		}
+	
+	}
+
+	// Remove unrelated hits from the cluster: for each pair of cluster 
+	// hits which are not related, remove the one with fewer relations in 
+	// the cluster, or both if the numbers of relations are the same. The
+	// seeds are related to every candidate, so are never removed.
+	for (int hit1 = 0; hit1<nhits_causally_related; hit1++)
+	{
+		for (int hit2 = hit1+1; hit2<nhits_causally_related && cluster[hit1]; hit2++)
+		{
+			if (!cluster[hit2] || hitinfo[hit1].is_related[hit2])
+			{
+				continue;
+			}
+			int nrel1 = nrel_cluster[hit1];
+			int nrel2 = nrel_cluster[hit2];
+			if (nrel1 <= nrel2)
+			{
+				RemoveFromCluster(nhits_causally_related,hit1,hitinfo,cluster,nrel_cluster);
+			}
+			if (nrel2 <= nrel1)
+			{
+				RemoveFromCluster(nhits_causally_related,hit2,hitinfo,cluster,nrel_cluster);
+			}
+		}
+	}
+
+	return(count(cluster.begin(),cluster.end(),1));
+}
+
+void HitSelect::RemoveFromCluster(int nhits_causally_related, int hit, vector<HitInfo>& hitinfo, vector<int>& cluster, vector<int>& nrel_cluster)
+{
+	// Remove a hit from the cluster and from the relation tallies of the 
+	// cluster hits related to it.
+	cluster[hit] = 0;
+	for (int other = 0; other<nhits_causally_related; other++)
+	{
+		if (other != hit && cluster[other] && hitinfo[hit].is_related[other])
+		{
+			nrel_cluster[other]--;
+		}
+	}
+}
+
+void HitSelect::KeepHits(vector<int>& kept_hits, vector<HitInfo>& hitinfo)
+{
+	// Keep the listed hits, in the order listed, and index is_related by
+	// the new positions of the hits.
+	vector<HitInfo> kept_hitinfo;
+	kept_hitinfo.reserve(kept_hits.size());
+	for (int hit : kept_hits)
+	{
+		kept_hitinfo.push_back(hitinfo[hit]);
+		vector<int>& is_related = kept_hitinfo.back().is_related;
+		for (int i = 0; i<(int)kept_hits.size(); i++)
+		{
+			is_related[i] = hitinfo[hit].is_related[kept_hits[i]];
+		}
+		is_related.resize(kept_hits.size());
+	}
+	hitinfo.swap(kept_hitinfo);
+}
+
+int HitSelect::CheckCoincidence(int i, int j, vector<HitInfo>& hitinfo, float dTmax,float dRmax)
 {
 	// Check whether or not two hits are isolated from each other
 	// return (1) if PMT pair are not isolated from each other
 	float deltaT = fabs(hitinfo[i].time-hitinfo[j].time);
-	float deltaD = DeltaDistance2(i,j,hitinfo);
+	float deltaD2 = DeltaDistance2(i,j,hitinfo);
 	
-	return( (deltaT<dTmax) && (deltaD<dRmax) );
+	return( (deltaT<dTmax) && (deltaD2<dRmax*dRmax) );
 
 }
 
-float HitSelect::DeltaDistance2(int i, int j, vector<HitInfo> hitinfo)
+float HitSelect::DeltaDistance2(int i, int j, vector<HitInfo>& hitinfo)
 {
 	// Calculate distance squared between two hit PMTs
 	float dx = hitinfo[i].pmtx-hitinfo[j].pmtx;
@@ -609,7 +726,7 @@ float HitSelect::DeltaDistance2(int i, int j, vector<HitInfo> hitinfo)
 
 }
 
-int HitSelect::CheckCausal(int i,int j, vector<HitInfo> hitinfo, float traverseTmax)
+int HitSelect::CheckCausal(int i,int j, vector<HitInfo>& hitinfo, float traverseTmax)
 {
 	
 	float deltaT = fabs(hitinfo[i].time-hitinfo[j].time);
@@ -620,13 +737,12 @@ int HitSelect::CheckCausal(int i,int j, vector<HitInfo> hitinfo, float traverseT
 	{
 		return (0);
 	}
-	Geometry geo;
 	if (deltaT > traverseTmax)
 	{
 		return (0);
 	}
 
-	return(deltaT*deltaT<=deltaD2/libConstants::sCmPerNs);
+	return(deltaT*deltaT<=deltaD2/(libConstants::sCmPerNs*libConstants::sCmPerNs));
 }
 
 int HitSelect::FindClusterCandidate(int nhits_causally_related, int seed1, int seed2, vector <HitInfo>& hitinfo, vector<int>& cluster)
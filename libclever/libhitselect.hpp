@@ -4,6 +4,8 @@
 //includes
 #include <vector>
 #include <libhitinfo.hpp>
+#include <libdeadline.hpp>
+#include <libtaskscheduler.hpp>
 
 using namespace std;
 
@@ -31,8 +33,18 @@ class HitSelect
 		
 		
 		// Main function called from outside class.
-		int SelectHits(int nhits_all, vector<float> times_all, vector<float> charges_all, vector<float> pmtx, vector<float> pmty, vector<float> pmtz, vector<HitInfo>& hitinfo, float traverseTmax, float dTmax, float dRmax);
+		int SelectHits(int nhits_all, vector<float>& times_all, vector<float>& charges_all, vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz, vector<HitInfo>& hitinfo, float traverseTmax, float dTmax, float dRmax);
 	
+		// Set the time budget for the event. If it runs out while looking 
+		// for clusters, the clusters found so far are used and the 
+		// selection is flagged as truncated.
+		void SetDeadline(Deadline& event_deadline){ deadline = event_deadline; };
+		int IsTruncated(){ return truncated; };
+
+		// Share the cluster seed loop of large events with the other 
+		// workers of the scheduler (nullptr = run it on this worker).
+		void SetScheduler(TaskScheduler* task_scheduler, int scheduler_worker){ scheduler = task_scheduler; worker = scheduler_worker; };
+
 		// Principal functions which perform the hit selection and which are
 		// called by the main SelectHits function.
 		// (Strictly private functions but public to be available for 
@@ -40,16 +52,24 @@ class HitSelect
 		int RemoveIsolatedHits(int nhits_all, vector<HitInfo>& hitinfo, int& nhits_isolated_removed, float dTmax, float dRmax);	
 		int GetCausallyRelatedHits(int nhits_isolated_removed, vector<HitInfo>& hitinfoi, int& nhits_causally_related, float traverseTmax);	
 		int FindHitClusters(int nhits_causally_related, vector<HitInfo>& hitinfo);
+		// Find the clusters seeded by each related pair of hits, keeping
+		// those at least as big as any found before. Return the size of
+		// the biggest. The parallel version gives the same clusters.
+		int FindClusters(int nhits_causally_related, vector<HitInfo>& hitinfo, vector<vector<int>>& all_clusters);
+		int FindClustersParallel(int nhits_causally_related, vector<HitInfo>& hitinfo, vector<vector<int>>& all_clusters);
 
 		// Subsidiary functions called by the the principal functions
 		// to check that two hits are related.
 		// CheckCoincidence: check that two hits are not isolated from eachother
 		// DeltaDistance2: calculate dt between hit pmts for use in CheckCausal
 		// CheckCausal: check that two hits could have the same physical origin
-		int CheckCoincidence(int i, int j, vector<HitInfo> hitinfo,float dTmax, float dRmax);
-		float DeltaDistance2(int i, int j, vector<HitInfo> hitinfo);
-		int CheckCausal(int i, int j, vector<HitInfo> hitinfo,float traverseTmax);	
+		int CheckCoincidence(int i, int j, vector<HitInfo>& hitinfo,float dTmax, float dRmax);
+		float DeltaDistance2(int i, int j, vector<HitInfo>& hitinfo);
+		int CheckCausal(int i, int j, vector<HitInfo>& hitinfo,float traverseTmax);	
 		int FindClusterCandidate(int nhits_causally_related, int i, int j, vector<HitInfo>& hitinfo, vector<int>& cluster);
+		int BuildCluster(int nhits_causally_related, int seed1, int seed2, vector<HitInfo>& hitinfo, vector<int>& cluster, vector<int>& nrel_cluster);
+		void RemoveFromCluster(int nhits_causally_related, int hit, vector<HitInfo>& hitinfo, vector<int>& cluster, vector<int>& nrel_cluster);
+		void KeepHits(vector<int>& kept_hits, vector<HitInfo>& hitinfo);
 
 		// Post-selection hit pmts, times and charges, number of hits 
 		// for use in generating starting points
@@ -76,6 +96,10 @@ class HitSelect
 		float traverseTmax;
 		float dTmax;
 		float dRmax;
+		Deadline deadline;
+		int truncated = 0;
+		TaskScheduler* scheduler = nullptr;
+		int worker = 0;
 
 		
 };
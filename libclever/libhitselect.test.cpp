@@ -7,6 +7,8 @@
 #include <libconstants.hpp>
 #include <libhitselect.test.hpp>
 #include <libhitinfo.hpp>
+#include <libtaskscheduler.hpp>
+#include <libeventloop.hpp>
 #include <gtest/gtest.h>
 #include <math.h>
 #include <vector>
@@ -203,6 +205,150 @@ TEST(HitSelectTest,TestFindHitClusters){
 	EXPECT_EQ(time_ordered,time_check);
 }
 
+TEST(HitSelectTest,TestFindHitClustersNone){
+
+	// No two hits are related, so no cluster can be seeded.
+	HitSelect clus3;
+	int nhits = 5;
+	vector<int> is_rel(nhits);
+	vector<HitInfo> hitinfo;
+	for (int i = 0; i<nhits; i++)
+	{
+		hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1+i,1,1,1,1));
+	}
+
+	int nsel = clus3.FindHitClusters(nhits,hitinfo);
+	EXPECT_EQ(nsel,-1);
+	EXPECT_EQ((int)hitinfo.size(),nhits);
+}
+
+TEST(HitSelectTest,TestCheckCoincidenceIsolated){
+
+	// Hits further apart than dTmax in time or dRmax in space are isolated.
+	HitSelect checkcoincidence;
+	float dimension = 2*16; 
+	float dTmax = libConstants::sTimeLimitPMT*dimension/libConstants::sCmPerNs;
+	float dRmax = libConstants::sDistanceLimitPMT*dimension;
+	vector<int> is_rel(3);
+	vector<HitInfo> hitinfo;
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1,1,1,1,1));
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1+2*dTmax,1,1,1,1));
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1,1,1+2*dRmax,1,1));
+
+	EXPECT_EQ(checkcoincidence.CheckCoincidence(0,1,hitinfo,dTmax,dRmax),0);
+	EXPECT_EQ(checkcoincidence.CheckCoincidence(0,2,hitinfo,dTmax,dRmax),0);
+}
+
+TEST(HitSelectTest,TestCheckCausalLimits){
+
+	// Light must be able to travel between the PMTs in the time between
+	// the hits, which must also be within the coincidence window.
+	HitSelect checkcausal;
+	float traverseTmax = 2*sqrt(8*8+8*8)/libConstants::sCmPerNs;
+	vector<int> is_rel(4);
+	vector<HitInfo> hitinfo;
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1,1,1,1,1));
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1.5,1,101,1,1));
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,1.5,1,1,1,1));
+	hitinfo.push_back(HitInfo(0,0,0,0,is_rel,3,1,1001,1,1));
+
+	EXPECT_EQ(checkcausal.CheckCausal(0,1,hitinfo,traverseTmax),1);
+	EXPECT_EQ(checkcausal.CheckCausal(0,2,hitinfo,traverseTmax),0);
+	EXPECT_EQ(checkcausal.CheckCausal(0,3,hitinfo,traverseTmax),0);
+}
+
+// Hits at the same place and time whose relations are given by the rows 
+// of related.
+vector<HitInfo> RelatedHits(vector<vector<int>> related)
+{
+	vector<HitInfo> hitinfo;
+	for (int i = 0; i<(int)related.size(); i++)
+	{
+		int nrel = count(related[i].begin(),related[i].end(),1);
+		hitinfo.push_back(HitInfo(nrel,0,0,0,related[i],1,1+i,1,1,1));
+	}
+	return(hitinfo);
+}
+
+TEST(HitSelectTest,TestBuildCluster){
+
+	// Hits 2 and 3 are not related. Hit 3 has fewer relations in the
+	// cluster, so only it is removed and the tallies of its relations drop.
+	// Hit 5 is then related to every hit left, so it is kept.
+	HitSelect clus;
+	vector<HitInfo> hitinfo = RelatedHits({
+		{0,1,1,1,1,1},
+		{1,0,1,1,1,1},
+		{1,1,0,0,1,1},
+		{1,1,0,0,1,0},
+		{1,1,1,1,0,1},
+		{1,1,1,0,1,0}});
+	vector<int> cluster(6), nrel_cluster(6);
+
+	int size = clus.BuildCluster(6,0,1,hitinfo,cluster,nrel_cluster);
+	EXPECT_EQ(size,5);
+	vector<int> cluster_check = {1,1,1,0,1,1};
+	EXPECT_EQ(cluster,cluster_check);
+	EXPECT_EQ(nrel_cluster[0],4);
+	EXPECT_EQ(nrel_cluster[4],4);
+
+	// With equal tallies both hits of an unrelated pair are removed.
+	hitinfo = RelatedHits({
+		{0,1,1,1,1},
+		{1,0,1,1,1},
+		{1,1,0,0,1},
+		{1,1,0,0,1},
+		{1,1,1,1,0}});
+	cluster.assign(5,0);
+	nrel_cluster.assign(5,0);
+	size = clus.BuildCluster(5,0,1,hitinfo,cluster,nrel_cluster);
+	EXPECT_EQ(size,3);
+	cluster_check = {1,1,0,0,1};
+	EXPECT_EQ(cluster,cluster_check);
+}
+
+TEST(HitSelectTest,TestRemoveFromCluster){
+
+	HitSelect clus;
+	vector<HitInfo> hitinfo = RelatedHits({
+		{0,1,1,0},
+		{1,0,1,1},
+		{1,1,0,0},
+		{0,1,0,0}});
+	vector<int> cluster = {1,1,1,0};
+	vector<int> nrel_cluster = {2,2,2,0};
+
+	clus.RemoveFromCluster(4,2,hitinfo,cluster,nrel_cluster);
+	vector<int> cluster_check = {1,1,0,0};
+	vector<int> nrel_check = {1,1,2,0};
+	EXPECT_EQ(cluster,cluster_check);
+	EXPECT_EQ(nrel_cluster,nrel_check);
+}
+
+TEST(HitSelectTest,TestKeepHits){
+
+	// The kept hits are reordered and is_related follows the new order.
+	HitSelect keep;
+	vector<HitInfo> hitinfo = RelatedHits({
+		{0,1,0,1},
+		{1,0,1,0},
+		{0,1,0,0},
+		{1,0,0,0}});
+	vector<int> kept_hits = {3,1,0};
+
+	keep.KeepHits(kept_hits,hitinfo);
+	ASSERT_EQ((int)hitinfo.size(),3);
+	EXPECT_EQ(hitinfo[0].charge,4);
+	EXPECT_EQ(hitinfo[1].charge,2);
+	EXPECT_EQ(hitinfo[2].charge,1);
+	vector<int> related0 = {0,0,1};
+	vector<int> related1 = {0,0,1};
+	vector<int> related2 = {1,1,0};
+	EXPECT_EQ(hitinfo[0].is_related,related0);
+	EXPECT_EQ(hitinfo[1].is_related,related1);
+	EXPECT_EQ(hitinfo[2].is_related,related2);
+}
+
 TEST(HitSelectTest,TestSelectHits){
 	
 	HitSelect select;
@@ -232,4 +378,52 @@ TEST(HitSelectTest,TestSelectHits){
 }
 
 
+TEST(HitSelectTest,TestSelectHitsParallel){
+
+	// A large event (over sParallelMinimumHits hits) selects the same hits
+	// when the cluster seeds are shared between workers.
+	float dimension = 2*16; 
+	float dTmax = libConstants::sTimeLimitPMT*dimension/libConstants::sCmPerNs;
+	float dRmax = libConstants::sDistanceLimitPMT*dimension;
+	float traverseTmax = 2*sqrt(8*8+8*8)/libConstants::sCmPerNs;
+	int nhits = 250;
+	vector<float> times, charges, pmtx, pmty, pmtz;
+	for (int i = 0; i<nhits; i++)
+	{
+		pmtx.push_back(1+2*(i%5));
+		pmty.push_back(1+2*((i/5)%5));
+		pmtz.push_back(1+2*((i/25)%10));
+		times.push_back(1+0.02*i);
+		charges.push_back(1+(i*7)%11);
+	}
+
+	HitSelect serial;
+	vector<HitInfo> hitinfo_serial;
+	int nsel_serial = serial.SelectHits(nhits,times,charges,pmtx,pmty,pmtz,hitinfo_serial,traverseTmax,dTmax,dRmax);
+
+	EventLoop loop(4);
+	TaskScheduler scheduler(loop.NThreads());
+	vector<HitInfo> hitinfo_parallel;
+	int nsel_parallel = 0;
+	loop.RunWorkers([&] (int thread)
+	{
+		if (thread == 0)
+		{
+			HitSelect parallel;
+			parallel.SetScheduler(&scheduler,thread);
+			nsel_parallel = parallel.SelectHits(nhits,times,charges,pmtx,pmty,pmtz,hitinfo_parallel,traverseTmax,dTmax,dRmax);
+		}
+		scheduler.Retire(thread);
+	});
+
+	EXPECT_GE(nsel_serial,libConstants::sSelectedHitThreshold);
+	ASSERT_EQ(nsel_parallel,nsel_serial);
+	for (int i = 0; i<nsel_serial; i++)
+	{
+		EXPECT_EQ(hitinfo_parallel[i].time,hitinfo_serial[i].time);
+		EXPECT_EQ(hitinfo_parallel[i].charge,hitinfo_serial[i].charge);
+		EXPECT_EQ(hitinfo_parallel[i].nselected,hitinfo_serial[i].nselected);
+	}
+}
+
 }
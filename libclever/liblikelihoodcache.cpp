@@ -0,0 +1,74 @@
+/**************************************************
+ * Caches the likelihood of test points which have
+ * already been evaluated in this event.
+ * Inputs: test point positions, likelihood and t0
+ * Outputs: stored likelihood and t0 for revisited
+ * 			positions, hit and miss counters
+ *
+ * *************************************************/
+#include <iostream>
+#include <math.h>
+
+#include <libconstants.hpp>
+#include <liblikelihoodcache.hpp>
+
+//constructor function
+LikelihoodCache::LikelihoodCache()
+{
+	mResolution = 0;
+	mInverseResolution = 0;
+	Clear();
+}
+
+//destructor function
+LikelihoodCache::~LikelihoodCache()
+{
+}
+
+void LikelihoodCache::Clear()
+{
+	mValueMap.clear();
+	mNHits = 0;
+	mNMisses = 0;
+}
+
+void LikelihoodCache::SetResolution(float resolution)
+{
+	if (resolution != mResolution)
+	{
+		mValueMap.clear();
+		mResolution = resolution;
+		mInverseResolution = (resolution > 0) ? 1./resolution : 0;
+	}
+}
+
+bool LikelihoodCache::Find(float x, float y, float z, float& nll, float& t0)
+{
+	auto found = mValueMap.find(Key(x,y,z));
+	if (found == mValueMap.end())
+	{
+		mNMisses++;
+		return(false);
+	}
+	mNHits++;
+	nll = found->second.first;
+	t0 = found->second.second;
+	return(true);
+}
+
+void LikelihoodCache::Insert(float x, float y, float z, float nll, float t0)
+{
+	mValueMap[Key(x,y,z)] = make_pair(nll,t0);
+}
+
+uint64_t LikelihoodCache::Key(float x, float y, float z)
+{
+	// Round to the nearest grid point and offset so that each co-ordinate
+	// is a positive 21-bit integer.
+	const int64_t offset = 1 << 20;
+	const uint64_t mask = (1 << 21) - 1;
+	uint64_t ix = (uint64_t)(lround(x*mInverseResolution) + offset) & mask;
+	uint64_t iy = (uint64_t)(lround(y*mInverseResolution) + offset) & mask;
+	uint64_t iz = (uint64_t)(lround(z*mInverseResolution) + offset) & mask;
+	return((ix << 42) | (iy << 21) | iz);
+}
@@ -0,0 +1,78 @@
+#ifndef LIBLIKELIHOODCACHE_H
+#define LIBLIKELIHOODCACHE_H
+
+//includes
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+using namespace std;
+
+/*
+ * class LikelihoodCache
+ * Per-event store of the negative log likelihood and t0 already found for
+ * test points, keyed by the position quantised to a grid of the given
+ * resolution. The dodecahedron shells of neighbouring survivors overlap, so
+ * many new test points land within a few cm of points already evaluated;
+ * these take the stored values instead of being recalculated.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class LikelihoodCache
+{
+
+
+	// define the public functions and variables
+	public:
+
+		LikelihoodCache();
+		~LikelihoodCache();
+
+		// Forget all stored points and reset the counters (once per event).
+		void Clear();
+
+		// Set the grid cell size in cm. Points stored with a different 
+		// resolution are forgotten, as their keys no longer match.
+		void SetResolution(float resolution);
+
+		// Look up the point {x, y, z}. Returns true and fills nll and t0
+		// if a point in the same grid cell has already been evaluated.
+		bool Find(float x, float y, float z, float& nll, float& t0);
+
+		// Store the values found for the point {x, y, z}.
+		void Insert(float x, float y, float z, float nll, float t0);
+
+		inline int NHits(void){
+			return(mNHits);
+		}
+
+		inline int NMisses(void){
+			return(mNMisses);
+		}
+
+		// Fraction of lookups answered from the cache.
+		inline float HitRate(void){
+			int nLookups = mNHits + mNMisses;
+			return(nLookups > 0 ? (float)mNHits/nLookups : 0);
+		}
+
+	// define the private functions and variables
+	private:
+
+		// Pack the quantised co-ordinates into a single key
+		// (21 bits each, i.e. +/- 10 km at 1 cm resolution).
+		uint64_t Key(float x, float y, float z);
+
+		float mResolution;
+		float mInverseResolution;
+		int mNHits;
+		int mNMisses;
+		unordered_map<uint64_t, pair<float,float>> mValueMap; // {nll, t0}
+
+};
+
+#endif
@@ -0,0 +1,54 @@
+/**************************************************
+ * Unit tests for LikelihoodCache class
+ *
+ * *************************************************/
+
+#include <liblikelihoodcache.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace{
+
+TEST(LikelihoodCacheTest,TestFindInsert){
+
+	LikelihoodCache cache;
+	cache.SetResolution(2.0);
+	float nll = 0, t0 = 0;
+
+	EXPECT_FALSE(cache.Find(10,-20,30,nll,t0));
+	cache.Insert(10,-20,30,12.5,3.0);
+
+	// A point within the same 2 cm cell takes the stored values.
+	EXPECT_TRUE(cache.Find(10.4,-20.6,29.7,nll,t0));
+	EXPECT_FLOAT_EQ(nll,12.5);
+	EXPECT_FLOAT_EQ(t0,3.0);
+
+	// A point in a neighbouring cell does not.
+	EXPECT_FALSE(cache.Find(13,-20,30,nll,t0));
+
+	EXPECT_EQ(cache.NHits(),1);
+	EXPECT_EQ(cache.NMisses(),2);
+	EXPECT_NEAR(cache.HitRate(),1./3,1e-6);
+
+}
+
+TEST(LikelihoodCacheTest,TestClear){
+
+	LikelihoodCache cache;
+	cache.SetResolution(1.0);
+	float nll = 0, t0 = 0;
+	cache.Insert(-100,0,5,1,1);
+
+	// Changing the resolution forgets the stored points.
+	cache.SetResolution(2.0);
+	EXPECT_FALSE(cache.Find(-100,0,5,nll,t0));
+
+	cache.Insert(-100,0,5,1,1);
+	cache.Clear();
+	EXPECT_FALSE(cache.Find(-100,0,5,nll,t0));
+	EXPECT_EQ(cache.NHits(),0);
+	EXPECT_EQ(cache.NMisses(),1);
+
+}
+
+}
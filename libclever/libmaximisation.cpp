@@ -5,191 +5,944 @@
  * ***************************************************/
 #include <iostream>
 #include <math.h>
-#include <limits.h>
+#include <limits>
+#include <algorithm>
+#include <numeric> //iota(), accumulate()
 
 #include <libconstants.hpp>
 #include <libhitinfo.hpp>
 #include <libmaximisation.hpp>
+#include <libpdf.hpp>
+#include <libtzero.hpp>
+#include <libshells.hpp>
+#include <liblikelihoodcache.hpp>
 
-#include <TH1F.h>
-#include <TF1.h>
 
 //Maximise constructor
 Maximisation::Maximisation()
 {
-	Maximise(hitInfoVector,testPointsVector);
+	SetTZeroMethod(libConstants::sTZeroMethod);
+	SetLikelihoodOptions(libConstants::sUseCharge, libConstants::sUseAngle, libConstants::sInterpolatePDF);
 }
 
 Maximisation::~Maximisation()
 {
-	Maximise()
 }
 
 
+void Maximisation::SetTimeResidualPDF(TimeResidualPDF& timeResidualPDF)
+{
+	// The pdf used in the likelihood is the signal pdf until a dark noise
+	// level is set for an event.
+	mSignalPDF = timeResidualPDF;
+	mTimeResidualPDF = timeResidualPDF;
+	mNoiseStep = 0;
+	mNoisyPDFVector.clear();
+	mNoisyPDFReady.clear();
+}
+
+void Maximisation::SetNoiseRate(float noiseRate)
+{
+	mNoiseRate = noiseRate;
+}
+
+float Maximisation::NoiseRateFromHits(vector<float>& timesAll, float signalStart, float signalEnd)
+{
+	// The hits outside the time window which can hold light from the event
+	// are taken to be dark noise, spread evenly over the rest of the event
+	// time window. (Hits inside it which did not make the cluster selection
+	// may still be signal, so are not counted.)
+	int nAll = timesAll.size();
+	if (nAll < 2)
+	{
+		return(0);
+	}
+	auto minmax = minmax_element(timesAll.begin(), timesAll.end());
+	float timeWindow = *minmax.second - *minmax.first;
+	float signalWindow = min(signalEnd, *minmax.second) - max(signalStart, *minmax.first);
+	float noiseWindow = timeWindow - max(signalWindow, 0.f);
+	if (noiseWindow <= 0)
+	{
+		return(0);
+	}
+	int nNoise = count_if(timesAll.begin(), timesAll.end(), [signalStart, signalEnd] (float time)
+	{
+		return(time < signalStart || time > signalEnd);
+	});
+	return(nNoise/noiseWindow);
+}
+
+float Maximisation::NoiseRateFromPMTs(vector<float>& darkRateVector)
+{
+	// Sum of the dark rates (Hz) of the PMTs in the detector in hits per ns.
+	float noiseRate = accumulate(darkRateVector.begin(), darkRateVector.end(), 0.0);
+	return(noiseRate*1e-9);
+}
+
+void Maximisation::SetNoisePDF()
+{
+	// Build the time-residual pdf for this event's dark noise level once,
+	// so that the noise costs nothing per test point. The expected number
+	// of noise hits within the pdf time range gives the noise fraction of 
+	// the hits. The fraction is rounded to a step of the tolerance and the
+	// table for each step is built once, so that an event gets the same
+	// table whichever events were fitted before it.
+	// The joint time-charge pdf is left as it is: a noise floor for it
+	// would need the charge spectrum of noise hits. With charge, the noise
+	// therefore only enters through the time pdf used by the refinement
+	// and the direction fit, not through the likelihood of test points.
+	if (!libConstants::sUseDarkNoise)
+	{
+		return;
+	}
+	float timeRange = mSignalPDF.MaximumResidual() - mSignalPDF.MinimumResidual();
+	float noiseFraction = (mNHits > 0) ? mNoiseRate*timeRange/mNHits : 0;
+	noiseFraction = min(noiseFraction, libConstants::sMaximumNoiseFraction);
+	int noiseStep = lround(noiseFraction/libConstants::sNoiseFractionTolerance);
+	if (noiseStep == mNoiseStep)
+	{
+		return;
+	}
+	if (noiseStep >= (int)mNoisyPDFVector.size())
+	{
+		mNoisyPDFVector.resize(noiseStep+1);
+		mNoisyPDFReady.resize(noiseStep+1, false);
+	}
+	if (noiseStep > 0 && !mNoisyPDFReady[noiseStep])
+	{
+		mNoisyPDFVector[noiseStep].SetNoisyPDF(mSignalPDF, noiseStep*libConstants::sNoiseFractionTolerance);
+		mNoisyPDFReady[noiseStep] = true;
+	}
+	mTimeResidualPDF = (noiseStep > 0) ? mNoisyPDFVector[noiseStep] : mSignalPDF;
+	mNoiseStep = noiseStep;
+}
+
+void Maximisation::SetTimeChargePDF(TimeChargePDF& timeChargePDF)
+{
+	mTimeChargePDF = timeChargePDF;
+}
+
+void Maximisation::SetDeadline(Deadline& deadline)
+{
+	mDeadline = deadline;
+}
+
+void Maximisation::SetAttenuationLength(float attenuationLength)
+{
+	mInverseAttenuationLength = (attenuationLength > 0) ? 1/attenuationLength : 0;
+}
+
+void Maximisation::SetTZeroMethod(int method)
+{
+	// Select the strategy used to find t0 for each test point.
+	mWorkspace.tZeroEstimator = TZeroEstimator::Create(method);
+	mTZeroMethod = method;
+}
+
 //*****************************************************************************
 // This is the main Maximisation function which performs successive searches to
 // find the testpoint with the best likelihood.
 
-void Maximisation::Maximise(vector <HitInfo> hitInfoVector, vector<vector<float>> testPointsVector)
+void Maximisation::Maximise(vector <HitInfo>& hitInfoVector, float rmax2, float zmax, vector<vector<float>>& testPointsVector)
 {
+	// Forget any t0 state kept from the previous event and copy the hit
+	// information and initial test points into the per-event workspace.
+	mWorkspace.tZeroEstimator->Reset();
+	mLikelihoodCache.Clear();
+	mFitResult = FitResult();
+	mZMax = zmax;
+	SetHits(hitInfoVector);
+	SetNoisePDF();
+	SetTestPoints(testPointsVector);
+
 	// Calculate likelihood for initial testpoints.
-	FindNegativeLogLikelihoods(hitInfoVector,testPointsVector,0);
+	// Positions are cached on a grid tied to the radius of the next shells,
+	// so that overlapping shells reuse the likelihoods already found.
+	mLikelihoodCache.SetResolution(libConstants::sCacheResolutionFraction*libConstants::sCoarseRmax);
+	FindNegativeLogLikelihoods(0);
 
 	// Skim off the points with the best NLL values, remove the remainder
-	Skim( libConstants::sCoarseDlike, libConstants::sCoarseSkimFraction, testPointsVector);
-
-	// Get additional points for coarse search
-	int nPreviousTestPoints = AddPoints(libConstants::sCoarseRadius,testPointsVector)
+	Skim( libConstants::sCoarseDlike, libConstants::sCoarseSkimFraction);
 
-	// Calculate the negative log likelihoods for the new testpoints
-	// in the coarse search
-	FindNegativeLogLikelihoods(hitInfoVector,testPointsVector,nPreviousTestPoints-1);
+	// Merge survivors which would place overlapping shells, so that each
+	// search explores distinct minima.
+	MergeBasins(libConstants::sCoarseRmax);
+	bool converged = HasConverged(FitResult::sInitialStage);
 
-	// Calculate likelihood for fine search.
-	Search(hitInfoVector,libConstants::sFineRmin,libConstants::sFineRmax,libConstants::sFineDlike,libConstants::sFineSkimFraction,testPointsVector;
+	// Coarse and fine searches: place shells around the survivors, skim 
+	// again and stop early once the best vertex no longer moves.
+	// If the deadline has passed, the remaining stages are skipped and the
+	// best vertex so far is returned, flagged as truncated.
+	if (!converged && !CheckDeadline())
+	{
+		SearchShells(FitResult::sCoarseStage, libConstants::sCoarseRmax, libConstants::sFineDlike, libConstants::sFineSkimFraction, libConstants::sFineRmax);
+		converged = HasConverged(FitResult::sCoarseStage);
+	}
+	if (!converged && !CheckDeadline())
+	{
+		SearchShells(FitResult::sFineStage, libConstants::sFineRmax, libConstants::sFinalDlike, libConstants::sFinalSkimFraction, libConstants::sFinalMaxStep);
+		converged = HasConverged(FitResult::sFineStage);
+	}
 
 	// Perform final search and get best fit vertex.
-	// Final search can be final step in annealing algorithm or alternatively 
-	// Minuit search. Simulated annealing followed by Minuit search will give
-	// the most precise results (Minuit) while avoiding local minima and 
-	// retaining speed (simulated annealing).
-	FinalSearch(hitInfoVector,libConstants::sFinalRmin,libConstants::sFinalRmax,sFinalDlike,libConstants::sFinalSkimFraction,testPointsVector);
+	// The final search refines the best survivors with a local gradient-based
+	// (L-BFGS) minimisation, which gives the precision of a Minuit search
+	// without the ROOT dependency, while the preceding shells avoid local 
+	// minima. It is cheap, so it is done even when the shells converged.
+	if (!CheckDeadline())
+	{
+		FinalSearch(rmax2,zmax);
+		if (!converged)
+		{
+			HasConverged(FitResult::sFinalStage);
+		}
+	}
 
-	// TODO calculate goodness (fit quality)
-	// TODO get result: get emission time, gdn0, theta, phi, cosc
+	// Store the best fit vertex in the result. The energy, goodness and 
+	// direction are normally found during the final search; if that was 
+	// skipped by the deadline they take one pass at the best vertex.
+	if (NTestPoints() > 0 && mFitResult.nWindowHits < 0)
+	{
+		vector<float> bestVertex(mTestPoints.begin(), mTestPoints.begin()+sTestPointSize);
+		EvaluateFinalVertex(bestVertex);
+		SetFinalPassResult(mFinalPassResult);
+	}
+	if (NTestPoints() > 0)
+	{
+		mFitResult.x = mTestPoints[0];
+		mFitResult.y = mTestPoints[1];
+		mFitResult.z = mTestPoints[2];
+		mFitResult.t0 = mTestPoints[sTZeroIndex];
+		mFitResult.nll = mTestPoints[sNLLIndex];
+	}
+
+	// Return the final test points {x, y, z, t0, NLL}, best first.
+	GetTestPoints(testPointsVector);
 
 }
 
 //*****************************************************************************
 // These are the principal functions called by Maximise.
 
-void Maximisation::FindNegativeLogLikelihoods(vector<HitInfo> hitInfoVector, vector<vector<float>>& testPointsVector, int start)
+void Maximisation::SetTestPoints(vector<vector<float>>& testPointsVector)
+{
+	// Copies the initial test points ({x, y, z} or {x, y, z, t0}) into the
+	// flat test point buffer, in which every point is {x, y, z, t0, NLL}.
+	int nTestPoints = testPointsVector.size();
+	mTestPoints.assign(nTestPoints*sTestPointSize, 0);
+	for (int iTestPoint = 0; iTestPoint < nTestPoints; iTestPoint++)
+	{
+		int nValues = min((int)testPointsVector[iTestPoint].size(), sTestPointSize);
+		copy(testPointsVector[iTestPoint].begin(), testPointsVector[iTestPoint].begin()+nValues, mTestPoints.begin()+iTestPoint*sTestPointSize);
+	}
+}
+
+void Maximisation::GetTestPoints(vector<vector<float>>& testPointsVector)
+{
+	int nTestPoints = NTestPoints();
+	testPointsVector.resize(nTestPoints);
+	for (int iTestPoint = 0; iTestPoint < nTestPoints; iTestPoint++)
+	{
+		auto first = mTestPoints.begin()+iTestPoint*sTestPointSize;
+		testPointsVector[iTestPoint].assign(first, first+sTestPointSize);
+	}
+}
+
+void Maximisation::FindNegativeLogLikelihoods(int start, float cutoff)
 {
 	// Iterates over all of the test points for which negative log likelihood
-	// still needs to be calculated and then sorts the test point vector
-	// into order of increasing negative log likelihood.
+	// still needs to be calculated. The test points are not sorted here:
+	// Skim only needs the best few, so it does a partial selection instead.
+	// The best and worst values needed for the dLike test in Skim are
+	// tracked in the same pass.
 	
-	int nTestPoints = testPointsVector.size();
-	vector<vector<float>> hitDirectionVector(nTestPoints-start,vector<float>(3));
-	// Likelihoods are added to the test points vector. This makes it 
+	int nTestPoints = NTestPoints();
+
+	// Points before start survived the previous Skim, which left them sorted
+	// with the best first and the worst last.
+	if (start > 0)
+	{
+		mBestNLL = mTestPoints[sNLLIndex];
+		mWorstNLL = mTestPoints[(start-1)*sTestPointSize+sNLLIndex];
+	}
+	else
+	{
+		mBestNLL = numeric_limits<float>::max();
+		mWorstNLL = numeric_limits<float>::lowest();
+	}
+
+	// Likelihoods are added to the test points buffer. This makes it 
 	// easier to skim off test points corresponding to the best (smallest) 
 	// negative log likelihoods and remove the remainder (Skim function).
+	// Points whose likelihood exceeds the cut-off are rejected: they are 
+	// removed from the buffer straight away by moving the next points down.
+	mVertexVector.resize(sTestPointSize);
+	bool useCache = libConstants::sUseLikelihoodCache;
+	// Large events share the likelihoods with idle workers in tiles.
+	bool useTiles = (mScheduler != nullptr && mNHits >= libConstants::sParallelMinimumHits && nTestPoints-start >= 2*libConstants::sLikelihoodTileSize);
+	if (useTiles)
+	{
+		FindNegativeLogLikelihoodTiles(start, cutoff);
+	}
+	int nKept = start;
 	for (int iTestPoint = start; iTestPoint<nTestPoints; iTestPoint++)
 	{
-		// Calculate the likelihood for each point and add it to the vector
-		vector<float> testPointVtxVector = testPointsVector[iTestPoint];
-		testPointsVector[iTestPoint].push_back(FindTestPointLikelihood(hitInfoVector,testPointVtxVector));
+		// Once the deadline has passed the remaining points are dropped,
+		// keeping at least one point. The clock is only read once every
+		// sDeadlineCheckInterval points.
+		if (!useTiles && nKept > 0 && (iTestPoint-start) % libConstants::sDeadlineCheckInterval == 0 && CheckDeadline())
+		{
+			break;
+		}
+
+		// Calculate the likelihood for each point and add it to the buffer
+		// Points which fall in the same cache cell as a point already
+		// evaluated in this event take its likelihood and t0.
+		auto first = mTestPoints.begin()+iTestPoint*sTestPointSize;
+		float nll;
+		float t0;
+		if (useTiles)
+		{
+			// Tiles which started after the deadline were not evaluated.
+			int state = mTileState[iTestPoint-start];
+			if (state == 0)
+			{
+				mFitResult.truncated = 1;
+				continue;
+			}
+			// As in the serial loop, a point in the cell of a point earlier 
+			// in this pass takes its likelihood and t0.
+			if (state == 1 || !useCache || !mLikelihoodCache.Find(first[0], first[1], first[2], nll, t0))
+			{
+				nll = mTileNLL[iTestPoint-start];
+				t0 = mTileTZero[iTestPoint-start];
+				if (useCache && state == 2)
+				{
+					mLikelihoodCache.Insert(first[0], first[1], first[2], nll, t0);
+				}
+			}
+		}
+		else if (!useCache || !mLikelihoodCache.Find(first[0], first[1], first[2], nll, t0))
+		{
+			copy(first, first+sTestPointSize, mVertexVector.begin());
+			nll = FindTestPointLikelihood(mVertexVector, true, cutoff);
+			t0 = mVertexVector[sTZeroIndex];
+			if (useCache)
+			{
+				mLikelihoodCache.Insert(first[0], first[1], first[2], nll, t0);
+			}
+		}
+		if (nll > cutoff)
+		{
+			continue;
+		}
+		first[sTZeroIndex] = t0;
+		first[sNLLIndex] = nll;
+		if (nKept < iTestPoint)
+		{
+			copy(first, first+sTestPointSize, mTestPoints.begin()+nKept*sTestPointSize);
+		}
+		nKept++;
+
+		if (nll < mBestNLL)
+		{
+			mBestNLL = nll;
+		}
+		if (nll > mWorstNLL)
+		{
+			mWorstNLL = nll;
+		}
+	}
+	mTestPoints.resize(nKept*sTestPointSize);
+}
+
+void Maximisation::FindNegativeLogLikelihoodTiles(int start, float cutoff)
+{
+	// Finds the likelihood of the test points from start onwards for 
+	// FindNegativeLogLikelihoods. Points in the cache take the stored
+	// values; the rest are split into tiles evaluated by whichever worker
+	// runs them, reading this event's hits and pdfs. Tiles (except the first) which start after
+	// the deadline are left unevaluated. Points which share a cache cell
+	// within the pass are each evaluated, and sorted out by the caller.
+	int nPoints = NTestPoints() - start;
+	mTileNLL.resize(nPoints);
+	mTileTZero.resize(nPoints);
+	mTileState.assign(nPoints, 0);
+	mTilePending.clear();
+	bool useCache = libConstants::sUseLikelihoodCache;
+	for (int iPoint = 0; iPoint < nPoints; iPoint++)
+	{
+		auto first = mTestPoints.begin()+(start+iPoint)*sTestPointSize;
+		if (useCache && mLikelihoodCache.Find(first[0], first[1], first[2], mTileNLL[iPoint], mTileTZero[iPoint]))
+		{
+			mTileState[iPoint] = 1;
+			continue;
+		}
+		mTilePending.push_back(iPoint);
 	}
-	
-	// Sort the testPointsVector as a function of the negative log likelihood
-	// values, best (lowest) value first.
-	sort(testPointsVector.begin(),
-          testPointsVector.end(),
-          [] (const vector<double> &testPoint1, const vector<double> &testPoint2)
-          {
-              return testPoint1[4] < testPoint2[4];
-          });
+
+	int tileSize = libConstants::sLikelihoodTileSize;
+	mScheduler->ParallelFor(mWorker, mTilePending.size(), tileSize, [&] (int, int first, int last)
+	{
+		if (first > 0 && mDeadline.HasExpired())
+		{
+			return;
+		}
+		// Each tile has its own scratch buffers and starts the t0 search
+		// afresh, so that the result does not depend on which worker ran
+		// which tile before.
+		LikelihoodWorkspace workspace;
+		workspace.tZeroEstimator = TZeroEstimator::Create(mTZeroMethod);
+		workspace.Resize(mNHits);
+		vector<float> vertexVector(sTestPointSize);
+		for (int iPending = first; iPending < last; iPending++)
+		{
+			int iPoint = mTilePending[iPending];
+			auto point = mTestPoints.begin()+(start+iPoint)*sTestPointSize;
+			copy(point, point+sTestPointSize, vertexVector.begin());
+			mTileNLL[iPoint] = (this->*mTestPointLikelihood)(workspace, vertexVector, true, cutoff);
+			mTileTZero[iPoint] = vertexVector[sTZeroIndex];
+			mTileState[iPoint] = 2;
+		}
+	});
+}
+
+float Maximisation::RejectionCutoff()
+{
+	// Cut-off for new test points: after a skim the survivors are sorted,
+	// so the last one is the worst point kept.
+	int nTestPoints = NTestPoints();
+	if (!libConstants::sUseBoundedNLL || nTestPoints == 0)
+	{
+		return(numeric_limits<float>::max());
+	}
+	return(mTestPoints[(nTestPoints-1)*sTestPointSize+sNLLIndex] + libConstants::sBoundedNLLMargin);
 }
 
-void Maximisation::Skim(float dLike, float skimFraction, vector<vector<float>> testPointsVector)
+void Maximisation::Skim(float dLike, float skimFraction)
 {
-	// Find the best (lowest) and worst (highest) NLL values
-	float best = testPointsVector.begin(); // lowest NLL
-	float worst = testPointVectors.end(); // highest NLL
+	// Keeps the test points with the best (lowest) NLL values and leaves 
+	// them sorted, best first. The selection is done on an index list and
+	// the kept points are then gathered into the second buffer.
+	int nTestPoints = NTestPoints();
+	mOrderVector.resize(nTestPoints);
+	iota(mOrderVector.begin(), mOrderVector.end(), 0);
+	auto compareNLL = [this] (int iTestPoint1, int iTestPoint2)
+	{
+		return mTestPoints[iTestPoint1*sTestPointSize+sNLLIndex] < mTestPoints[iTestPoint2*sTestPointSize+sNLLIndex];
+	};
 
 	// If the difference between best and worst fit > dlike, keep active only
-	// skimFraction of the branches.
-	if (fabs(worst - best) > dLike)
+	// skimFraction of the branches. Only the kept points need to be in order,
+	// so partition around the cut with nth_element and sort the kept prefix.
+	int skimNumber = (int)(skimFraction*nTestPoints);
+	if (fabs(mWorstNLL - mBestNLL) > dLike && skimNumber < nTestPoints)
+	{
+		if (skimNumber < 1)
+		{
+			skimNumber = 1;
+		}
+		nth_element(mOrderVector.begin(),
+				mOrderVector.begin()+skimNumber-1,
+				mOrderVector.end(),
+				compareNLL);
+		mOrderVector.resize(skimNumber);
+	}
+
+	sort(mOrderVector.begin(), mOrderVector.end(), compareNLL);
+
+	int nKept = mOrderVector.size();
+	mSkimmedTestPoints.resize(nKept*sTestPointSize);
+	for (int iKept = 0; iKept < nKept; iKept++)
+	{
+		auto first = mTestPoints.begin()+mOrderVector[iKept]*sTestPointSize;
+		copy(first, first+sTestPointSize, mSkimmedTestPoints.begin()+iKept*sTestPointSize);
+	}
+	mTestPoints.swap(mSkimmedTestPoints);
+
+	// The survivors now span the best value to the worst kept value.
+	if (nKept > 0)
+	{
+		mBestNLL = mTestPoints[sNLLIndex];
+		mWorstNLL = mTestPoints[(nKept-1)*sTestPointSize+sNLLIndex];
+	}
+}
+
+void Maximisation::SearchShells(int stage, float rmax, float dLike, float skimFraction, float nextRmax)
+{
+	// New points which cannot beat the worst survivor of the last skim are
+	// rejected without summing over all of the hits. The cut-off is taken
+	// before the new points (with no likelihood yet) are added.
+	float cutoff = RejectionCutoff();
+
+	// Get additional points in shells of radius rmax around the survivors.
+	int nPreviousTestPoints = AddPoints(rmax,stage);
+
+	// Calculate the negative log likelihoods for the new testpoints and skim
+	// again.
+	mLikelihoodCache.SetResolution(libConstants::sCacheResolutionFraction*rmax);
+	FindNegativeLogLikelihoods(nPreviousTestPoints, cutoff);
+	Skim(dLike, skimFraction);
+	MergeBasins(nextRmax);
+}
+
+bool Maximisation::CheckDeadline()
+{
+	// Returns true, and flags the fit result as truncated, once the time 
+	// budget for the event has run out.
+	if (mDeadline.HasExpired())
+	{
+		mFitResult.truncated = 1;
+		return(true);
+	}
+	return(false);
+}
+
+bool Maximisation::HasConverged(int stage)
+{
+	// Compares the best test point after this stage with the best after the
+	// previous one. The fit has converged when the NLL has improved by less
+	// than sConvergenceNLL and the vertex has moved less than 
+	// sConvergenceDistance. The stage is recorded in the fit result.
+	mFitResult.stage = stage;
+	if (NTestPoints() == 0)
+	{
+		return(false);
+	}
+	float x = mTestPoints[0];
+	float y = mTestPoints[1];
+	float z = mTestPoints[2];
+	float nll = mTestPoints[sNLLIndex];
+
+	bool converged = false;
+	if (stage > FitResult::sInitialStage && libConstants::sUseConvergence)
+	{
+		float dx = x - mPreviousBestVertex[0];
+		float dy = y - mPreviousBestVertex[1];
+		float dz = z - mPreviousBestVertex[2];
+		float distance2 = dx*dx + dy*dy + dz*dz;
+		float maxDistance = libConstants::sConvergenceDistance;
+		converged = (mPreviousBestVertex[3] - nll < libConstants::sConvergenceNLL && distance2 < maxDistance*maxDistance);
+	}
+	mFitResult.converged = converged;
+
+	mPreviousBestVertex.assign({x, y, z, nll});
+	return(converged);
+}
+
+void Maximisation::MergeBasins(float radius)
+{
+	// Survivors of a skim often crowd around the same minimum. Going 
+	// through them best first, a survivor is kept only if it is further
+	// than the radius of the next search from every survivor kept so far,
+	// i.e. each basin is represented by its best point. At most 
+	// sMaximumBasins are kept. The buffer stays sorted, best first.
+	if (!libConstants::sUseBasinMerging)
+	{
+		return;
+	}
+	int nTestPoints = NTestPoints();
+	float radius2 = radius*radius;
+	int nKept = 0;
+	// With a deadline, fewer basins are kept as the time runs out.
+	int maximumBasins = mDeadline.ScaleBudget(libConstants::sMaximumBasins);
+	for (int iTestPoint = 0; iTestPoint < nTestPoints && nKept < maximumBasins; iTestPoint++)
+	{
+		auto first = mTestPoints.begin()+iTestPoint*sTestPointSize;
+		bool isNewBasin = true;
+		for (int iKept = 0; iKept < nKept; iKept++)
+		{
+			auto kept = mTestPoints.begin()+iKept*sTestPointSize;
+			float dx = first[0]-kept[0];
+			float dy = first[1]-kept[1];
+			float dz = first[2]-kept[2];
+			if (dx*dx + dy*dy + dz*dz < radius2)
+			{
+				isNewBasin = false;
+				break;
+			}
+		}
+		if (isNewBasin)
+		{
+			if (nKept < iTestPoint)
+			{
+				copy(first, first+sTestPointSize, mTestPoints.begin()+nKept*sTestPointSize);
+			}
+			nKept++;
+		}
+	}
+	mTestPoints.resize(nKept*sTestPointSize);
+
+	if (nKept > 0)
 	{
-		int skimNumber = (int)libConstants::sSkimFraction*testPointsVector.size();
-		testPointsVector.erase( skimNumber+1, testPointsVector.end() );
+		mWorstNLL = mTestPoints[(nKept-1)*sTestPointSize+sNLLIndex];
 	}
 }
 
-void Maximisation::AddPoints(float r, vector<vector<float>> testPointsVector)
+int Maximisation::AddPoints(float rmax, int stage)
 {
-	// Get the points in a dodecahedron around the testpoints saved from the
-	// previous search with each vertex at distance rmax from the testpoint
-	// origin
+	// Get the points in a shell (a dodecahedron by default) around the 
+	// testpoints saved from the previous search with each vertex at distance
+	// rmax from the testpoint origin. The new points are written straight 
+	// into the test point buffer from the precomputed unit-shell offsets, 
+	// one fused multiply-add per coordinate, and take the t0 of their origin.
+	SetShell(stage);
+	int nShellPoints = libShells::ShellSize(libConstants::sShellType);
 	
-	// Use each testpoint as the origin for a dodecahedron.
-	int nSavedTestPoints = testPointsVector.size();
+	// Use each testpoint as the origin for a shell.
+	int nSavedTestPoints = NTestPoints();
+	mTestPoints.resize((nSavedTestPoints + nSavedTestPoints*nShellPoints)*sTestPointSize);
+	int iNew = nSavedTestPoints*sTestPointSize;
 	for (int iTestPoint=0; iTestPoint < nSavedTestPoints; iTestPoint++)
 	{
 		// Get the co-ordinates of the 4D testpoint
-		float x = testPointsVector[iTestPoint][0];
-		float y = testPointsVector[iTestPoint][1];
-		float z = testPointsVector[iTestPoint][2];
-		float t0 = testPointsVector[iTestPoint][3];
-		testPointsVector.append(FindDodecahedronVertices(x,y,z,t0,rmax);	
+		float x = mTestPoints[iTestPoint*sTestPointSize];
+		float y = mTestPoints[iTestPoint*sTestPointSize+1];
+		float z = mTestPoints[iTestPoint*sTestPointSize+2];
+		float t0 = mTestPoints[iTestPoint*sTestPointSize+sTZeroIndex];
+		for (int iShell = 0; iShell < nShellPoints; iShell++)
+		{
+			mTestPoints[iNew] = fma(mShellOffsets[3*iShell], rmax, x);
+			mTestPoints[iNew+1] = fma(mShellOffsets[3*iShell+1], rmax, y);
+			mTestPoints[iNew+2] = fma(mShellOffsets[3*iShell+2], rmax, z);
+			mTestPoints[iNew+sTZeroIndex] = t0;
+			mTestPoints[iNew+sNLLIndex] = 0;
+			iNew += sTestPointSize;
+		}
 	}
 	return(nSavedTestPoints);
 }
 
 
-void Maximisation::FinalSearch()
+void Maximisation::FinalSearch(float rmax2, float zmax)
 {
-	// Find best and worst likelihoods
-	
-	// Make final reduction in branches
-	
-	// Find best fit
+	// Rather than placing more dodecahedron shells (20 likelihood evaluations
+	// each), refine the best survivors of the fine search with a local 
+	// gradient-based minimisation of the time likelihood in (x, y, z, t0).
+	// This converges to well below a centimetre in a handful of likelihood
+	// evaluations and needs no ROOT/Minuit on the hot path.
+	// The likelihood of each refined vertex is evaluated by the final-pass
+	// evaluator, which finds the energy, goodness and direction in the same
+	// loop over the hits (see EvaluateFinalVertex).
+	int nStarts = min(NTestPoints(), mDeadline.ScaleBudget(libConstants::sFinalSearchStarts));
+	int iBest = 0;
+	vector<FitResult> startResultVector(nStarts);
+	for (int iStart = 0; iStart < nStarts; iStart++)
+	{
+		auto first = mTestPoints.begin()+iStart*sTestPointSize;
+		vector<float> vertexVector(first, first+sTestPointSize);
+		RefineVertex(rmax2, zmax, vertexVector);
+
+		// Keep the refined vertex (with its refined t0) if the full 
+		// likelihood, including any angular constraint, is better.
+		float nll = EvaluateFinalVertex(vertexVector);
+		if (nll < first[sNLLIndex])
+		{
+			vertexVector[sNLLIndex] = nll;
+			copy(vertexVector.begin(), vertexVector.end(), first);
+			startResultVector[iStart] = mFinalPassResult;
+		}
+		if (first[sNLLIndex] < mTestPoints[iBest*sTestPointSize+sNLLIndex])
+		{
+			iBest = iStart;
+		}
+	}
+
+	// Find best fit: put the best refined point first.
+	if (iBest > 0)
+	{
+		swap_ranges(mTestPoints.begin(), mTestPoints.begin()+sTestPointSize, mTestPoints.begin()+iBest*sTestPointSize);
+	}
+
+	// Keep the final-pass quantities for the best vertex. (If its 
+	// refinement was not kept, its likelihood is evaluated once more.)
+	if (nStarts > 0 && startResultVector[iBest].nWindowHits < 0)
+	{
+		vector<float> bestVertex(mTestPoints.begin(), mTestPoints.begin()+sTestPointSize);
+		EvaluateFinalVertex(bestVertex);
+		startResultVector[iBest] = mFinalPassResult;
+	}
+	if (nStarts > 0)
+	{
+		SetFinalPassResult(startResultVector[iBest]);
+	}
+}
+
+float Maximisation::EvaluateFinalVertex(vector<float>& vertexVector)
+{
+	// Evaluates the likelihood at the vertex {x, y, z, t0} (keeping t0) with
+	// the final-pass evaluator, which adds each hit to the energy estimator
+	// and goodness of fit as its likelihood is summed and then fits the
+	// direction, even if the angle is not used in the likelihood. Only the
+	// best vertices need them, so the search uses the evaluator without
+	// the final-pass work. They are left in mFinalPassResult.
+	mFinalPassResult = FitResult();
+	mFinalPassResult.nWindowHits = 0;
+	float nll = (this->*mFinalVertexLikelihood)(mWorkspace, vertexVector, false, numeric_limits<float>::max());
+	mFinalPassResult.x = vertexVector[0];
+	mFinalPassResult.y = vertexVector[1];
+	mFinalPassResult.z = vertexVector[2];
+	mFinalPassResult.goodness = (mNHits > 0) ? mFinalPassResult.goodness/mNHits : 0;
+	return(nll);
 }
- 
 
+void Maximisation::SetFinalPassResult(FitResult& finalPassResult)
+{
+	mFitResult.nEffective = finalPassResult.nEffective;
+	mFitResult.nWindowHits = finalPassResult.nWindowHits;
+	mFitResult.goodness = finalPassResult.goodness;
+	mFitResult.dirx = finalPassResult.dirx;
+	mFitResult.diry = finalPassResult.diry;
+	mFitResult.dirz = finalPassResult.dirz;
+	mFitResult.theta = finalPassResult.theta;
+	mFitResult.phi = finalPassResult.phi;
+	mFitResult.cosCone = finalPassResult.cosCone;
+	mFitResult.dirGoodness = finalPassResult.dirGoodness;
+}
+ 
 //*****************************************************************************
 // These are the subsidiary functions called by the successive searches.
 
-vector<float> FindDodecahedronVertices(float x,float y,float z,float t0, rmax)
-{
-	// Cartesian co-ordinates of a dodecahedron centred 
-	float goldenRatio = (sqrt(5) - 1) / 2;
-	float a = 1/sqrt(3);
-	float b = a / goldenRatio;
-	float c = a * goldenRatio;
-
-	// Generate vertices and add to a vector
-	// Generate vertices centred on a point at the origin (0,0,0)
-	vector<vector<float>> newTestPointsVector;
-	vector<int> coefficientVector = { -1, 1};
-	for (int iCoefficient : coefficientVector)
-	{
-		for (int jCoefficient : coefficientVector)
-		{
-			newTestPointsVector.Add({
-					x + 0,
-					y + iCoefficient * c * rmax,
-					z + jCoefficient * b * rmax
-					});
-			newTestPointsVector.Add({
-					x + iCoefficient * c * rmax,
-                    y + jCoefficient * b * rmax,
-					z + 0
-					});
-			newTestPointsVector.Add({
-					x + iCoefficient * b * rmax,
-					y + 0,
-					z + jCoefficient * c * rmax
-					});
-			for (int kCoefficient : coefficientVector)
+void Maximisation::SetShell(int stage)
+{
+	// Fills mShellOffsets with the unit vectors of the shell selected by
+	// libConstants::sShellType. For better coverage the shell of each 
+	// successive search can be rotated by sShellRotationAngle (about z and
+	// then x), so that its vertices do not line up with the previous ones.
+	mShellOffsets.clear();
+	mShellOffsets.reserve(3*libShells::ShellSize(libConstants::sShellType));
+	if (libConstants::sShellType != libShells::sIcosahedron)
+	{
+		for (int iVertex = 0; iVertex < libShells::sNDodecahedron; iVertex++)
+		{
+			mShellOffsets.insert(mShellOffsets.end(), libShells::sDodecahedronShell[iVertex], libShells::sDodecahedronShell[iVertex]+3);
+		}
+	}
+	if (libConstants::sShellType != libShells::sDodecahedron)
+	{
+		for (int iVertex = 0; iVertex < libShells::sNIcosahedron; iVertex++)
+		{
+			mShellOffsets.insert(mShellOffsets.end(), libShells::sIcosahedronShell[iVertex], libShells::sIcosahedronShell[iVertex]+3);
+		}
+	}
+
+	float angle = stage*libConstants::sShellRotationAngle*M_PI/180.;
+	if (angle == 0)
+	{
+		return;
+	}
+	float cosAngle = cos(angle);
+	float sinAngle = sin(angle);
+	for (int iOffset = 0; iOffset < (int)mShellOffsets.size(); iOffset += 3)
+	{
+		float x = mShellOffsets[iOffset];
+		float y = mShellOffsets[iOffset+1];
+		float z = mShellOffsets[iOffset+2];
+		// Rotate about z
+		float xr = cosAngle*x - sinAngle*y;
+		float yr = sinAngle*x + cosAngle*y;
+		// Rotate about x
+		mShellOffsets[iOffset] = xr;
+		mShellOffsets[iOffset+1] = cosAngle*yr - sinAngle*z;
+		mShellOffsets[iOffset+2] = sinAngle*yr + cosAngle*z;
+	}
+}
+
+void Maximisation::RefineVertex(float rmax2, float zmax, vector<float>& vertexVector)
+{
+	// Limited-memory BFGS minimisation of the time likelihood starting from
+	// vertexVector = {x, y, z, t0, ...}. The time is scaled by the speed of
+	// light so that all four parameters are in cm. Every step is limited to
+	// sFinalMaxStep and projected back into the search volume.
+	const int nPar = 4;
+	const float c = libConstants::sCmPerNs;
+	const int historySize = libConstants::sFinalHistorySize;
+
+	vector<float> parVector = {vertexVector[0], vertexVector[1], vertexVector[2], vertexVector[3]*c};
+	vector<float> gradientVector(nPar);
+	vector<float> trialVector(nPar);
+	vector<float> trialGradientVector(nPar);
+	vector<float> directionVector(nPar);
+	vector<vector<float>> sHistory; // parameter changes
+	vector<vector<float>> yHistory; // gradient changes
+	vector<float> rhoHistory;
+	vector<float> alphaVector(historySize);
+
+	// Evaluate the likelihood and convert the gradient to scaled parameters.
+	auto evaluate = [&] (vector<float>& par, vector<float>& gradient)
+	{
+		vector<float> vertex = {par[0], par[1], par[2], par[3]/c};
+		float nll = FindTimeLikelihoodGradient(vertex, gradient);
+		gradient[3] /= c;
+		return nll;
+	};
+	auto dot = [nPar] (const vector<float>& a, const vector<float>& b)
+	{
+		float sum = 0;
+		for (int i = 0; i < nPar; i++)
+		{
+			sum += a[i]*b[i];
+		}
+		return sum;
+	};
+
+	float nll = evaluate(parVector, gradientVector);
+
+	for (int iteration = 0; iteration < libConstants::sFinalMaxIterations; iteration++)
+	{
+		// Keep the vertex reached so far once the deadline has passed.
+		if (CheckDeadline())
+		{
+			break;
+		}
+		// Two-loop recursion to get the search direction -H*g.
+		directionVector = gradientVector;
+		int nHistory = sHistory.size();
+		for (int i = nHistory-1; i >= 0; i--)
+		{
+			alphaVector[i] = rhoHistory[i]*dot(sHistory[i], directionVector);
+			for (int j = 0; j < nPar; j++)
+			{
+				directionVector[j] -= alphaVector[i]*yHistory[i][j];
+			}
+		}
+		float gamma = 1;
+		if (nHistory > 0)
+		{
+			gamma = dot(sHistory[nHistory-1], yHistory[nHistory-1])/dot(yHistory[nHistory-1], yHistory[nHistory-1]);
+		}
+		for (int j = 0; j < nPar; j++)
+		{
+			directionVector[j] *= gamma;
+		}
+		for (int i = 0; i < nHistory; i++)
+		{
+			float beta = rhoHistory[i]*dot(yHistory[i], directionVector);
+			for (int j = 0; j < nPar; j++)
+			{
+				directionVector[j] += sHistory[i][j]*(alphaVector[i]-beta);
+			}
+		}
+		for (int j = 0; j < nPar; j++)
+		{
+			directionVector[j] = -directionVector[j];
+		}
+
+		// Fall back to steepest descent if this is not a descent direction
+		// (or on the first iteration, when the scale of H is unknown).
+		float slope = dot(gradientVector, directionVector);
+		if (nHistory == 0 || slope >= 0)
+		{
+			directionVector = gradientVector;
+			for (float& d : directionVector)
+			{
+				d = -d;
+			}
+			slope = dot(gradientVector, directionVector);
+			if (slope >= 0)
 			{
-				newTestPointsVector.Add({
-						x + iCoefficient * a * rmax,
-						y + jCoefficient * a * rmax,
-						z + kCoefficient * a * rmax
-						})
+				break; // zero gradient: already at a minimum
 			}
+			float norm = sqrt(-slope);
+			for (float& d : directionVector)
+			{
+				d *= libConstants::sFinalMaxStep/norm;
+			}
+			slope = dot(gradientVector, directionVector);
 		}
 
-	}
+		// Bound the step length.
+		float stepLength = sqrt(dot(directionVector, directionVector));
+		if (stepLength > libConstants::sFinalMaxStep)
+		{
+			float scale = libConstants::sFinalMaxStep/stepLength;
+			for (float& d : directionVector)
+			{
+				d *= scale;
+			}
+			slope *= scale;
+		}
+
+		// Backtracking line search (Armijo condition), keeping every trial
+		// point inside the search volume.
+		float step = 1;
+		float trialNLL = nll;
+		bool accepted = false;
+		for (int iTrial = 0; iTrial < 10; iTrial++)
+		{
+			for (int j = 0; j < nPar; j++)
+			{
+				trialVector[j] = parVector[j] + step*directionVector[j];
+			}
+			float r2 = trialVector[0]*trialVector[0] + trialVector[1]*trialVector[1];
+			if (r2 > rmax2)
+			{
+				float scale = sqrt(rmax2/r2);
+				trialVector[0] *= scale;
+				trialVector[1] *= scale;
+			}
+			trialVector[2] = max(-zmax, min(zmax, trialVector[2]));
 
+			trialNLL = evaluate(trialVector, trialGradientVector);
+			if (trialNLL <= nll + 1e-4*step*slope)
+			{
+				accepted = true;
+				break;
+			}
+			step *= 0.5;
+		}
+		if (!accepted)
+		{
+			break;
+		}
 
-	return(newTestPointsVector);
-}
+		// Update the correction history.
+		vector<float> sVector(nPar), yVector(nPar);
+		for (int j = 0; j < nPar; j++)
+		{
+			sVector[j] = trialVector[j] - parVector[j];
+			yVector[j] = trialGradientVector[j] - gradientVector[j];
+		}
+		float sy = dot(sVector, yVector);
+		if (sy > 1e-10)
+		{
+			if ((int)sHistory.size() == historySize)
+			{
+				sHistory.erase(sHistory.begin());
+				yHistory.erase(yHistory.begin());
+				rhoHistory.erase(rhoHistory.begin());
+			}
+			sHistory.push_back(sVector);
+			yHistory.push_back(yVector);
+			rhoHistory.push_back(1/sy);
+		}
 
+		parVector = trialVector;
+		gradientVector = trialGradientVector;
+		nll = trialNLL;
 
+		// Converged once the step is below the required precision.
+		if (sqrt(dot(sVector, sVector)) < libConstants::sFinalConvergence)
+		{
+			break;
+		}
+	}
 
-float Maximisation::FindTestPointLikelihood(vector<HitInfo> hitInfoVector, vector<float>& testPointVtxVector)
+	vertexVector[0] = parVector[0];
+	vertexVector[1] = parVector[1];
+	vertexVector[2] = parVector[2];
+	vertexVector[3] = parVector[3]/c;
+}
+
+float Maximisation::FindTestPointLikelihood(vector<float>& testPointVtxVector, bool fitTZero, float cutoff)
+{
+	// Calls the likelihood evaluator specialised for the options selected
+	// by SetLikelihoodOptions.
+	return((this->*mTestPointLikelihood)(mWorkspace, testPointVtxVector, fitTZero, cutoff));
+}
+
+template <class Policy>
+float Maximisation::EvaluateTestPointLikelihood(LikelihoodWorkspace& workspace, vector<float>& testPointVtxVector, bool fitTZero, float cutoff)
 {
 	// likelihood.cc:11 like0 = fittime(1,vertex,dirfit,dt)
 	// timefit.cc:796 fittime calls makedirtof,fastaddloglik, returns makelike:
@@ -201,176 +954,221 @@ float Maximisation::FindTestPointLikelihood(vector<HitInfo> hitInfoVector, vecto
 	// from the pdf and the negative log likelihood calculated.
 	// Finally, the negative log likelihood is adjusted for the angular
 	// constraint if used. This is most useful for pure Cherenkov light.
+	// If fitTZero is false, the t0 already stored in the test point is used
+	// (e.g. after the final search has refined it).
+	// The options are compile-time constants of the Policy, so the branches
+	// (and the direction stream, when the angle is not used) are removed
+	// from each specialised loop.
 
 
 	// Calculate time - time of flight (ttof) for each hit from testpoint.
 	// Also save direction to each hit from the vertex for centroid fit.
 	// timefit.cc:168 makedirtof(vertex)
-	int nHits = size(hitInfoVector);
-	vector<float> ttofVector;
-	vector<vector<float>> hitDirectionsVector(nHits,vector<float>(3));
-
-	for (int iHit = 0; iHit < nHits; iHit++)
+	// hits.inline:219 tof(vertex,dir,hit)
+	float x = testPointVtxVector[0];
+	float y = testPointVtxVector[1];
+	float z = testPointVtxVector[2];
+	for (int iHit = 0; iHit < mNHits; iHit++)
 	{
-		ttofVector.push_back(hitInfoVector[iHit].time-TimeOfFlight(hitInfoVector,testPointVtxVector,iHit,hitDirectionsVector);
+		float dx = mHitX[iHit] - x;
+		float dy = mHitY[iHit] - y;
+		float dz = mHitZ[iHit] - z;
+		float distance = sqrt(dx*dx + dy*dy + dz*dz);
+		workspace.tTofVector[iHit] = mHitTime[iHit] - distance/libConstants::sCmPerNs;
+		if constexpr (Policy::sUseAngle || Policy::sFinalPass)
+		{
+			float inverseDistance = (distance > 0) ? 1/distance : 0;
+			workspace.hitDirectionX[iHit] = dx*inverseDistance;
+			workspace.hitDirectionY[iHit] = dy*inverseDistance;
+			workspace.hitDirectionZ[iHit] = dz*inverseDistance;
+		}
 	}
 	
-	// Set t0 to the peak t-tof.
-	float t0 = FindPeakTTof(ttofVector);
+	// Set t0 to the peak t-tof, using the configured t0 strategy.
+	if (fitTZero)
+	{
+		testPointVtxVector[sTZeroIndex] = workspace.tZeroEstimator->FindTZero(workspace.tTofVector,testPointVtxVector);
+	}
+	float t0 = testPointVtxVector[sTZeroIndex];
 
 	// Find the total negative log likelihood given t0.
-	float NLLikelihood = GetNegativeLogLikelihood(ttofVector,timeResidualPDF,t0);
+	// The angular correction can only increase it, so a point already over
+	// the cut-off is rejected without the direction fit.
+	float nLLikelihood = GetNegativeLogLikelihood<Policy>(workspace, t0, cutoff);
+	if (nLLikelihood > cutoff)
+	{
+		return(nLLikelihood);
+	}
 
 	// Apply the angular constraint if using.
-	float NLLikelihoodConstrained = NLLikelihood;
-	if (UseAngle)
+	float nLLikelihoodConstrained = nLLikelihood;
+	if constexpr (Policy::sUseAngle || Policy::sFinalPass)
 	{
 		// Do the direction centroid fit for each testpoint only if we are 
-		// going to do the angular correction to the likelihood.
-		vector<float> directionVector;
-		FitDirectionCentroid(hitDirectionsVector,vertexVector,t0,directionVector);
-		
-		// Find deviation of direction from constraining angle.
-		float deviation = directionVector[3]-libConstants::sConstrainingAngle;
-		// Make correction to likelihood. This varies depending on whether
-		// the deviation is positive or negative.
-		if (deviation > 0)
+		// going to do the angular correction to the likelihood, or for the
+		// direction of the final vertex.
+		vector<float> directionVector(5);
+		FitDirectionCentroid(workspace,t0,directionVector);
+		if constexpr (Policy::sFinalPass)
 		{
-			nLLikelihoodConstrained = nLLikelihood - deviation*deviation*libConstants::sPositiveAngleCorrection;
+			SetFinalDirection(directionVector);
 		}
-		else
+		if constexpr (Policy::sUseAngle)
 		{
-			nLLikelihoodConstrained = nLLikelihood - deviation*deviation*libConstants::sNegativeAngleCorrection;	
+			// Find deviation of the median cos theta of the hits around the
+			// centroid direction from the cosine of the constraining angle.
+			float deviation = directionVector[4]-cos(libConstants::sConstrainingAngle*M_PI/180.);
+			// Make correction to likelihood. This varies depending on whether
+			// the deviation is positive or negative. (The deviation penalises
+			// the fit, so it increases the negative log likelihood.)
+			if (deviation > 0)
+			{
+				nLLikelihoodConstrained = nLLikelihood + deviation*deviation*libConstants::sPositiveAngleCorrection;
+			}
+			else
+			{
+				nLLikelihoodConstrained = nLLikelihood + deviation*deviation*libConstants::sNegativeAngleCorrection;	
+			}
 		}
 	}
 
 	return(nLLikelihoodConstrained);
 }
 
-float Maximisation::TimeOfFlight(vector<HitInfo> hitInfoVector, vector<float>testPointVtxVector int iHit, vector<vector<float>>& hitDirectionsVector)
+float Maximisation::FindTimeLikelihoodGradient(vector<float>& vertexVector, vector<float>& gradientVector)
 {
-	// Calculates the time of flight of the light for each hit
-	// in straight-line direction from the vertex being tested.
-	// Saves the hit directions in a vector for the direction centroid fit.
-	// hits.inline:219 tof(vertex,dir,hit)
-	
-	// First calculate direction of each hit from the vertex.
-	hitDirectionsVector[iHit][0] = hitInfoVector[iHit].pmtx-testPointVtxVector[0];
-	hitDirectionsVector[iHit][1] = hitInfoVector[iHit].pmty-testPointVtxVector[1];
-	hitDirectionsVector[iHit][2] = hitInfoVector[iHit].pmtz-testPointVtxVector[2];
-	float distance = sqrt(hitDirectionsVector[iHit][0]**2 + hitDirectionsVector[iHit][1]**2 + hitDirectionsVector[iHit][2]**2);
-	if (distance ==0)
+	// Calculates the time-only negative log likelihood for the vertex
+	// {x, y, z, t0} together with its analytic gradient.
+	// For each hit the time residual is r = t - d/c - t0 with d the distance
+	// from the vertex to the hit PMT, so
+	// 		dr/dx = (pmtx - x)/(d*c)	(similarly for y and z)
+	// 		dr/dt0 = -1
+	// and the chain rule with the slope of the tabulated -log(p) gives the
+	// gradient without any further likelihood evaluations.
+	float x = vertexVector[0];
+	float y = vertexVector[1];
+	float z = vertexVector[2];
+	float t0 = vertexVector[3];
+	float nLLikelihood = 0;
+	fill(gradientVector.begin(), gradientVector.end(), 0);
+
+	for (int iHit = 0; iHit < mNHits; iHit++)
 	{
-		return(0);
+		float dx = mHitX[iHit] - x;
+		float dy = mHitY[iHit] - y;
+		float dz = mHitZ[iHit] - z;
+		float distance = sqrt(dx*dx + dy*dy + dz*dz);
+		float residual = mHitTime[iHit] - distance/libConstants::sCmPerNs - t0;
+
+		nLLikelihood += mTimeResidualPDF.NegativeLogLikelihood(residual);
+		float slope = mTimeResidualPDF.NegativeLogLikelihoodDerivative(residual);
+		if (distance > 0)
+		{
+			float scale = slope/(distance*libConstants::sCmPerNs);
+			gradientVector[0] += scale*dx;
+			gradientVector[1] += scale*dy;
+			gradientVector[2] += scale*dz;
+		}
+		gradientVector[3] -= slope;
 	}
-	// Divide all elements of vector by distance magnitude
-	transform(hitDirectionsVector.begin(), hitDirectionsVector.end(), hitDirectionsVector.begin(), [distance](int &d){ return d/distance; });
-	
-	// Then convert to time and return.
-	return(distance/libConstants::sCmPerNs)
-}
-
-float Maximisation::FindPeakTTof(vector<vector<float> ttofVector);
-{
-	// Find the peak time in the t-tof vector.
-	// This is the time-residual range (default 0.4 ns bin width) 
-	// with the highest number of hits.
-	// BONSAI only include hits with t-tof > 0 but we'll look at all hits here.
-	float ttofMin = *min_element(ttofVector.begin(),ttofVector.end()); 
-	float ttofMax = *max_element(ttofVector.begin(),ttofVector.end());
-	// Get number of bins required for given bin width (ceil rounds up to the
-	// nearest integer).
-	int nbins = ceil((ttofMax - ttofMin)/libConstants::sBinwidthTTOF);
-	// Create a histogram for the t-tof values
-	TH1F h = new TH1F("httofs","httofs",nbins,ttofMin,ttofMax+nbins*libConstants::sBinwidthTTOF);
-	// Fill the histogram from the ttofs vector.
-	for (float ttof : ttofVector)
-	{
-		httofs->Fill(ttof);
-	}
-	// Scale httofs
-	//httofs->Scale(1/httofs->Integral());
-	
-	// Find the peak time bin (i.e. the one with most hits)
-	int maxbin = httofs->GetMaximumBin();
-	// Define the approximate peak time as the centre of the peak time bin
-	float peak_ttof = httofs->GetBinCenter(maxbin);
-	// Do a fit to httofs and get the x value corresponding to the max of the fit
-	// Default range for peak fit +/- 12 ns
-	// TODO should this be over a larger range??
-	float timeRange = libConstants::sRangePeakFitTTOF*libConstants::sBinwidthPeakFitTTOF;
-	TF1 *peakfit = new TF1("peakfit", "pol2", peakttofs_tmp-timeRange, peakttofs_tmp+timeRange);
-	httofs->Fit("peakfit", "R");	
-	peak_ttof = peakfit->GetMaximumX();
-	
-	// Delete ttof histogram
-	delete httofs;
-	
-	return(peak_ttof);
+
+	return(nLLikelihood);
 }
 
-void FitDirectionCentroid(vector<HitInfo> hitInfoVector,vector<float> ttofVector, float t0, vector<float>& directionVector)//, vector<float>& centroidFitVector)
+void Maximisation::SetHits(vector<HitInfo>& hitInfoVector)
 {
-	// Calculates the weight of each hit dependent on the value of the
-	// time residual
-	float tResLowerLimit = timeResolutionPDF->GetXaxis()->GetMinimum();
-	float tResUpperLimit = timeResolutionPDF->GetXaxis()->GetMaximum();
-	// First weight the hits on the 
-	vector<float> weightsVector(hitInfoVector.size());
-	for (int iHit = 0; iHit < ttofVector.size(); iHit++)
-	{
-		float time = ttofVector[iHit] - t0;
-		// TODO get significance of 0.04, 0.125 and 10 and remove hard-coding
-		if (time > 0)
-		{
-			weightsVector[iHit] -= 0.04 * time * time;
-		}
-		else
+	// Copies the hit information into flat arrays once per event, so that
+	// each specialised likelihood loop only streams the arrays it uses.
+	mNHits = hitInfoVector.size();
+	mHitX.resize(mNHits);
+	mHitY.resize(mNHits);
+	mHitZ.resize(mNHits);
+	mHitTime.resize(mNHits);
+	mHitCharge.resize(mNHits);
+	mHitChargeOffset.assign(mNHits, 0);
+	mWorkspace.Resize(mNHits);
+	for (int iHit = 0; iHit < mNHits; iHit++)
+	{
+		mHitX[iHit] = hitInfoVector[iHit].pmtx;
+		mHitY[iHit] = hitInfoVector[iHit].pmty;
+		mHitZ[iHit] = hitInfoVector[iHit].pmtz;
+		mHitTime[iHit] = hitInfoVector[iHit].time;
+		mHitCharge[iHit] = hitInfoVector[iHit].charge;
+		// The charge row of the time-charge pdf is the same for every test
+		// point, so it is found once here (only if charge is used).
+		if (mUseCharge)
 		{
-			weightsVector[iHit] -= 0.125 * time * time;
+			mHitChargeOffset[iHit] = mTimeChargePDF.ChargeRowOffset(mHitCharge[iHit]);
 		}
-		if (weightsVector[iHit] > -10 && time > tResLowerLimit && time < tResUpperLimit)
+	}
+}
+
+void Maximisation::FitDirectionCentroid(float t0, vector<float>& directionVector)
+{
+	FitDirectionCentroid(mWorkspace, t0, directionVector);
+}
+
+void Maximisation::FitDirectionCentroid(LikelihoodWorkspace& workspace, float t0, vector<float>& directionVector)
+{
+	// Calculates the weight of each hit dependent on the value of the
+	// time residual and accumulates the weighted hit directions in the same
+	// pass. Hits with non-zero weight are copied into flat (x, y, z, weight)
+	// buffers, which are all that the weighted median needs afterwards.
+	float tResLowerLimit = mTimeResidualPDF.MinimumResidual();
+	float tResUpperLimit = mTimeResidualPDF.MaximumResidual();
+	int nHits = mNHits;
+	workspace.centroidDirectionX.resize(nHits);
+	workspace.centroidDirectionY.resize(nHits);
+	workspace.centroidDirectionZ.resize(nHits);
+	workspace.centroidWeight.resize(nHits);
+
+	int nWeighted = 0;
+	float wTotal = 0;
+	fill(directionVector.begin(), directionVector.end(), 0);
+	for (int iHit = 0; iHit < nHits; iHit++)
+	{
+		float time = workspace.tTofVector[iHit] - t0;
+		// TODO get significance of 0.04, 0.125 and 10 and remove hard-coding
+		float weight = (time > 0) ? -0.04 * time * time : -0.125 * time * time;
+		if (weight > -10 && time > tResLowerLimit && time < tResUpperLimit)
 		{
-			weightsVector[iHit] = timeResolutionPDF->GetBinContent(timeResolutionPDF->FindBin(time)) * exp(weight[iHit]);
+			weight = mTimeResidualPDF.BinContent(mTimeResidualPDF.FindBin(time)) * exp(weight);
 		}
 		else 
 		{
-			weight[iHit] = 0;
+			continue;
 		}
 
+		directionVector[0] += workspace.hitDirectionX[iHit]*weight;
+		directionVector[1] += workspace.hitDirectionY[iHit]*weight;
+		directionVector[2] += workspace.hitDirectionZ[iHit]*weight;
+		wTotal += weight;
+
+		workspace.centroidDirectionX[nWeighted] = workspace.hitDirectionX[iHit];
+		workspace.centroidDirectionY[nWeighted] = workspace.hitDirectionY[iHit];
+		workspace.centroidDirectionZ[nWeighted] = workspace.hitDirectionZ[iHit];
+		workspace.centroidWeight[nWeighted] = weight;
+		nWeighted++;
 	}
 	
-	if (accumulate(weightsVector.begin(), weightsVector.end(), 0.0) > 0)
+	if (wTotal > 0)
 	{
-		FindDirectionCentroid(hitDirectionsVector, weightsVector, directionVector);
+		FindDirectionCentroid(workspace, nWeighted, wTotal, directionVector);
 	}
 	
 }
 
 
-ivoid FindDirectionCentroid(vector<vector<float>> hitDirectionsVector, vector<float> weightsVector, vector<float>& directionVector)
+void Maximisation::FindDirectionCentroid(LikelihoodWorkspace& workspace, int nWeighted, float wTotal, vector<float>& directionVector)
 {
-
-	// TODO 
-	vector<float> centroidVector(9);
-	for (int iHit = 0; iHit< weightsVector.size(); iHit++)
-	{
-		if (weightsVector[iHit] > 0)
-		{
-			float x = hitDirectionsVector[iHit][0];
-			float y = hitDirectionsVector[iHit][1];
-			float z = hitDirectionsVector[iHit][2];
-			float weight = weightsVector[iHit];
-			float wTotal;
-			directionVector[0] += x*weight;
-			directionVector[1] += y*weight;
-			directionVector[2] += z*weight;
-			wTotal += weight;
-		}
-	}
+	// Turns the weighted direction sums into the centroid direction
+	// {x, y, z, magnitude, median cos theta}, where the median is the
+	// weighted median of cos theta between the centroid and the hits.
 
 	// Divide by sum of non-zero weights.
-	transform(directionVector.begin(), directionVector.end(), directionVector.begin(), [wTotal](int &c){ return c/wTotal; });
+	directionVector[0] /= wTotal;
+	directionVector[1] /= wTotal;
+	directionVector[2] /= wTotal;
 
 	// Get magnitude of direction.
 	directionVector[3] = sqrt( directionVector[0]*directionVector[0] + directionVector[1]*directionVector[1] + directionVector[2]*directionVector[2] );
@@ -387,109 +1185,191 @@ ivoid FindDirectionCentroid(vector<vector<float>> hitDirectionsVector, vector<fl
 		return;
 	}
 
-	// Find the weighted median cos theta.
-	// First get cos theta between the centroid and each hit.
-	vector<vector<float>> cosThetaVector(hitDirectionsVector.size(),2);
-	for (int iHit = 0; iHit< hitDirectionsVector.size(); iHit++)
+	// Find the weighted median cos theta without sorting: add the weight of
+	// each hit to a fixed-bin histogram of cos theta between the centroid 
+	// and the hit, then walk the bins until half of the total weight has
+	// been passed. This is linear in the number of hits and the histogram
+	// is reused for every test point.
+	const int nBins = libConstants::sCosThetaBins;
+	workspace.cosThetaHistogram.assign(nBins, 0);
+	float halfBins = 0.5*nBins;
+	for (int iHit = 0; iHit < nWeighted; iHit++)
 	{
-		float cosTheta = (directionVector[0]*hitDirectionsVector[iHit][0] + directionVector[1]*hitDirectionsVector[iHit][1] + directionVector[2]*hitDirectionsVector[iHit][2])/directionVector[3];
-		cosThetaVector.push_back( {cosTheta,weightsVector[iHit]} );
+		float cosTheta = directionVector[0]*workspace.centroidDirectionX[iHit] + directionVector[1]*workspace.centroidDirectionY[iHit] + directionVector[2]*workspace.centroidDirectionZ[iHit];
+		int bin = (int)((cosTheta+1)*halfBins);
+		bin = max(0, min(nBins-1, bin));
+		workspace.cosThetaHistogram[bin] += workspace.centroidWeight[iHit];
 	}
 
-	// Sort cosThetaVector in order of increasing cos theta.
-	sort(cosThetaVector.begin(),
-          cosThetaVector.end(),
-          [] (const vector<double> &vec1, const vector<double> &vec2)
-          {
-              return vec1[0] < vec2[0];
-          });
-
-	// Find value of minimum positive value of cos theta for which 
-	// 200*weight > 0.05*weight[cosTheta=1]
-	int medianIndex = 0;
-	float sum = wTotal - cosThetaVector[0][1];
-	while (sum > cosThetaVector[iHit])
+	// Walk up from cos theta = -1 and interpolate within the median bin.
+	float halfWeight = 0.5*wTotal;
+	float sum = 0;
+	int medianBin = 0;
+	while (medianBin < nBins-1 && sum + workspace.cosThetaHistogram[medianBin] < halfWeight)
 	{
-		++medianIndex;
-		sum -= weightsVector[medianIndex];
+		sum += workspace.cosThetaHistogram[medianBin];
+		++medianBin;
 	}
-	float medianCosTheta = cosThetaVector[medianIndex];
-	
-	//For each hit, calculate
-	//bin = (200 * direction[0]*hitDirection[0]+direction[1]+hitDirection[1]+Direction[2]+hitDirection[2])/direction[3];
-	// Add weights to histogram
-	//
-	// Then calculate angle??
-	// Find the first (lowest-number bin) for which weight > weights of hits beyond 200 
-	// then do mucang = mu cos theta??? 
-	//mucang = (bin+0.5) * direction[3]/200;
-	return;	
+	float fraction = 0.5;
+	if (workspace.cosThetaHistogram[medianBin] > 0)
+	{
+		fraction = (halfWeight - sum)/workspace.cosThetaHistogram[medianBin];
+	}
+	directionVector[4] = (medianBin + fraction)/halfBins - 1;
 }
 
-float GetNegativeLogLikelihood(vector<float> ttofVector, TH1F timeResidualPDF, float t0)
+template <class Policy>
+float Maximisation::GetNegativeLogLikelihood(LikelihoodWorkspace& workspace, float t0, float cutoff)
 {
 	// Sum up the log likelihood for all hits for the given vertex and time t0.
 	// Get the likelihood (probability) from the pdf for each ttof - t0.
 	// Add the negative log(likelihood) for each value of ttof - t0.
-	for (int ihit = 0; ihit < ttofVector.size(); ihit++)
+	// The pdf table already holds -log(p), so no log is taken per hit.
+	// The hits are summed in blocks. After each block the remaining hits 
+	// contribute at least the smallest value in the table, so once the 
+	// partial sum plus that bound exceeds the cut-off the point cannot be
+	// kept and the bound is returned instead of the full sum.
+	// With charge, the joint time-charge pdf replaces the time-residual pdf
+	// and each hit uses the row for its charge found in SetHits.
+	float minimumNLL = mTimeResidualPDF.MinimumNegativeLogLikelihood();
+	if constexpr (Policy::sUseCharge)
+	{
+		minimumNLL = mTimeChargePDF.MinimumNegativeLogLikelihood();
+	}
+	int blockSize = libConstants::sBoundedNLLBlockSize;
+	float negativeLogLikelihood = 0;
+	for (int iFirstHit = 0; iFirstHit < mNHits; iFirstHit += blockSize)
 	{
-		float negativeLogLikelihood = 0;
-		float max = numeric_limits<float>::lowest;//lowest number for comparison
-		if (libConstants::sUseCharge == 1)
+		int iLastHit = min(iFirstHit+blockSize, mNHits);
+		for (int iHit = iFirstHit; iHit < iLastHit; iHit++)
 		{
-			int bin = timeResidualPDF->FindBin(ttofVector[ihit]-t0,hitInfoVector[ihit].charge);
-			float likelihood = GetBinContent(bin);
-			negativeloglikelihood += -log(likelihood);
+			float residual = workspace.tTofVector[iHit]-t0;
+			if constexpr (Policy::sUseCharge && Policy::sInterpolatePDF)
+			{
+				negativeLogLikelihood += mTimeChargePDF.NegativeLogLikelihood(residual, mHitChargeOffset[iHit]);
+			}
+			else if constexpr (Policy::sUseCharge)
+			{
+				negativeLogLikelihood += mTimeChargePDF.NegativeLogLikelihoodBinned(residual, mHitChargeOffset[iHit]);
+			}
+			else if constexpr (Policy::sInterpolatePDF)
+			{
+				negativeLogLikelihood += mTimeResidualPDF.NegativeLogLikelihood(residual);
+			}
+			else
+			{
+				negativeLogLikelihood += mTimeResidualPDF.NegativeLogLikelihoodBinned(residual);
+			}
+			if constexpr (Policy::sFinalPass)
+			{
+				AddFinalHit(workspace, iHit, residual);
+			}
 		}
-		else
+		float lowerBound = negativeLogLikelihood + (mNHits-iLastHit)*minimumNLL;
+		if (lowerBound > cutoff)
 		{
-			int bin = timeResidualPDF->GetBinContent(ttofVector[ihit]-t0);
-			float likelihood = GetBinContent(bin);
-			negativeLogLikelihood += -log(likelihood);
+			return(lowerBound);
 		}
 	}
 
-	return(negativeLogLikelihood)
+	return(negativeLogLikelihood);
 	
 }
 
+void Maximisation::AddFinalHit(LikelihoodWorkspace& workspace, int iHit, float residual)
+{
+	// Adds the hit to the quantities found in the final pass, using the 
+	// t-tof and the direction from the vertex already found for the 
+	// likelihood rather than recalculating the time of flight:
+	// - the time goodness, the mean of exp(-r^2/2sigma^2) over all hits;
+	// - the effective number of hits (N_eff) if the residual is within the
+	//   energy window around t0. Each hit is corrected for attenuation over
+	//   its distance from the vertex and for the angle of incidence on the
+	//   PMT.
+	float distance = (mHitTime[iHit] - workspace.tTofVector[iHit])*libConstants::sCmPerNs;
+	float sigma = libConstants::sGoodnessSigma;
+	mFinalPassResult.goodness += exp(-0.5*residual*residual/(sigma*sigma));
 
-/*
- 	// Potentially have a function which can scale or add the DR.
-	// The following is a starting point but will need to be tweaked.
-	// Set the signal range
-	// Find the maximum and minimum time residuals
-	float ttofMin = *min_element(ttofVector.begin(),ttofVector.end()) - t0;
-	float ttofMax = *max_element(ttofVector.begin(),ttofVector.end()) - t0;
-	float timeRange = ttofMax - ttofMin;
-	//int minbin = timeResidualPDF->GetXaxis()->FindBin(ttofMin);
-	//int maxbin = timeResidualPDF->GetXaxis()->FindBin(ttofMax);
-
-	// Get the renormalisation factor for reducing the 
-	// pdf to the signal range
-	// probability * integrated noise * signal over Noise / integrated signal
-	float renormalisation;
-	float timeRangePDF = timeResidualPDF->GetXaxis()->GetMaximum() - timeResidualPDF->GetXaxis()->GetMinimum();
-	float noiseIntegral = libConstants::darkrate*timeRangePDF;
-	float signalIntegral = timeResidualPDF->Integral();
-	timeResidualPDF->GetXaxis()->SetMaximumBin(maxbin);
-	timeResidualPDF->GetXaxis()->SetMinimumBin(minbin);
-
-	if (addDR)
-	{
-		// Estimate dark noise and scale the pdf accordingly.
-		// Used if the timeResidualPDF does not include dark rate.
-		// TODO Estimate dark noise from ttofVector or read from pmt info.
-		// Get signal over noise for scaling
-		float noiseReducedIntegral = libConstants::darkrate*time_range;
-		float signalReducedIntegral = timeResidualPDF->Integral();
-		float signalOverNoise = signalReducedIntegral/noiseReducedIntegral;
-		float scaleFactor = NoiseIntegral * signalOver
-		timeResidualPDF->Scale(1+signalOverNoise);
-		
+	if (residual < libConstants::sEnergyWindowMin || residual > libConstants::sEnergyWindowMax || distance <= 0)
+	{
+		return;
 	}
-	
-*/
-			
 
+	// The PMTs face into the detector, so the cosine of the angle of 
+	// incidence is the direction to the hit along the outward normal of 
+	// the side wall (radial) or of the top/bottom cap (z).
+	float cosIncidence;
+	if (fabs(mHitZ[iHit]) < mZMax)
+	{
+		float rHit = sqrt(mHitX[iHit]*mHitX[iHit] + mHitY[iHit]*mHitY[iHit]);
+		cosIncidence = (rHit > 0) ? (workspace.hitDirectionX[iHit]*mHitX[iHit] + workspace.hitDirectionY[iHit]*mHitY[iHit])/rHit : 1;
+	}
+	else
+	{
+		cosIncidence = (mHitZ[iHit] > 0) ? workspace.hitDirectionZ[iHit] : -workspace.hitDirectionZ[iHit];
+	}
+	cosIncidence = max(cosIncidence, libConstants::sMinimumCosIncidence);
+
+	mFinalPassResult.nEffective += exp(distance*mInverseAttenuationLength)/cosIncidence;
+	mFinalPassResult.nWindowHits++;
+}
+
+void Maximisation::SetFinalDirection(vector<float>& directionVector)
+{
+	// Stores the direction centroid {x, y, z, magnitude, median cos theta}
+	// of the final pass as the event direction, its polar angles, the cone
+	// cosine and the direction goodness (the centroid magnitude, which is 1
+	// when all of the weighted hits lie in the same direction).
+	mFinalPassResult.dirx = directionVector[0];
+	mFinalPassResult.diry = directionVector[1];
+	mFinalPassResult.dirz = directionVector[2];
+	mFinalPassResult.dirGoodness = directionVector[3];
+	mFinalPassResult.cosCone = directionVector[4];
+	if (directionVector[3] > 0)
+	{
+		mFinalPassResult.theta = acos(clamp(directionVector[2], -1.f, 1.f));
+		mFinalPassResult.phi = atan2(directionVector[1], directionVector[0]);
+	}
+}
+
+void Maximisation::SetScheduler(TaskScheduler* scheduler, int worker)
+{
+	mScheduler = scheduler;
+	mWorker = worker;
+}
+
+template <bool finalPass>
+Maximisation::LikelihoodEvaluator Maximisation::SelectLikelihood(int option)
+{
+	switch (option)
+	{
+		case 0: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,false,false,finalPass>>);
+		case 1: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,false,true,finalPass>>);
+		case 2: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,true,false,finalPass>>);
+		case 3: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,true,true,finalPass>>);
+		case 4: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,false,false,finalPass>>);
+		case 5: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,false,true,finalPass>>);
+		case 6: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,true,false,finalPass>>);
+		default: return(&Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,true,true,finalPass>>);
+	}
+}
+
+void Maximisation::SetLikelihoodOptions(bool useCharge, bool useAngle, bool interpolatePDF)
+{
+	// Select the specialised likelihood evaluators once, so that no option
+	// is tested inside the per-hit and per-vertex loops.
+	mUseCharge = useCharge;
+	int option = 4*useCharge + 2*useAngle + interpolatePDF;
+	mTestPointLikelihood = SelectLikelihood<false>(option);
+	mFinalVertexLikelihood = SelectLikelihood<true>(option);
+}
 
+// Explicit instantiations of the specialised likelihood evaluators.
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,false,false>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,false,true>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,true,false>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<false,true,true>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,false,false>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,false,true>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,true,false>>(LikelihoodWorkspace&, vector<float>&, bool, float);
+template float Maximisation::EvaluateTestPointLikelihood<LikelihoodPolicy<true,true,true>>(LikelihoodWorkspace&, vector<float>&, bool, float);
@@ -3,10 +3,68 @@
 
 //includes
 #include <vector>
+#include <memory>
+#include <limits>
 #include <libhitinfo.hpp>
+#include <libfitresult.hpp>
+#include <libdeadline.hpp>
+#include <libpdf.hpp>
+#include <libtimechargepdf.hpp>
+#include <liblikelihoodcache.hpp>
+#include <libtzero.hpp>
+#include <libtaskscheduler.hpp>
 
 using namespace std;
 
+/*
+ * struct LikelihoodPolicy
+ * Compile-time likelihood options. The likelihood evaluator is templated on
+ * the policy so that each specialisation only contains the branches and
+ * data streams (charge, hit directions) that it uses. The final-pass
+ * specialisations also add each hit to the energy estimator, goodness and
+ * direction of the vertex as its likelihood is summed (see
+ * EvaluateFinalVertex).
+ */
+template <bool useCharge, bool useAngle, bool interpolatePDF, bool finalPass = false>
+struct LikelihoodPolicy
+{
+	static const bool sUseCharge = useCharge;
+	static const bool sUseAngle = useAngle;
+	static const bool sInterpolatePDF = interpolatePDF;
+	static const bool sFinalPass = finalPass;
+};
+
+/*
+ * struct LikelihoodWorkspace
+ * Scratch buffers of one likelihood evaluation: the t-tof values and hit
+ * directions for the current test point, the buffers of the direction
+ * centroid fit and the t0 strategy (which may keep state between test
+ * points). The hits and pdfs are only read, so several evaluations of the
+ * same event can run at once, each with its own workspace.
+ */
+struct LikelihoodWorkspace
+{
+	vector<float> tTofVector;
+	vector<float> hitDirectionX;
+	vector<float> hitDirectionY;
+	vector<float> hitDirectionZ;
+	// Directions and weights of the hits with non-zero weight, and the
+	// cos theta histogram used for the weighted median.
+	vector<float> centroidDirectionX;
+	vector<float> centroidDirectionY;
+	vector<float> centroidDirectionZ;
+	vector<float> centroidWeight;
+	vector<float> cosThetaHistogram;
+	unique_ptr<TZeroEstimator> tZeroEstimator;
+
+	inline void Resize(int nHits){
+		tTofVector.resize(nHits);
+		hitDirectionX.resize(nHits);
+		hitDirectionY.resize(nHits);
+		hitDirectionZ.resize(nHits);
+	}
+};
+
 /*
  * class Maximisation
  *
@@ -25,27 +83,193 @@ class Maximisation
 
 		Maximisation();
 		~Maximisation();
-		
+
 		// Main function called from outside class.
-		Maximise(vector <HitInfo> hitInfoVector, vector<vector<float>> testPointsVector);
-		// Principal functions which perform the likelihood calculation and 
+		void Maximise(vector <HitInfo>& hitInfoVector, float rmax2, float zmax, vector<vector<float>>& testPointsVector);
+		// Set the time-residual pdf used for the likelihood.
+		void SetTimeResidualPDF(TimeResidualPDF& timeResidualPDF);
+		// Set the dark noise rate for the event in hits per ns, e.g. from 
+		// one of the estimates below. The pdf is adjusted for it once per 
+		// event (SetNoisePDF). Only the time-residual pdf is adjusted, so
+		// noise is ignored by the time-charge likelihood.
+		void SetNoiseRate(float noiseRate);
+		// Estimate the noise rate from the hits outside the time window 
+		// [signalStart, signalEnd] which can hold light from the event, or
+		// from the dark rates (Hz) of all of the PMTs.
+		static float NoiseRateFromHits(vector<float>& timesAll, float signalStart, float signalEnd);
+		static float NoiseRateFromPMTs(vector<float>& darkRateVector);
+		// Set the joint time-charge pdf used for the likelihood when charge
+		// is used. (Must be set before SetHits/Maximise.)
+		void SetTimeChargePDF(TimeChargePDF& timeChargePDF);
+		// Set the time budget for the event (see Deadline), checked by each
+		// stage of the search.
+		void SetDeadline(Deadline& deadline);
+		// Set the attenuation length of the detector medium in cm, used to
+		// correct the energy estimator (0 = no correction).
+		void SetAttenuationLength(float attenuationLength);
+		// Select the t0 strategy (a TZeroEstimator method).
+		void SetTZeroMethod(int method);
+		// Select the likelihood evaluator specialised for these options
+		// (defaults are taken from libConstants). Must be set before SetHits,
+		// which only finds the charge rows when charge is used.
+		void SetLikelihoodOptions(bool useCharge, bool useAngle, bool interpolatePDF);
+		// Share the likelihood of large events' test points with the other
+		// workers of the scheduler, in tiles of sLikelihoodTileSize points
+		// which read this event's hits and pdfs (nullptr = use this worker
+		// only).
+		void SetScheduler(TaskScheduler* scheduler, int worker);
+
+		// Principal functions which perform the likelihood calculation and
 		// which are called by the main Maximise() function.
-		// (Strictly private functions but public to be available for 
+		// (Strictly private functions but public to be available for
 		// running unit tests.)
-		FindInitialLikelihoods(vector<HitInfo> hitInfoVector, float rmin, vector<vector<float>> testPointsVector);
-
+		void SetHits(vector<HitInfo>& hitInfoVector);
+		void SetNoisePDF();
+		void SetTestPoints(vector<vector<float>>& testPointsVector);
+		void GetTestPoints(vector<vector<float>>& testPointsVector);
+		void FindNegativeLogLikelihoods(int start, float cutoff = numeric_limits<float>::max());
+		void FindNegativeLogLikelihoodTiles(int start, float cutoff);
+		void Skim(float dLike, float skimFraction);
+		void MergeBasins(float radius);
+		void SearchShells(int stage, float rmax, float dLike, float skimFraction, float nextRmax);
+		bool HasConverged(int stage);
+		bool CheckDeadline();
+		float EvaluateFinalVertex(vector<float>& vertexVector);
+		void AddFinalHit(LikelihoodWorkspace& workspace, int iHit, float residual);
+		void SetFinalDirection(vector<float>& directionVector);
+		void SetFinalPassResult(FitResult& finalPassResult);
+		int AddPoints(float rmax, int stage);
+		void FinalSearch(float rmax2, float zmax);
 
 		// Subsidiary functions called by the the principal functions.
-		CalculateLikelihood(vector<HitInfo> hitInfoVector, vector<float>& pointVector);
+		void SetShell(int stage);
+		float RejectionCutoff();
+		void RefineVertex(float rmax2, float zmax, vector<float>& vertexVector);
+		// With a cut-off, the sum over hits stops as soon as the result is
+		// known to exceed it, and a value above the cut-off is returned.
+		float FindTestPointLikelihood(vector<float>& testPointVtxVector, bool fitTZero = true, float cutoff = numeric_limits<float>::max());
+		// The evaluators use the scratch buffers of the given workspace, 
+		// which is this object's own for the search.
+		template <class Policy>
+		float EvaluateTestPointLikelihood(LikelihoodWorkspace& workspace, vector<float>& testPointVtxVector, bool fitTZero, float cutoff);
+		float FindTimeLikelihoodGradient(vector<float>& vertexVector, vector<float>& gradientVector);
+		template <class Policy>
+		float GetNegativeLogLikelihood(LikelihoodWorkspace& workspace, float t0, float cutoff);
+		void FitDirectionCentroid(float t0, vector<float>& directionVector);
+		void FitDirectionCentroid(LikelihoodWorkspace& workspace, float t0, vector<float>& directionVector);
+		void FindDirectionCentroid(LikelihoodWorkspace& workspace, int nWeighted, float wTotal, vector<float>& directionVector);
+
+		// Each test point is stored as {x, y, z, t0, NLL}.
+		static constexpr int sTestPointSize = 5;
+		static constexpr int sTZeroIndex = 3;
+		static constexpr int sNLLIndex = 4;
+
+		// Best fit vertex and fit information for the last event.
+		inline FitResult& GetFitResult(void){
+			return(mFitResult);
+		}
+
+		// Hit and miss counters of the likelihood cache for the last event.
+		inline LikelihoodCache& GetLikelihoodCache(void){
+			return(mLikelihoodCache);
+		}
+
+		inline int NTestPoints(void){
+			return(mTestPoints.size()/sTestPointSize);
+		}
 
 	// define the private functions and variables
 	private:
 
-		
+		// Best (lowest) and worst (highest) negative log likelihoods of the
+		// current test points, tracked while the likelihoods are calculated
+		// so that Skim does not need to sort the full list to find them.
+		float mBestNLL;
+		float mWorstNLL;
+
+		// Flat test point buffer (sTestPointSize values per point), with
+		// the buffer and index list used by Skim to gather the survivors,
+		// and the vertex passed to the likelihood evaluator.
+		vector<float> mTestPoints;
+		vector<float> mSkimmedTestPoints;
+		vector<int> mOrderVector;
+		vector<float> mVertexVector;
+
+		// Unit-shell offsets {x, y, z} used by AddPoints for this stage.
+		vector<float> mShellOffsets;
+
+		// Result for this event, and the best {x, y, z, NLL} after the 
+		// previous stage used to decide whether the fit has converged.
+		FitResult mFitResult;
+		vector<float> mPreviousBestVertex;
+
+		// Time budget for the event.
+		Deadline mDeadline;
+
+		// Energy, goodness and direction found by EvaluateFinalVertex (i.e.
+		// for the best vertices only), the half-height used to tell side
+		// PMTs from top/bottom PMTs and the inverse attenuation length.
+		FitResult mFinalPassResult;
+		float mZMax;
+		float mInverseAttenuationLength = 0;
+
+		// Likelihoods of the test points already evaluated in this event.
+		LikelihoodCache mLikelihoodCache;
+
+		// Time-residual pdf, stored as -log(p) for lookup without ROOT.
+		TimeResidualPDF mTimeResidualPDF;
+		// Signal-only pdf as set by SetTimeResidualPDF, the dark noise rate
+		// for the event, the noise fraction step (in units of 
+		// sNoiseFractionTolerance) of the current pdf table and the tables
+		// built so far for each step.
+		TimeResidualPDF mSignalPDF;
+		float mNoiseRate = 0;
+		int mNoiseStep = 0;
+		vector<TimeResidualPDF> mNoisyPDFVector;
+		vector<bool> mNoisyPDFReady;
+		// Time-residual and charge pdf, used instead when charge is used.
+		TimeChargePDF mTimeChargePDF;
+
+		// Strategy used to find t0 for each test point (the estimator
+		// itself is in the workspace).
+		int mTZeroMethod;
+
+		// Whether charge is used, so that SetHits finds the charge rows.
+		bool mUseCharge;
+
+		// Scheduler shared with the other workers. Each likelihood tile
+		// makes its own workspace and reads this event's hits and pdfs.
+		// For the points of a tile pass, the likelihood, t0 and whether it
+		// was evaluated (0 = no, 1 = from the cache, 2 = calculated) with
+		// the indices of the points to calculate.
+		TaskScheduler* mScheduler = nullptr;
+		int mWorker = 0;
+		vector<float> mTileNLL;
+		vector<float> mTileTZero;
+		vector<int> mTileState;
+		vector<int> mTilePending;
+
+		// Likelihood evaluators specialised for the selected options, for
+		// the search and for the final pass.
+		typedef float (Maximisation::*LikelihoodEvaluator)(LikelihoodWorkspace&, vector<float>&, bool, float);
+		template <bool finalPass>
+		static LikelihoodEvaluator SelectLikelihood(int option);
+		LikelihoodEvaluator mTestPointLikelihood;
+		LikelihoodEvaluator mFinalVertexLikelihood;
+
+		// Per-event hits (filled by SetHits), and the scratch buffers used
+		// to evaluate the likelihood of a test point.
+		int mNHits;
+		vector<float> mHitX;
+		vector<float> mHitY;
+		vector<float> mHitZ;
+		vector<float> mHitTime;
+		vector<float> mHitCharge;
+		vector<int> mHitChargeOffset; // row of the time-charge pdf for each hit
+		LikelihoodWorkspace mWorkspace;
+
 
 
-		
 };
 
 #endif
-
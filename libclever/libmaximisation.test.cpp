@@ -0,0 +1,550 @@
+/**************************************************
+ * Unit tests for Maximisation class
+ *
+ * *************************************************/
+
+#include <libmaximisation.hpp>
+#include <libconstants.hpp>
+#include <libshells.hpp>
+#include <libtesthelpers.hpp>
+#include <libtaskscheduler.hpp>
+#include <libeventloop.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+namespace{
+
+// Light from the origin at 10 ns onto two rings of hits 500 cm away around
+// the z axis: 30 hits at cos theta 0.9 and 20 hits at 0.3.
+void MakeRingHits(vector<HitInfo>& hitInfoVector){
+
+	hitInfoVector.clear();
+	vector<float> cosThetaVector = {0.9,0.3};
+	vector<int> nRingVector = {30,20};
+	for (int iRing = 0; iRing < 2; iRing++)
+	{
+		float sinTheta = sqrt(1 - cosThetaVector[iRing]*cosThetaVector[iRing]);
+		for (int iHit = 0; iHit < nRingVector[iRing]; iHit++)
+		{
+			float phi = 2*M_PI*iHit/nRingVector[iRing];
+			float time = 10 + 500/libConstants::sCmPerNs;
+			hitInfoVector.push_back(HitInfo(0,0,1,0,{},time,1,500*sinTheta*cos(phi),500*sinTheta*sin(phi),500*cosThetaVector[iRing]));
+		}
+	}
+
+}
+
+// Maximisation set up for one event with the true vertex at {100, 0, 0}
+// and the given test points, with a 1 cm likelihood cache.
+void SetEvent(Maximisation& maximisation, vector<vector<float>>& testPointsVector){
+
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeHits({100,0,0},60,hitInfoVector);
+	maximisation.SetTimeResidualPDF(pdf);
+	maximisation.SetHits(hitInfoVector);
+	maximisation.SetTestPoints(testPointsVector);
+	maximisation.GetLikelihoodCache().Clear();
+	maximisation.GetLikelihoodCache().SetResolution(1);
+
+}
+
+// Test points on a 40 cm grid, including the true vertex.
+vector<vector<float>> GridTestPoints(){
+
+	vector<vector<float>> testPointsVector;
+	for (int ix = -2; ix <= 2; ix++)
+	{
+		for (int iy = -2; iy <= 2; iy++)
+		{
+			for (int iz = -1; iz <= 1; iz++)
+			{
+				testPointsVector.push_back({100.f+40*ix, 40.f*iy, 40.f*iz});
+			}
+		}
+	}
+	return(testPointsVector);
+
+}
+
+TEST(MaximisationTest,TestSkim){
+
+	// Skim keeps the same points as a full sort would, best first.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = GridTestPoints();
+	SetEvent(maximisation,testPointsVector);
+	maximisation.FindNegativeLogLikelihoods(0);
+	vector<vector<float>> allPointsVector;
+	maximisation.GetTestPoints(allPointsVector);
+	vector<float> nllVector;
+	for (auto& point : allPointsVector)
+	{
+		nllVector.push_back(point[Maximisation::sNLLIndex]);
+	}
+	sort(nllVector.begin(),nllVector.end());
+
+	maximisation.Skim(0,0.1);
+	int nKept = (int)(0.1*allPointsVector.size());
+	ASSERT_EQ(maximisation.NTestPoints(),nKept);
+	vector<vector<float>> keptPointsVector;
+	maximisation.GetTestPoints(keptPointsVector);
+	for (int iKept = 0; iKept < nKept; iKept++)
+	{
+		EXPECT_FLOAT_EQ(keptPointsVector[iKept][Maximisation::sNLLIndex],nllVector[iKept]);
+	}
+	EXPECT_FLOAT_EQ(keptPointsVector[0][0],100);
+	EXPECT_FLOAT_EQ(keptPointsVector[0][1],0);
+	EXPECT_FLOAT_EQ(keptPointsVector[0][2],0);
+
+	// If the likelihoods are within dLike, every point is kept.
+	maximisation.Skim(1e6,0.1);
+	EXPECT_EQ(maximisation.NTestPoints(),nKept);
+
+}
+
+
+TEST(MaximisationTest,TestRefineVertex){
+
+	// The L-BFGS refinement converges to the true vertex and time from a
+	// nearby start.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector;
+	SetEvent(maximisation,testPointsVector);
+	vector<float> vertexVector = {130,20,-15,9,0};
+	maximisation.RefineVertex(1e6,1e3,vertexVector);
+	EXPECT_NEAR(vertexVector[0],100,2);
+	EXPECT_NEAR(vertexVector[1],0,2);
+	EXPECT_NEAR(vertexVector[2],0,2);
+	EXPECT_NEAR(vertexVector[3],10,0.2);
+
+	// With the true vertex outside the search volume, every step is 
+	// projected back inside it.
+	vertexVector = {40,0,0,10,0};
+	maximisation.RefineVertex(50*50,5,vertexVector);
+	EXPECT_LE(vertexVector[0]*vertexVector[0]+vertexVector[1]*vertexVector[1],50*50*1.0001);
+	EXPECT_LE(fabs(vertexVector[2]),5);
+	EXPECT_GT(vertexVector[0],40);
+
+}
+
+
+TEST(MaximisationTest,TestDirectionCentroid){
+
+	// For the ring hits the centroid is along z and the weighted median 
+	// cos theta is in the larger ring (the mean would be 0.66).
+	vector<HitInfo> hitInfoVector;
+	MakeRingHits(hitInfoVector);
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	Maximisation maximisation;
+	maximisation.SetTimeResidualPDF(pdf);
+	maximisation.SetLikelihoodOptions(false,true,true);
+	maximisation.SetHits(hitInfoVector);
+
+	vector<float> vertexVector = {0,0,0,0,0};
+	maximisation.FindTestPointLikelihood(vertexVector);
+	vector<float> directionVector(5);
+	maximisation.FitDirectionCentroid(vertexVector[Maximisation::sTZeroIndex],directionVector);
+	EXPECT_NEAR(directionVector[0],0,1e-3);
+	EXPECT_NEAR(directionVector[1],0,1e-3);
+	EXPECT_NEAR(directionVector[2],1,1e-3);
+	EXPECT_NEAR(directionVector[4],0.9,2.0/libConstants::sCosThetaBins);
+
+}
+
+
+TEST(MaximisationTest,TestLikelihoodOptions){
+
+	// Each specialised evaluator gives the sum over the hits of the pdf 
+	// value it selects, plus the angular correction when the angle is used.
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeHits({100,0,0},60,hitInfoVector);
+	vector<float> vertex = {120,10,0,10};
+	float nllInterpolated = 0;
+	float nllBinned = 0;
+	for (auto& hit : hitInfoVector)
+	{
+		float dx = hit.pmtx-vertex[0], dy = hit.pmty-vertex[1], dz = hit.pmtz-vertex[2];
+		float residual = hit.time - sqrt(dx*dx+dy*dy+dz*dz)/libConstants::sCmPerNs - vertex[3];
+		nllInterpolated += pdf.NegativeLogLikelihood(residual);
+		nllBinned += pdf.NegativeLogLikelihoodBinned(residual);
+	}
+
+	Maximisation maximisation;
+	maximisation.SetTimeResidualPDF(pdf);
+	maximisation.SetHits(hitInfoVector);
+	vector<float> vertexVector = {120,10,0,10,0};
+	maximisation.SetLikelihoodOptions(false,false,true);
+	EXPECT_NEAR(maximisation.FindTestPointLikelihood(vertexVector,false),nllInterpolated,1e-3);
+	maximisation.SetLikelihoodOptions(false,false,false);
+	EXPECT_NEAR(maximisation.FindTestPointLikelihood(vertexVector,false),nllBinned,1e-3);
+
+	maximisation.SetLikelihoodOptions(false,true,true);
+	float nllAngle = maximisation.FindTestPointLikelihood(vertexVector,false);
+	vector<float> directionVector(5);
+	maximisation.FitDirectionCentroid(vertexVector[Maximisation::sTZeroIndex],directionVector);
+	float deviation = directionVector[4]-cos(libConstants::sConstrainingAngle*M_PI/180.);
+	float correction = deviation*deviation*((deviation > 0) ? libConstants::sPositiveAngleCorrection : libConstants::sNegativeAngleCorrection);
+	EXPECT_NEAR(nllAngle,nllInterpolated+correction,1e-3);
+
+}
+
+
+TEST(MaximisationTest,TestAddPoints){
+
+	// Each survivor gets a shell of distinct points at distance rmax, 
+	// which take its t0.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = {{100,0,0,10,50},{-100,50,20,12,60}};
+	maximisation.SetTestPoints(testPointsVector);
+	int nPrevious = maximisation.AddPoints(30,FitResult::sCoarseStage);
+	int nShellPoints = libShells::ShellSize(libConstants::sShellType);
+	EXPECT_EQ(nPrevious,2);
+	ASSERT_EQ(maximisation.NTestPoints(),2+2*nShellPoints);
+	maximisation.GetTestPoints(testPointsVector);
+	for (int iPoint = 2; iPoint < maximisation.NTestPoints(); iPoint++)
+	{
+		vector<float>& origin = testPointsVector[(iPoint-2)/nShellPoints];
+		vector<float>& point = testPointsVector[iPoint];
+		float dx = point[0]-origin[0], dy = point[1]-origin[1], dz = point[2]-origin[2];
+		EXPECT_NEAR(sqrt(dx*dx+dy*dy+dz*dz),30,1e-3);
+		EXPECT_EQ(point[Maximisation::sTZeroIndex],origin[Maximisation::sTZeroIndex]);
+		for (int iOther = 2; iOther < iPoint; iOther++)
+		{
+			vector<float>& other = testPointsVector[iOther];
+			dx = point[0]-other[0], dy = point[1]-other[1], dz = point[2]-other[2];
+			EXPECT_GT(dx*dx+dy*dy+dz*dz,1);
+		}
+	}
+
+}
+
+
+TEST(MaximisationTest,TestLikelihoodCache){
+
+	// A point in the same cache cell as one already evaluated takes its
+	// likelihood and t0 without being evaluated again.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = {{120.2,0.2,0.2},{150,0,0},{120.4,0.3,0.1}};
+	SetEvent(maximisation,testPointsVector);
+	maximisation.FindNegativeLogLikelihoods(0);
+	maximisation.GetTestPoints(testPointsVector);
+	EXPECT_EQ(maximisation.GetLikelihoodCache().NHits(),1);
+	EXPECT_EQ(maximisation.GetLikelihoodCache().NMisses(),2);
+	EXPECT_EQ(testPointsVector[2][Maximisation::sNLLIndex],testPointsVector[0][Maximisation::sNLLIndex]);
+	EXPECT_EQ(testPointsVector[2][Maximisation::sTZeroIndex],testPointsVector[0][Maximisation::sTZeroIndex]);
+	EXPECT_NE(testPointsVector[1][Maximisation::sNLLIndex],testPointsVector[0][Maximisation::sNLLIndex]);
+
+}
+
+
+TEST(MaximisationTest,TestLikelihoodTiles){
+
+	// Tiles evaluated by the other workers, reading the hits and noisy 
+	// pdf of the event, give the same likelihoods as the serial loop.
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeHits({100,0,0},libConstants::sParallelMinimumHits+50,hitInfoVector);
+	vector<vector<float>> testPointsVector = GridTestPoints();
+	ASSERT_GE((int)testPointsVector.size(),2*libConstants::sLikelihoodTileSize);
+	auto findLikelihoods = [&] (Maximisation& maximisation, vector<vector<float>>& resultsVector)
+	{
+		maximisation.SetTimeResidualPDF(pdf);
+		maximisation.SetNoiseRate(1);
+		maximisation.SetHits(hitInfoVector);
+		maximisation.SetNoisePDF();
+		maximisation.SetTestPoints(testPointsVector);
+		maximisation.GetLikelihoodCache().Clear();
+		maximisation.GetLikelihoodCache().SetResolution(1);
+		maximisation.FindNegativeLogLikelihoods(0);
+		maximisation.GetTestPoints(resultsVector);
+	};
+
+	Maximisation serial;
+	vector<vector<float>> serialVector;
+	findLikelihoods(serial,serialVector);
+
+	EventLoop loop(4);
+	TaskScheduler scheduler(loop.NThreads());
+	vector<vector<float>> tiledVector;
+	loop.RunWorkers([&] (int thread)
+	{
+		if (thread == 0)
+		{
+			Maximisation tiled;
+			tiled.SetScheduler(&scheduler,thread);
+			findLikelihoods(tiled,tiledVector);
+		}
+		scheduler.Retire(thread);
+	});
+
+	ASSERT_EQ(tiledVector.size(),serialVector.size());
+	for (unsigned int iPoint = 0; iPoint < serialVector.size(); iPoint++)
+	{
+		EXPECT_EQ(tiledVector[iPoint][Maximisation::sNLLIndex],serialVector[iPoint][Maximisation::sNLLIndex]);
+		EXPECT_EQ(tiledVector[iPoint][Maximisation::sTZeroIndex],serialVector[iPoint][Maximisation::sTZeroIndex]);
+	}
+
+}
+
+TEST(MaximisationTest,TestBoundedLikelihood){
+
+	// Below the cut-off the bounded sum is the full likelihood. Above it,
+	// a value over the cut-off and no greater than the full sum is given.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector;
+	SetEvent(maximisation,testPointsVector);
+	vector<float> vertexVector = {160,40,-30,10,0};
+	float nll = maximisation.FindTestPointLikelihood(vertexVector,false);
+	EXPECT_EQ(maximisation.FindTestPointLikelihood(vertexVector,false,nll+1),nll);
+	float bound = maximisation.FindTestPointLikelihood(vertexVector,false,0.5*nll);
+	EXPECT_GT(bound,0.5*nll);
+	EXPECT_LE(bound,nll);
+
+}
+
+TEST(MaximisationTest,TestSearchShells){
+
+	// A shell search around a point 40 cm from the true vertex moves the
+	// best point towards it.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = {{140,0,0}};
+	SetEvent(maximisation,testPointsVector);
+	maximisation.FindNegativeLogLikelihoods(0);
+	maximisation.Skim(0,1);
+	vector<vector<float>> startPointsVector;
+	maximisation.GetTestPoints(startPointsVector);
+
+	maximisation.SearchShells(FitResult::sCoarseStage,libConstants::sCoarseRmax,libConstants::sFineDlike,libConstants::sFineSkimFraction,libConstants::sFineRmax);
+	maximisation.GetTestPoints(testPointsVector);
+	ASSERT_GT(maximisation.NTestPoints(),0);
+	EXPECT_LT(testPointsVector[0][Maximisation::sNLLIndex],startPointsVector[0][Maximisation::sNLLIndex]);
+	EXPECT_LT(fabs(testPointsVector[0][0]-100),40);
+
+}
+
+
+TEST(MaximisationTest,TestMergeBasins){
+
+	// Going through the sorted survivors, only the best point within the
+	// radius of each basin is kept, in order.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = {
+		{0,0,0,10,1},
+		{10,0,0,10,2},
+		{100,0,0,10,3},
+		{0,20,0,10,4},
+		{105,0,0,10,5},
+		{-200,0,0,10,6}};
+	maximisation.SetTestPoints(testPointsVector);
+	maximisation.MergeBasins(30);
+	maximisation.GetTestPoints(testPointsVector);
+	ASSERT_EQ(maximisation.NTestPoints(),3);
+	EXPECT_EQ(testPointsVector[0][Maximisation::sNLLIndex],1);
+	EXPECT_EQ(testPointsVector[1][Maximisation::sNLLIndex],3);
+	EXPECT_EQ(testPointsVector[2][Maximisation::sNLLIndex],6);
+
+}
+
+
+TEST(MaximisationTest,TestHasConverged){
+
+	// The fit has converged once the best point moves less than 
+	// sConvergenceDistance and improves by less than sConvergenceNLL.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = {{100,0,0,10,50}};
+	maximisation.SetTestPoints(testPointsVector);
+	EXPECT_FALSE(maximisation.HasConverged(FitResult::sInitialStage));
+
+	float step = 0.5*libConstants::sConvergenceDistance;
+	testPointsVector = {{100+step,0,0,10,50-0.5f*libConstants::sConvergenceNLL}};
+	maximisation.SetTestPoints(testPointsVector);
+	int stage = FitResult::sCoarseStage;
+	EXPECT_TRUE(maximisation.HasConverged(stage));
+	EXPECT_EQ(maximisation.GetFitResult().stage,stage);
+	EXPECT_EQ(maximisation.GetFitResult().converged,1);
+
+	// Moving too far, or improving too much, is not converged.
+	testPointsVector = {{100+step,4*step,0,10,50}};
+	maximisation.SetTestPoints(testPointsVector);
+	EXPECT_FALSE(maximisation.HasConverged(FitResult::sFineStage));
+	testPointsVector = {{100+step,4*step,0,10,50-2*libConstants::sConvergenceNLL}};
+	maximisation.SetTestPoints(testPointsVector);
+	EXPECT_FALSE(maximisation.HasConverged(FitResult::sFinalStage));
+	EXPECT_EQ(maximisation.GetFitResult().converged,0);
+
+}
+
+
+TEST(MaximisationTest,TestDeadline){
+
+	// Once the deadline has passed, the likelihood loop stops at its next
+	// check, keeping the points evaluated so far.
+	Maximisation maximisation;
+	vector<vector<float>> testPointsVector = GridTestPoints();
+	SetEvent(maximisation,testPointsVector);
+	Deadline deadline;
+	deadline.Start(1e-3);
+	this_thread::sleep_for(chrono::milliseconds(1));
+	maximisation.SetDeadline(deadline);
+	maximisation.FindNegativeLogLikelihoods(0);
+	EXPECT_EQ(maximisation.NTestPoints(),libConstants::sDeadlineCheckInterval);
+	EXPECT_EQ(maximisation.GetFitResult().truncated,1);
+
+}
+
+
+TEST(MaximisationTest,TestEnergyEstimator){
+
+	// At the fitted vertex every hit of the event is in the energy window,
+	// and each counts at least once in N_eff after its corrections. The 
+	// final pass does not change the likelihood of the vertex.
+	Maximisation maximisation;
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeHits({100,0,0},60,hitInfoVector);
+	maximisation.SetTimeResidualPDF(pdf);
+	vector<vector<float>> testPointsVector = {{0,0,0},{200,100,0},{-100,-100,100},{120,-20,10}};
+	maximisation.Maximise(hitInfoVector,400*400,400,testPointsVector);
+
+	FitResult& fitResult = maximisation.GetFitResult();
+	EXPECT_NEAR(fitResult.x,100,5);
+	EXPECT_NEAR(fitResult.y,0,5);
+	EXPECT_NEAR(fitResult.z,0,5);
+	EXPECT_EQ(fitResult.nWindowHits,60);
+	EXPECT_GE(fitResult.nEffective,60);
+	EXPECT_LT(fitResult.nEffective,60/libConstants::sMinimumCosIncidence);
+
+	vector<float> vertexVector = {fitResult.x,fitResult.y,fitResult.z,fitResult.t0,0};
+	float nll = maximisation.FindTestPointLikelihood(vertexVector,false);
+	EXPECT_EQ(maximisation.EvaluateFinalVertex(vertexVector),nll);
+
+	// With an attenuation length of 10 m, each hit 400 to 600 cm from the
+	// vertex counts exp(0.4) to exp(0.6) times as much.
+	float nEffective = fitResult.nEffective;
+	maximisation.SetAttenuationLength(1000);
+	testPointsVector = {{0,0,0},{200,100,0},{-100,-100,100},{120,-20,10}};
+	maximisation.Maximise(hitInfoVector,400*400,400,testPointsVector);
+	EXPECT_GT(maximisation.GetFitResult().nEffective,nEffective*exp(0.4));
+	EXPECT_LT(maximisation.GetFitResult().nEffective,nEffective*exp(0.6));
+
+}
+
+
+TEST(MaximisationTest,TestFinalDirection){
+
+	// The goodness and direction of the fit come from the final pass, also
+	// when the angle is not used in the likelihood.
+	Maximisation maximisation;
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeRingHits(hitInfoVector);
+	maximisation.SetTimeResidualPDF(pdf);
+	maximisation.SetLikelihoodOptions(false,false,true);
+	vector<vector<float>> testPointsVector = {{0,0,0},{50,0,0},{0,-80,40}};
+	maximisation.Maximise(hitInfoVector,400*400,400,testPointsVector);
+
+	FitResult& fitResult = maximisation.GetFitResult();
+	EXPECT_NEAR(fitResult.x,0,5);
+	EXPECT_NEAR(fitResult.y,0,5);
+	EXPECT_GT(fitResult.goodness,0.95);
+	EXPECT_LE(fitResult.goodness,1);
+	EXPECT_NEAR(fitResult.dirz,1,0.01);
+	EXPECT_NEAR(fitResult.theta,0,0.15);
+	EXPECT_NEAR(fitResult.cosCone,0.9,0.05);
+	EXPECT_GT(fitResult.dirGoodness,0.5);
+
+}
+
+
+TEST(MaximisationTest,TestNoisePDF){
+
+	// A hit 25 ns late costs much less once dark noise (20% of the hits)
+	// is added to the time pdf.
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeHits({100,0,0},60,hitInfoVector);
+	HitInfo lateHit = hitInfoVector[0];
+	lateHit.time += 25;
+	vector<HitInfo> lateHitInfoVector = hitInfoVector;
+	lateHitInfoVector.push_back(lateHit);
+	float noiseRate = 0.2*lateHitInfoVector.size()/(pdf.MaximumResidual()-pdf.MinimumResidual());
+
+	vector<float> lateCostVector;
+	for (float rate : {0.f, noiseRate})
+	{
+		Maximisation maximisation;
+		maximisation.SetTimeResidualPDF(pdf);
+		maximisation.SetLikelihoodOptions(false,false,true);
+		maximisation.SetNoiseRate(rate);
+		maximisation.SetHits(lateHitInfoVector);
+		maximisation.SetNoisePDF();
+		vector<float> vertexVector = {100,0,0,10,0};
+		float nll = maximisation.FindTestPointLikelihood(vertexVector,false);
+		maximisation.SetHits(hitInfoVector);
+		lateCostVector.push_back(nll - maximisation.FindTestPointLikelihood(vertexVector,false));
+	}
+	EXPECT_NEAR(lateCostVector[0],-log(pdf.BinContent(pdf.FindBin(25))),0.1);
+	EXPECT_NEAR(lateCostVector[1],-log(0.8*pdf.BinContent(pdf.FindBin(25))+0.2/40),0.1);
+	EXPECT_LT(lateCostVector[1],lateCostVector[0]-2);
+
+}
+
+TEST(MaximisationTest,TestNoisePDFOrder){
+
+	// The pdf of an event depends only on its own noise level, not on
+	// that of the event fitted before it.
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	vector<HitInfo> hitInfoVector;
+	MakeHits({100,0,0},60,hitInfoVector);
+	vector<float> vertexVector = {100,0,0,10,0};
+	vector<float> nllVector;
+	for (float previousRate : {0.f, 0.295f, 0.305f, 1.f})
+	{
+		Maximisation maximisation;
+		maximisation.SetTimeResidualPDF(pdf);
+		maximisation.SetHits(hitInfoVector);
+		maximisation.SetNoiseRate(previousRate);
+		maximisation.SetNoisePDF();
+		maximisation.SetNoiseRate(0.3);
+		maximisation.SetNoisePDF();
+		nllVector.push_back(maximisation.FindTestPointLikelihood(vertexVector,false));
+	}
+	for (float nll : nllVector)
+	{
+		EXPECT_EQ(nll,nllVector[0]);
+	}
+
+}
+
+TEST(MaximisationTest,TestNoiseRateFromHits){
+
+	// 20 noise hits 50 ns apart over 1 us and 40 signal hits within
+	// 500 to 520 ns. Only the hits outside the signal window count.
+	vector<float> timesAll;
+	for (int hit = 0; hit < 20; hit++)
+	{
+		timesAll.push_back(hit*50 + 10);
+	}
+	for (int hit = 0; hit < 40; hit++)
+	{
+		timesAll.push_back(500 + hit*0.5);
+	}
+	float timeWindow = 960 - 10;
+	EXPECT_NEAR(Maximisation::NoiseRateFromHits(timesAll,480,560),18/(timeWindow-80),1e-6);
+	EXPECT_EQ(Maximisation::NoiseRateFromHits(timesAll,0,1000),0);
+
+}
+
+}
@@ -0,0 +1,76 @@
+/**************************************************
+ * Stores the time-residual pdf as a table of negative
+ * log likelihoods for lookup during the search.
+ * Inputs: bin contents and range of a binned pdf
+ * 		   (e.g. taken from a ROOT histogram by the caller).
+ * Outputs: -log(p) and d(-log p)/dt for a time residual.
+ *
+ * *************************************************/
+#include <iostream>
+#include <math.h>
+#include <numeric> //accumulate()
+#include <algorithm> //min_element()
+
+#include <libconstants.hpp>
+#include <libpdf.hpp>
+
+//constructor function
+TimeResidualPDF::TimeResidualPDF()
+{
+	// Start with a single flat bin so that lookups are always valid.
+	vector<float> flatVector = {1.};
+	SetPDF(flatVector, -1., 1.);
+}
+
+//destructor function
+TimeResidualPDF::~TimeResidualPDF()
+{
+}
+
+void TimeResidualPDF::SetPDF(vector<float>& probabilityVector, float tMin, float tMax)
+{
+	mNBins = probabilityVector.size();
+	mTMin = tMin;
+	mBinWidth = (tMax - tMin)/mNBins;
+	mInverseBinWidth = 1./mBinWidth;
+
+	// Normalise the pdf and take the negative log of each bin. Empty bins
+	// are set to the minimum probability so that the log is defined.
+	float integral = accumulate(probabilityVector.begin(), probabilityVector.end(), 0.0);
+	mProbabilityVector.resize(mNBins);
+	mNLLVector.resize(mNBins);
+	for (int bin = 0; bin < mNBins; bin++)
+	{
+		float probability = probabilityVector[bin]/(integral*mBinWidth);
+		if (integral <= 0 || probability < libConstants::sMinimumProbabilityPDF)
+		{
+			probability = libConstants::sMinimumProbabilityPDF;
+		}
+		mProbabilityVector[bin] = probability;
+		mNLLVector[bin] = -log(probability);
+	}
+	mMinimumNLL = *min_element(mNLLVector.begin(), mNLLVector.end());
+}
+
+void TimeResidualPDF::SetNoisyPDF(TimeResidualPDF& signalPDF, float noiseFraction)
+{
+	mNBins = signalPDF.mNBins;
+	mTMin = signalPDF.mTMin;
+	mBinWidth = signalPDF.mBinWidth;
+	mInverseBinWidth = signalPDF.mInverseBinWidth;
+
+	float noiseProbability = noiseFraction/(mNBins*mBinWidth);
+	mProbabilityVector.resize(mNBins);
+	mNLLVector.resize(mNBins);
+	for (int bin = 0; bin < mNBins; bin++)
+	{
+		float probability = (1 - noiseFraction)*signalPDF.mProbabilityVector[bin] + noiseProbability;
+		if (probability < libConstants::sMinimumProbabilityPDF)
+		{
+			probability = libConstants::sMinimumProbabilityPDF;
+		}
+		mProbabilityVector[bin] = probability;
+		mNLLVector[bin] = -log(probability);
+	}
+	mMinimumNLL = *min_element(mNLLVector.begin(), mNLLVector.end());
+}
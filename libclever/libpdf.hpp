@@ -0,0 +1,121 @@
+#ifndef LIBPDF_H
+#define LIBPDF_H
+
+//includes
+#include <vector>
+
+using namespace std;
+
+/*
+ * class TimeResidualPDF
+ * Stores the time-residual probability density function as a table of
+ * negative log likelihoods so that the likelihood (and its derivative with
+ * respect to the time residual) can be looked up without ROOT during the
+ * search.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class TimeResidualPDF
+{
+
+
+	// define the public functions and variables
+	public:
+
+		TimeResidualPDF();
+		~TimeResidualPDF();
+
+		// Fill the table from the bin contents of a binned pdf covering
+		// the time residual range [tMin, tMax).
+		void SetPDF(vector<float>& probabilityVector, float tMin, float tMax);
+
+		// Fill the table from a signal pdf with a fraction of the hits 
+		// coming from dark noise, which is flat over the time range:
+		// p = (1 - noiseFraction)*p_signal + noiseFraction/range.
+		void SetNoisyPDF(TimeResidualPDF& signalPDF, float noiseFraction);
+
+		// Negative log likelihood for a time residual, interpolated linearly
+		// between bin centres. Residuals outside the range take the value of
+		// the nearest edge bin.
+		inline float NegativeLogLikelihood(float residual)
+		{
+			float position = (residual - mTMin)*mInverseBinWidth - 0.5;
+			if (position <= 0)
+			{
+				return(mNLLVector[0]);
+			}
+			if (position >= mNBins-1)
+			{
+				return(mNLLVector[mNBins-1]);
+			}
+			int bin = (int)position;
+			float fraction = position - bin;
+			return(mNLLVector[bin] + fraction*(mNLLVector[bin+1]-mNLLVector[bin]));
+		}
+
+		// Negative log likelihood of the bin containing the residual, without
+		// interpolation.
+		inline float NegativeLogLikelihoodBinned(float residual)
+		{
+			int bin = (int)((residual - mTMin)*mInverseBinWidth);
+			bin = (bin < 0) ? 0 : ((bin >= mNBins) ? mNBins-1 : bin);
+			return(mNLLVector[bin]);
+		}
+
+		// Derivative of NegativeLogLikelihood with respect to the residual,
+		// i.e. the slope of the interpolated segment (zero outside range).
+		inline float NegativeLogLikelihoodDerivative(float residual)
+		{
+			float position = (residual - mTMin)*mInverseBinWidth - 0.5;
+			if (position <= 0 || position >= mNBins-1)
+			{
+				return(0);
+			}
+			int bin = (int)position;
+			return((mNLLVector[bin+1]-mNLLVector[bin])*mInverseBinWidth);
+		}
+
+		inline float MinimumResidual(void){
+			return(mTMin);
+		}
+
+		inline float MaximumResidual(void){
+			return(mTMin + mNBins*mBinWidth);
+		}
+
+		inline float BinContent(int bin){
+			return(mProbabilityVector[bin]);
+		}
+
+		inline int FindBin(float residual){
+			return((int)((residual - mTMin)*mInverseBinWidth));
+		}
+
+		inline int NBins(void){
+			return(mNBins);
+		}
+
+		// Smallest negative log likelihood in the table, i.e. a lower bound
+		// on the contribution of any hit.
+		inline float MinimumNegativeLogLikelihood(void){
+			return(mMinimumNLL);
+		}
+
+	// define the private functions and variables
+	private:
+
+		int mNBins;
+		float mTMin;
+		float mBinWidth;
+		float mInverseBinWidth;
+		float mMinimumNLL;
+		vector<float> mProbabilityVector; // normalised bin contents
+		vector<float> mNLLVector; // -log(probability) per bin
+
+};
+
+#endif
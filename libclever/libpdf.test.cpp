@@ -0,0 +1,80 @@
+/**************************************************
+ * Unit tests for TimeResidualPDF class
+ *
+ * *************************************************/
+
+#include <libpdf.hpp>
+#include <libconstants.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+namespace{
+
+TEST(PDFTest,TestSetPDF){
+
+	// Flat pdf over 10 ns: p = 0.1 per ns in every bin.
+	vector<float> contents = {1,1,1,1,1,1,1,1,1,1};
+	TimeResidualPDF pdf;
+	pdf.SetPDF(contents,0,10);
+
+	EXPECT_EQ(pdf.NBins(),10);
+	EXPECT_NEAR(pdf.BinContent(3),0.1,1e-6);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(4.2),-log(0.1),1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihoodDerivative(4.2),0,1e-6);
+
+}
+
+TEST(PDFTest,TestInterpolation){
+
+	// Two bins with probabilities 0.25 and 0.75 (per ns, bin width 1 ns).
+	vector<float> contents = {1,3};
+	TimeResidualPDF pdf;
+	pdf.SetPDF(contents,0,2);
+
+	float nll0 = -log(0.25);
+	float nll1 = -log(0.75);
+	// Values at the bin centres and halfway between them.
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(0.5),nll0,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(1.5),nll1,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(1.0),0.5*(nll0+nll1),1e-5);
+	EXPECT_NEAR(pdf.MinimumNegativeLogLikelihood(),nll1,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihoodDerivative(1.0),nll1-nll0,1e-5);
+	// Outside the range the edge values are used.
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(-5),nll0,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(5),nll1,1e-5);
+
+}
+
+TEST(PDFTest,TestEmptyBins){
+
+	vector<float> contents = {0,1};
+	TimeResidualPDF pdf;
+	pdf.SetPDF(contents,0,2);
+
+	EXPECT_NEAR(pdf.BinContent(0),libConstants::sMinimumProbabilityPDF,1e-9);
+	EXPECT_TRUE(std::isfinite(pdf.NegativeLogLikelihood(0.5)));
+
+}
+
+TEST(PDFTest,TestNoisyPDF){
+
+	// Signal only in the first of four 1 ns bins, with 20% flat noise.
+	vector<float> contents = {1,0,0,0};
+	TimeResidualPDF signalPDF;
+	signalPDF.SetPDF(contents,0,4);
+	TimeResidualPDF pdf;
+	pdf.SetNoisyPDF(signalPDF,0.2);
+
+	EXPECT_EQ(pdf.NBins(),4);
+	EXPECT_NEAR(pdf.BinContent(0),0.8+0.05,1e-5);
+	EXPECT_NEAR(pdf.BinContent(3),0.05,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihoodBinned(3.5),-log(0.05),1e-4);
+
+	// Without noise the signal pdf is unchanged.
+	pdf.SetNoisyPDF(signalPDF,0);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(0.5),signalPDF.NegativeLogLikelihood(0.5),1e-6);
+
+}
+
+}
@@ -0,0 +1,218 @@
+/**************************************************
+ * Runs the reconstruction steps for one event:
+ * hit selection, test point calculation and the
+ * maximum likelihood fit.
+ * Inputs: event hits, detector geometry, pdf
+ * Outputs: fit result for the event
+ *
+ * *************************************************/
+#include <iostream>
+#include <algorithm>
+
+#include <libconstants.hpp>
+#include <libreconstructioncontext.hpp>
+
+//constructor function
+ReconstructionContext::ReconstructionContext(Geometry& geometry, TimeResidualPDF& timeResidualPDF)
+{
+	// Set the detector limits from the geometry.
+	mTraverseTMax = geometry.max_traverse_time();
+	mDTMax = geometry.max_pmt_deltaT();
+	mDRMax = geometry.max_pmt_deltaR();
+	float rmax = geometry.search_radius();
+	mRMax2 = rmax*rmax;
+	mZMax = geometry.search_height();
+
+	mTimeResidualPDF = &timeResidualPDF;
+	mMaximisation.SetTimeResidualPDF(timeResidualPDF);
+	mMaximisation.SetAttenuationLength(geometry.attenuation_length());
+	mEventTimeBudget = libConstants::sEventTimeBudget;
+	mBatchSeeds = libConstants::sBatchSeeds;
+}
+
+//destructor function
+ReconstructionContext::~ReconstructionContext()
+{
+}
+
+void ReconstructionContext::SetTimeChargePDF(TimeChargePDF& timeChargePDF)
+{
+	mMaximisation.SetTimeChargePDF(timeChargePDF);
+	mMaximisation.SetLikelihoodOptions(true, libConstants::sUseAngle, libConstants::sInterpolatePDF);
+}
+
+void ReconstructionContext::SetEventTimeBudget(float budgetMilliseconds)
+{
+	mEventTimeBudget = budgetMilliseconds;
+}
+
+void ReconstructionContext::SetBatchSeeds(int nSeeds)
+{
+	mBatchSeeds = nSeeds;
+}
+
+void ReconstructionContext::SetScheduler(TaskScheduler& scheduler, int worker)
+{
+	mHitSelect.SetScheduler(&scheduler, worker);
+	mTestPointCalc.SetScheduler(&scheduler, worker);
+	mMaximisation.SetScheduler(&scheduler, worker);
+}
+
+int ReconstructionContext::Reconstruct(EventHits& eventHits, FitResult& fitResult)
+{
+	// Start the clock for this event. With a time budget, each stage scales
+	// down its work as the budget runs out.
+	mDeadline.Start(mEventTimeBudget);
+
+	int nselected = FindTestPoints(eventHits, fitResult, mHitInfoVector, mTestPointsVector);
+	if (nselected < 0)
+	{
+		return(-1);
+	}
+	return(Fit(eventHits, fitResult, mHitInfoVector, mTestPointsVector));
+}
+
+int ReconstructionContext::ReconstructBatch(vector<EventHits>& eventsVector, int nEvents, vector<FitResult>& fitResultsVector, vector<int>& nSelectedVector)
+{
+	fitResultsVector.resize(nEvents);
+	nSelectedVector.assign(nEvents, -1);
+	int nReconstructed = 0;
+	if (mBatchSeeds <= 0)
+	{
+		for (int iEvent = 0; iEvent < nEvents; iEvent++)
+		{
+			nSelectedVector[iEvent] = Reconstruct(eventsVector[iEvent], fitResultsVector[iEvent]);
+			if (nSelectedVector[iEvent] >= 0)
+			{
+				nReconstructed++;
+			}
+		}
+		return(nReconstructed);
+	}
+
+	if ((int)mBatchHitInfo.size() < nEvents)
+	{
+		mBatchHitInfo.resize(nEvents);
+		mBatchTestPoints.resize(nEvents);
+	}
+	mBatchLanes.assign(nEvents, -1);
+	mEventBatch.Clear();
+
+	// Select the hits and find the initial test points of every event.
+	// Large events fill the likelihood loops on their own, and events with
+	// no more test points than seeds have nothing to rank, so both are
+	// fitted straight away.
+	for (int iEvent = 0; iEvent < nEvents; iEvent++)
+	{
+		mDeadline.Start(mEventTimeBudget);
+		int nselected = FindTestPoints(eventsVector[iEvent], fitResultsVector[iEvent], mBatchHitInfo[iEvent], mBatchTestPoints[iEvent]);
+		if (nselected < 0)
+		{
+			continue;
+		}
+		if (nselected > libConstants::sBatchMaximumHits || (int)mBatchTestPoints[iEvent].size() <= mBatchSeeds)
+		{
+			nSelectedVector[iEvent] = Fit(eventsVector[iEvent], fitResultsVector[iEvent], mBatchHitInfo[iEvent], mBatchTestPoints[iEvent]);
+			nReconstructed++;
+			continue;
+		}
+		mBatchLanes[iEvent] = mEventBatch.AddEvent(mBatchHitInfo[iEvent], mBatchTestPoints[iEvent]);
+	}
+	if (mEventBatch.NEvents() == 0)
+	{
+		return(nReconstructed);
+	}
+
+	// Evaluate the initial test points of the small events together and
+	// share the time taken between them.
+	mDeadline.Start(0);
+	mEventBatch.FindSeedLikelihoods(*mTimeResidualPDF);
+	float batchTime = mDeadline.ElapsedMilliseconds()/mEventBatch.NEvents();
+
+	// Search from the best seeds of each small event, with the time already
+	// spent on it taken from its budget.
+	for (int iEvent = 0; iEvent < nEvents; iEvent++)
+	{
+		if (mBatchLanes[iEvent] < 0)
+		{
+			continue;
+		}
+		mEventBatch.GetBestSeeds(mBatchLanes[iEvent], mBatchSeeds, mBatchTestPoints[iEvent]);
+		FitResult& fitResult = fitResultsVector[iEvent];
+		fitResult.testPointTime += batchTime;
+		mDeadline.Start(mEventTimeBudget, fitResult.selectTime + fitResult.testPointTime);
+		nSelectedVector[iEvent] = Fit(eventsVector[iEvent], fitResultsVector[iEvent], mBatchHitInfo[iEvent], mBatchTestPoints[iEvent]);
+		nReconstructed++;
+	}
+
+	return(nReconstructed);
+}
+
+int ReconstructionContext::FindTestPoints(EventHits& eventHits, FitResult& fitResult, vector<HitInfo>& hitInfoVector, vector<vector<float>>& testPointsVector)
+{
+	fitResult = FitResult();
+	fitResult.event = eventHits.event;
+	fitResult.subEvent = eventHits.subEvent;
+	fitResult.nHits = eventHits.nhits();
+
+	// Select the hits which will be used to calculate starting points (initial
+	// test vertices) for the search.
+	hitInfoVector.clear();
+	mHitSelect.SetDeadline(mDeadline);
+	int nselected = mHitSelect.SelectHits(eventHits.nhits(), eventHits.times, eventHits.charges, eventHits.pmtx, eventHits.pmty, eventHits.pmtz, hitInfoVector, mTraverseTMax, mDTMax, mDRMax);
+	fitResult.nSelected = nselected;
+	fitResult.selectTime = mDeadline.ElapsedMilliseconds();
+
+	// Make sure at least 4 hits have made the final selection.
+	if (nselected < libConstants::sSelectedHitThreshold)
+	{
+		return(-1);
+	}
+
+	// Calculate the initial test vertices for the search.
+	testPointsVector.clear();
+	mTestPointCalc.SetDeadline(mDeadline);
+	float stepStart = mDeadline.ElapsedMilliseconds();
+	mTestPointCalc.CalculateTestPoints(hitInfoVector, mRMax2, mZMax, testPointsVector);
+	fitResult.testPointTime = mDeadline.ElapsedMilliseconds() - stepStart;
+	fitResult.truncated |= mHitSelect.IsTruncated() | mTestPointCalc.IsTruncated();
+	if (testPointsVector.empty())
+	{
+		return(-1);
+	}
+
+	return(nselected);
+}
+
+int ReconstructionContext::Fit(EventHits& eventHits, FitResult& fitResult, vector<HitInfo>& hitInfoVector, vector<vector<float>>& testPointsVector)
+{
+	// Perform the maximum likelihood fit starting from the test points. The
+	// hits too early or too late to be light from the selected hits' vertex
+	// give the dark noise level of the event.
+	int nselected = fitResult.nSelected;
+	mMaximisation.SetDeadline(mDeadline);
+	auto selectedRange = minmax_element(hitInfoVector.begin(), hitInfoVector.end(), [] (HitInfo& hit1, HitInfo& hit2)
+	{
+		return(hit1.time < hit2.time);
+	});
+	float signalStart = selectedRange.first->time - mTraverseTMax + mTimeResidualPDF->MinimumResidual();
+	float signalEnd = selectedRange.second->time + mTraverseTMax + mTimeResidualPDF->MaximumResidual();
+	mMaximisation.SetNoiseRate(Maximisation::NoiseRateFromHits(eventHits.times, signalStart, signalEnd));
+	float stepStart = mDeadline.ElapsedMilliseconds();
+	mMaximisation.Maximise(hitInfoVector, mRMax2, mZMax, testPointsVector);
+	float maximiseTime = mDeadline.ElapsedMilliseconds() - stepStart;
+
+	// Get the vertex and additional variables.
+	FitResult eventInfo = fitResult;
+	fitResult = mMaximisation.GetFitResult();
+	fitResult.event = eventInfo.event;
+	fitResult.subEvent = eventInfo.subEvent;
+	fitResult.nHits = eventInfo.nHits;
+	fitResult.nSelected = nselected;
+	fitResult.selectTime = eventInfo.selectTime;
+	fitResult.testPointTime = eventInfo.testPointTime;
+	fitResult.maximiseTime = maximiseTime;
+	fitResult.truncated |= eventInfo.truncated;
+
+	return(nselected);
+}
@@ -0,0 +1,114 @@
+#ifndef LIBRECONSTRUCTIONCONTEXT_H
+#define LIBRECONSTRUCTIONCONTEXT_H
+
+//includes
+#include <vector>
+#include <libeventhits.hpp>
+#include <libfitresult.hpp>
+#include <libgeometry.hpp>
+#include <libpdf.hpp>
+#include <libtimechargepdf.hpp>
+#include <libdeadline.hpp>
+#include <libhitselect.hpp>
+#include <libtestpointcalc.hpp>
+#include <libmaximisation.hpp>
+#include <libeventbatch.hpp>
+
+using namespace std;
+
+/*
+ * class ReconstructionContext
+ * Holds everything needed to reconstruct events on one thread: the 
+ * detector limits, the pdfs and the hit selection, test point and 
+ * maximisation stages with their workspaces. It is built once from the
+ * geometry and pdfs (with the settings from libConstants unless changed)
+ * and then reused for every event, so that Reconstruct does not construct
+ * any of the stages again. A context is not shared between threads: each
+ * worker thread uses its own.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class ReconstructionContext
+{
+
+
+	// define the public functions and variables
+	public:
+
+		ReconstructionContext(Geometry& geometry, TimeResidualPDF& timeResidualPDF);
+		~ReconstructionContext();
+
+		// Use the time-charge pdf in the likelihood instead of the 
+		// time-residual pdf alone.
+		void SetTimeChargePDF(TimeChargePDF& timeChargePDF);
+
+		// Wall-clock budget per event in ms (0 = none).
+		void SetEventTimeBudget(float budgetMilliseconds);
+
+		// Initial test points kept for each small event of a batch (0 = all,
+		// so ReconstructBatch does the same as Reconstruct).
+		void SetBatchSeeds(int nSeeds);
+
+		// Share the loops of large events with the other workers of the 
+		// scheduler; this context is used by the given worker only.
+		void SetScheduler(TaskScheduler& scheduler, int worker);
+
+		// Main function called from outside class.
+		// Reconstructs the event and fills the result. Returns the number
+		// of selected hits, or -1 if the event could not be reconstructed.
+		int Reconstruct(EventHits& eventHits, FitResult& fitResult);
+
+		// Reconstructs the first nEvents events. Without batch seeds each
+		// event is reconstructed by Reconstruct. With them, the initial test
+		// points of the events with at most sBatchMaximumHits selected hits
+		// and more test points than seeds are evaluated in lock-step (see
+		// EventBatch) and only the best of each are searched; the other
+		// events are reconstructed as by Reconstruct. The seeds are ranked
+		// by an approximate likelihood (time residuals only, with t0 from a
+		// mean shift), so a ranked event can end in a different basin than
+		// with Reconstruct. The time of the ranking is shared between the
+		// ranked events and counted against their budgets.
+		// Fills a result and the return value of Reconstruct for each
+		// event, and returns the number reconstructed.
+		int ReconstructBatch(vector<EventHits>& eventsVector, int nEvents, vector<FitResult>& fitResultsVector, vector<int>& nSelectedVector);
+
+	// define the private functions and variables
+	private:
+
+		// The two halves of Reconstruct: select the hits and calculate the
+		// initial test points (returns the number of selected hits, or -1),
+		// then run the maximum likelihood fit from the test points.
+		int FindTestPoints(EventHits& eventHits, FitResult& fitResult, vector<HitInfo>& hitInfoVector, vector<vector<float>>& testPointsVector);
+		int Fit(EventHits& eventHits, FitResult& fitResult, vector<HitInfo>& hitInfoVector, vector<vector<float>>& testPointsVector);
+
+		float mTraverseTMax;
+		float mDTMax;
+		float mDRMax;
+		float mRMax2;
+		float mZMax;
+		float mEventTimeBudget;
+		int mBatchSeeds;
+		Deadline mDeadline;
+		TimeResidualPDF* mTimeResidualPDF;
+
+		HitSelect mHitSelect;
+		TestPointCalc mTestPointCalc;
+		Maximisation mMaximisation;
+
+		// Per-event buffers, kept to avoid reallocation.
+		vector<HitInfo> mHitInfoVector;
+		vector<vector<float>> mTestPointsVector;
+
+		// Per-event buffers of a batch, one set per event in the batch.
+		EventBatch mEventBatch;
+		vector<vector<HitInfo>> mBatchHitInfo;
+		vector<vector<vector<float>>> mBatchTestPoints;
+		vector<int> mBatchLanes;
+
+};
+
+#endif
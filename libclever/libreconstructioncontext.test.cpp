@@ -0,0 +1,106 @@
+/**************************************************
+ * Unit tests for ReconstructionContext class
+ *
+ * *************************************************/
+
+#include <libreconstructioncontext.hpp>
+#include <libconstants.hpp>
+#include <libtesthelpers.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+namespace{
+
+// PMTs spread evenly over a 500 cm sphere around the origin.
+void MakeGeometry(Geometry& geometry, vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz){
+
+	int nPMTs = 1000;
+	for (int iPMT = 0; iPMT < nPMTs; iPMT++)
+	{
+		float cosTheta = -1 + 2*(iPMT+0.5)/nPMTs;
+		float sinTheta = sqrt(1 - cosTheta*cosTheta);
+		float phi = iPMT*2.39996;
+		pmtx.push_back(500*sinTheta*cos(phi));
+		pmty.push_back(500*sinTheta*sin(phi));
+		pmtz.push_back(500*cosTheta);
+	}
+	geometry.SetGeometry(nPMTs,pmtx,pmty,pmtz);
+
+}
+
+// An event of nHits hits on every stride-th PMT from light emitted at the
+// vertex at time 100 ns, with a spread of up to +-1.5 ns in the times.
+EventHits MakeEvent(int event, vector<float> vertex, int nHits, int stride, vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz){
+
+	EventHits eventHits(event,0);
+	for (int iHit = 0; iHit < nHits; iHit++)
+	{
+		int iPMT = (event*7 + iHit*stride) % pmtx.size();
+		float dx = pmtx[iPMT]-vertex[0], dy = pmty[iPMT]-vertex[1], dz = pmtz[iPMT]-vertex[2];
+		float jitter = 1.5*sin(iHit*12.9898 + event);
+		eventHits.add_hit(100 + sqrt(dx*dx+dy*dy+dz*dz)/libConstants::sCmPerNs + jitter,1,pmtx[iPMT],pmty[iPMT],pmtz[iPMT]);
+	}
+	return(eventHits);
+
+}
+
+TEST(ReconstructionContextTest,TestReconstructBatch){
+
+	// Without batch seeds (the default) each event is reconstructed as by
+	// Reconstruct. With them, the batch keeps only the seeds with the best
+	// approximate likelihood (time residuals only, with t0 from a mean
+	// shift), so its vertices may differ from those of Reconstruct, but
+	// only by a little.
+	TimeResidualPDF pdf;
+	MakePDF(pdf);
+	Geometry geometry;
+	vector<float> pmtx, pmty, pmtz;
+	MakeGeometry(geometry,pmtx,pmty,pmtz);
+
+	vector<vector<float>> vertexVector = {{100,0,0},{0,-200,50},{-150,100,-100},{50,50,200},{0,0,0},{-250,-50,0}};
+	vector<EventHits> eventsVector;
+	for (unsigned int iEvent = 0; iEvent < vertexVector.size(); iEvent++)
+	{
+		eventsVector.push_back(MakeEvent(iEvent,vertexVector[iEvent],30+5*iEvent,37,pmtx,pmty,pmtz));
+	}
+	// One event with many more initial test points than sBatchSeeds.
+	eventsVector.push_back(MakeEvent(6,{-100,-100,100},100,13,pmtx,pmty,pmtz));
+	int nEvents = eventsVector.size();
+
+	ReconstructionContext allContext(geometry,pdf);
+	vector<FitResult> allResultsVector;
+	vector<int> nAllSelectedVector;
+	EXPECT_EQ(allContext.ReconstructBatch(eventsVector,nEvents,allResultsVector,nAllSelectedVector),nEvents);
+
+	ReconstructionContext batchContext(geometry,pdf);
+	batchContext.SetBatchSeeds(32);
+	vector<FitResult> batchResultsVector;
+	vector<int> nSelectedVector;
+	EXPECT_EQ(batchContext.ReconstructBatch(eventsVector,nEvents,batchResultsVector,nSelectedVector),nEvents);
+
+	ReconstructionContext context(geometry,pdf);
+	for (int iEvent = 0; iEvent < nEvents; iEvent++)
+	{
+		FitResult fitResult;
+		int nselected = context.Reconstruct(eventsVector[iEvent],fitResult);
+		ASSERT_GE(nselected,libConstants::sSelectedHitThreshold);
+		EXPECT_EQ(nAllSelectedVector[iEvent],nselected);
+		EXPECT_EQ(allResultsVector[iEvent].x,fitResult.x);
+		EXPECT_EQ(allResultsVector[iEvent].y,fitResult.y);
+		EXPECT_EQ(allResultsVector[iEvent].z,fitResult.z);
+		EXPECT_EQ(allResultsVector[iEvent].t0,fitResult.t0);
+		EXPECT_EQ(allResultsVector[iEvent].nll,fitResult.nll);
+
+		EXPECT_EQ(nSelectedVector[iEvent],nselected);
+		FitResult& batchResult = batchResultsVector[iEvent];
+		EXPECT_EQ(batchResult.event,iEvent);
+		float dx = batchResult.x-fitResult.x, dy = batchResult.y-fitResult.y, dz = batchResult.z-fitResult.z;
+		EXPECT_LT(sqrt(dx*dx+dy*dy+dz*dz),10);
+		EXPECT_NEAR(batchResult.t0,fitResult.t0,0.5);
+		EXPECT_LT(batchResult.nll,fitResult.nll+1);
+	}
+
+}
+
+}
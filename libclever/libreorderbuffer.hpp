@@ -0,0 +1,92 @@
+#ifndef LIBREORDERBUFFER_H
+#define LIBREORDERBUFFER_H
+
+//includes
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+using namespace std;
+
+/*
+ * class ReorderBuffer
+ * Puts the items of a pipeline stage back in input order. Each item
+ * carries the sequence number it was given on input (see EventDispatcher)
+ * and is held in a ring of slots until all of the items before it have
+ * been taken. The ring only has room for the capacity items following
+ * the next one to be taken, so the producer must not run further ahead
+ * than that (EventDispatcher::SetMaxPending).
+ * Used by one thread (the writer) only.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+template <typename T>
+class ReorderBuffer
+{
+
+
+	// define the public functions and variables
+	public:
+
+		ReorderBuffer(size_t capacity)
+		{
+			mSlots.resize((capacity > 0) ? capacity : 1);
+			mFull.assign(mSlots.size(), false);
+			mNext = 0;
+		};
+		~ReorderBuffer() {};
+
+		// Hold the item (which is moved from) until its turn. Returns false
+		// if the sequence number is not within the capacity of the next
+		// item to be taken.
+		bool Insert(long sequence, T& item)
+		{
+			if (sequence < mNext || sequence >= mNext + (long)mSlots.size())
+			{
+				return(false);
+			}
+			size_t slot = sequence % mSlots.size();
+			mSlots[slot] = move(item);
+			mFull[slot] = true;
+			return(true);
+		}
+
+		// Take the next item in sequence. Returns false if it has not
+		// arrived yet.
+		bool TryPop(T& item)
+		{
+			size_t slot = mNext % mSlots.size();
+			if (!mFull[slot])
+			{
+				return(false);
+			}
+			item = move(mSlots[slot]);
+			mFull[slot] = false;
+			mNext++;
+			return(true);
+		}
+
+		// Sequence number of the next item to be taken, i.e. the number
+		// taken so far.
+		inline long NextSequence(void){
+			return(mNext);
+		}
+
+		inline size_t Capacity(void){
+			return(mSlots.size());
+		}
+
+	// define the private functions and variables
+	private:
+
+		vector<T> mSlots;
+		vector<bool> mFull;
+		long mNext;
+
+};
+
+#endif
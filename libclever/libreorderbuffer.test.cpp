@@ -0,0 +1,51 @@
+/**************************************************
+ * Unit tests for ReorderBuffer class
+ *
+ * *************************************************/
+
+#include <libreorderbuffer.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace{
+
+TEST(ReorderBufferTest,TestInputOrder){
+
+	// Items inserted out of order are taken in sequence, and nothing is
+	// taken while the next one is missing.
+	ReorderBuffer<int> reorderBuffer(4);
+	EXPECT_EQ(reorderBuffer.Capacity(), 4);
+	vector<long> sequenceVector = {2,0,3,1,5,4,7,6};
+	vector<int> order;
+	int item;
+	for (long sequence : sequenceVector)
+	{
+		item = (int)sequence*10;
+		EXPECT_TRUE(reorderBuffer.Insert(sequence, item));
+		while (reorderBuffer.TryPop(item))
+		{
+			order.push_back(item);
+		}
+	}
+	vector<int> order_check = {0,10,20,30,40,50,60,70};
+	EXPECT_EQ(order, order_check);
+	EXPECT_EQ(reorderBuffer.NextSequence(), 8);
+	EXPECT_FALSE(reorderBuffer.TryPop(item));
+
+}
+
+TEST(ReorderBufferTest,TestCapacity){
+
+	// Items already taken, or too far ahead of the next one, are refused.
+	ReorderBuffer<int> reorderBuffer(2);
+	int item = 1;
+	EXPECT_FALSE(reorderBuffer.Insert(2, item));
+	EXPECT_TRUE(reorderBuffer.Insert(1, item));
+	EXPECT_TRUE(reorderBuffer.Insert(0, item));
+	EXPECT_TRUE(reorderBuffer.TryPop(item));
+	EXPECT_FALSE(reorderBuffer.Insert(0, item));
+	EXPECT_TRUE(reorderBuffer.Insert(2, item));
+
+}
+
+}
@@ -0,0 +1,135 @@
+/**************************************************
+ * Writes the fit results to a columnar binary file
+ * in blocks of events.
+ * Inputs: fit result of each event
+ * Outputs: results file
+ *
+ * *************************************************/
+#include <iostream>
+#include <cstring>
+
+#include <libresultswriter.hpp>
+
+static const char sMagic[8] = {'C','L','V','R','R','S','L','T'};
+static const uint32_t sVersion = 1;
+
+const char* ResultsWriter::sIntColumnNames[sNIntColumns] = {
+	"event", "subEvent", "nHits", "nSelected", "reconstructed", 
+	"stage", "converged", "truncated", "nWindowHits"
+};
+
+const char* ResultsWriter::sFloatColumnNames[sNFloatColumns] = {
+	"x", "y", "z", "t0", "nll", "goodness", "nEffective", 
+	"dirx", "diry", "dirz", "theta", "phi", "cosCone", "dirGoodness",
+	"selectTime", "testPointTime", "maximiseTime"
+};
+
+//constructor function
+ResultsWriter::ResultsWriter(int blockSize)
+{
+	mFile = NULL;
+	mBlockSize = blockSize;
+	mNRows = 0;
+	mNWritten = 0;
+	mError = false;
+	mIntColumns.resize(sNIntColumns, vector<int32_t>(mBlockSize));
+	mFloatColumns.resize(sNFloatColumns, vector<float>(mBlockSize));
+}
+
+//destructor function
+ResultsWriter::~ResultsWriter()
+{
+	Close();
+}
+
+int ResultsWriter::Open(const char* filename)
+{
+	Close();
+	mFile = fopen(filename, "wb");
+	if (mFile == NULL)
+	{
+		return(-1);
+	}
+	mNRows = 0;
+	mNWritten = 0;
+	mError = false;
+
+	uint32_t header[4] = {sVersion, sNIntColumns, sNFloatColumns, (uint32_t)mBlockSize};
+	mError |= fwrite(sMagic, 1, sizeof(sMagic), mFile) != sizeof(sMagic);
+	mError |= fwrite(header, sizeof(uint32_t), 4, mFile) != 4;
+	char name[16];
+	for (int column = 0; column < sNIntColumns + sNFloatColumns; column++)
+	{
+		const char* columnName = (column < sNIntColumns) ? sIntColumnNames[column] : sFloatColumnNames[column-sNIntColumns];
+		memset(name, 0, sizeof(name));
+		strncpy(name, columnName, sizeof(name)-1);
+		mError |= fwrite(name, 1, sizeof(name), mFile) != sizeof(name);
+	}
+	return(mError ? -1 : 0);
+}
+
+int ResultsWriter::Add(FitResult& result, int reconstructed)
+{
+	// Without a file the block could never be written out, so it would 
+	// overflow.
+	if (mFile == NULL)
+	{
+		mError = true;
+		return(-1);
+	}
+	int32_t intValues[sNIntColumns] = {
+		result.event, result.subEvent, result.nHits, result.nSelected, reconstructed,
+		result.stage, result.converged, result.truncated, result.nWindowHits
+	};
+	float floatValues[sNFloatColumns] = {
+		result.x, result.y, result.z, result.t0, result.nll, result.goodness, result.nEffective,
+		result.dirx, result.diry, result.dirz, result.theta, result.phi, result.cosCone, result.dirGoodness,
+		result.selectTime, result.testPointTime, result.maximiseTime
+	};
+	for (int column = 0; column < sNIntColumns; column++)
+	{
+		mIntColumns[column][mNRows] = intValues[column];
+	}
+	for (int column = 0; column < sNFloatColumns; column++)
+	{
+		mFloatColumns[column][mNRows] = floatValues[column];
+	}
+	mNRows++;
+	if (mNRows == mBlockSize)
+	{
+		WriteBlock();
+	}
+	return(0);
+}
+
+void ResultsWriter::WriteBlock()
+{
+	if (mFile == NULL || mNRows == 0)
+	{
+		return;
+	}
+	uint32_t nRows = mNRows;
+	mError |= fwrite(&nRows, sizeof(nRows), 1, mFile) != 1;
+	for (auto& column : mIntColumns)
+	{
+		mError |= fwrite(column.data(), sizeof(int32_t), nRows, mFile) != nRows;
+	}
+	for (auto& column : mFloatColumns)
+	{
+		mError |= fwrite(column.data(), sizeof(float), nRows, mFile) != nRows;
+	}
+	mNWritten += mNRows;
+	mNRows = 0;
+}
+
+long ResultsWriter::Close()
+{
+	if (mFile == NULL)
+	{
+		return(mError ? -1 : mNWritten);
+	}
+	WriteBlock();
+	mError |= fclose(mFile) != 0;
+	mFile = NULL;
+	return(mError ? -1 : mNWritten);
+}
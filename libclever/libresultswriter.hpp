@@ -0,0 +1,79 @@
+#ifndef LIBRESULTSWRITER_H
+#define LIBRESULTSWRITER_H
+
+//includes
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <libconstants.hpp>
+#include <libfitresult.hpp>
+
+using namespace std;
+
+/*
+ * class ResultsWriter
+ * Writes the fit result of each event to a columnar binary file. Results
+ * are collected in blocks of rows, column by column, and each full block
+ * is written with one call, so output keeps up with the workers however
+ * many vertices they produce. It is used by the writer stage of the 
+ * pipeline, so the workers never wait for the disk.
+ *
+ * The file is a header followed by blocks:
+ * 	header	char[8] "CLVRRSLT", uint32 version, uint32 number of int 
+ * 			columns, uint32 number of float columns, uint32 block size,
+ * 			then the name of each column as char[16] (int columns first)
+ * 	block	uint32 number of rows, then each int column (int32[rows])
+ * 			followed by each float column (float[rows])
+ * All values are little-endian.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class ResultsWriter
+{
+
+
+	// define the public functions and variables
+	public:
+
+		ResultsWriter(int blockSize = libConstants::sResultsBlockSize);
+		~ResultsWriter();
+
+		// Create the file and write the header. Returns -1 on failure.
+		int Open(const char* filename);
+
+		// Main function called from outside class.
+		// Add the result of one event; reconstructed is 0 if the event 
+		// could not be reconstructed. Returns -1 (and Close reports the
+		// error) if no file is open.
+		int Add(FitResult& result, int reconstructed);
+
+		// Write the last block and close the file. Returns the number of
+		// rows written, or -1 if anything could not be written.
+		long Close();
+
+		static constexpr int sNIntColumns = 9;
+		static constexpr int sNFloatColumns = 17;
+		static const char* sIntColumnNames[sNIntColumns];
+		static const char* sFloatColumnNames[sNFloatColumns];
+
+	// define the private functions and variables
+	private:
+
+		void WriteBlock();
+
+		FILE* mFile;
+		int mBlockSize;
+		int mNRows; // rows in the current block
+		long mNWritten;
+		bool mError;
+
+		vector<vector<int32_t>> mIntColumns;
+		vector<vector<float>> mFloatColumns;
+
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**************************************************
+ * Unit tests for ResultsWriter class
+ *
+ * *************************************************/
+
+#include <libresultswriter.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+namespace{
+
+TEST(ResultsWriterTest,TestBlocks){
+
+	// Five results in blocks of two make three blocks.
+	string filename = testing::TempDir() + "clever_results.bin";
+	ResultsWriter writer(2);
+	EXPECT_EQ(writer.Open(filename.c_str()), 0);
+	for (int event = 0; event < 5; event++)
+	{
+		FitResult result;
+		result.event = event;
+		result.x = 10*event;
+		result.maximiseTime = 0.5;
+		writer.Add(result, event != 3);
+	}
+	EXPECT_EQ(writer.Close(), 5);
+
+	// Read the file back.
+	FILE* file = fopen(filename.c_str(), "rb");
+	char magic[8];
+	uint32_t header[4];
+	EXPECT_EQ(fread(magic, 1, 8, file), 8);
+	EXPECT_EQ(memcmp(magic, "CLVRRSLT", 8), 0);
+	EXPECT_EQ(fread(header, sizeof(uint32_t), 4, file), 4);
+	int nInt = header[1];
+	int nFloat = header[2];
+	EXPECT_EQ(nInt, ResultsWriter::sNIntColumns);
+	EXPECT_EQ(nFloat, ResultsWriter::sNFloatColumns);
+	EXPECT_EQ(header[3], 2);
+	char name[16];
+	for (int column = 0; column < nInt + nFloat; column++)
+	{
+		EXPECT_EQ(fread(name, 1, 16, file), 16);
+	}
+	EXPECT_STREQ(name, "maximiseTime");
+
+	vector<int> eventVector, reconstructedVector;
+	vector<float> xVector;
+	uint32_t nRows;
+	while (fread(&nRows, sizeof(nRows), 1, file) == 1)
+	{
+		vector<int32_t> intColumn(nRows);
+		vector<float> floatColumn(nRows);
+		for (int column = 0; column < nInt; column++)
+		{
+			EXPECT_EQ(fread(intColumn.data(), sizeof(int32_t), nRows, file), nRows);
+			if (column == 0)
+			{
+				eventVector.insert(eventVector.end(), intColumn.begin(), intColumn.end());
+			}
+			if (column == 4)
+			{
+				reconstructedVector.insert(reconstructedVector.end(), intColumn.begin(), intColumn.end());
+			}
+		}
+		for (int column = 0; column < nFloat; column++)
+		{
+			EXPECT_EQ(fread(floatColumn.data(), sizeof(float), nRows, file), nRows);
+			if (column == 0)
+			{
+				xVector.insert(xVector.end(), floatColumn.begin(), floatColumn.end());
+			}
+		}
+	}
+	fclose(file);
+
+	ASSERT_EQ(eventVector.size(), 5);
+	for (int event = 0; event < 5; event++)
+	{
+		EXPECT_EQ(eventVector[event], event);
+		EXPECT_EQ(reconstructedVector[event], event != 3);
+		EXPECT_FLOAT_EQ(xVector[event], 10*event);
+	}
+
+}
+
+TEST(ResultsWriterTest,TestNotOpen){
+
+	// Results are refused, not buffered, when no file could be opened.
+	ResultsWriter writer(2);
+	EXPECT_EQ(writer.Open((testing::TempDir() + "clever_missing/results.bin").c_str()), -1);
+	FitResult result;
+	for (int event = 0; event < 5; event++)
+	{
+		EXPECT_EQ(writer.Add(result, 1), -1);
+	}
+	EXPECT_EQ(writer.Close(), -1);
+
+	string filename = testing::TempDir() + "clever_results.bin";
+	EXPECT_EQ(writer.Open(filename.c_str()), 0);
+	EXPECT_EQ(writer.Add(result, 1), 0);
+	EXPECT_EQ(writer.Close(), 1);
+
+}
+
+}
@@ -0,0 +1,65 @@
+#ifndef LIBSHELLS_H
+#define LIBSHELLS_H
+
+/************************************
+ * filename: libshells.hpp
+ * purpose: compile-time unit-shell offset tables used to place new test
+ * 			points around the survivors of each search
+ *
+ * Each table holds the unit vectors {x, y, z} of the vertices of a shell
+ * of radius 1. A new test point is survivor + radius*offset, i.e. one fused
+ * multiply-add per coordinate.
+ *
+ * Values (previously computed with sqrt calls for every survivor):
+ * 	golden ratio conjugate	g = (sqrt(5)-1)/2
+ * 	dodecahedron			a = 1/sqrt(3), b = a/g, c = a*g
+ * 	icosahedron				p = 1/sqrt(1+(1/g)^2), q = p/g
+ * **********************************/
+
+namespace libShells{
+
+	// Values of libConstants::sShellType
+	const int sDodecahedron = 0;
+	const int sIcosahedron = 1;
+	const int sGeodesic = 2;
+
+	constexpr float sA = 0.57735027; // 1/sqrt(3)
+	constexpr float sB = 0.93417236; // a/g
+	constexpr float sC = 0.35682209; // a*g
+	constexpr float sP = 0.52573111; // 1/sqrt(1+(1/g)^2)
+	constexpr float sQ = 0.85065081; // p/g
+
+	// Dodecahedron: 20 vertices.
+	constexpr int sNDodecahedron = 20;
+	constexpr float sDodecahedronShell[sNDodecahedron][3] = {
+		{  0, -sC, -sB}, {-sC, -sB,   0}, {-sB,   0, -sC},
+		{-sA, -sA, -sA}, {-sA, -sA,  sA},
+		{  0, -sC,  sB}, {-sC,  sB,   0}, {-sB,   0,  sC},
+		{-sA,  sA, -sA}, {-sA,  sA,  sA},
+		{  0,  sC, -sB}, { sC, -sB,   0}, { sB,   0, -sC},
+		{ sA, -sA, -sA}, { sA, -sA,  sA},
+		{  0,  sC,  sB}, { sC,  sB,   0}, { sB,   0,  sC},
+		{ sA,  sA, -sA}, { sA,  sA,  sA}
+	};
+
+	// Icosahedron (dual of the dodecahedron above, i.e. pointing at the
+	// centres of its faces): 12 vertices.
+	constexpr int sNIcosahedron = 12;
+	constexpr float sIcosahedronShell[sNIcosahedron][3] = {
+		{  0, -sQ, -sP}, {  0, -sQ,  sP}, {  0,  sQ, -sP}, {  0,  sQ,  sP},
+		{-sP,   0, -sQ}, {-sP,   0,  sQ}, { sP,   0, -sQ}, { sP,   0,  sQ},
+		{-sQ, -sP,   0}, {-sQ,  sP,   0}, { sQ, -sP,   0}, { sQ,  sP,   0}
+	};
+
+	// Geodesic shell: the dodecahedron and icosahedron vertices together
+	// (the 32 vertices of a pentakis dodecahedron projected onto the sphere).
+	constexpr int sNGeodesic = sNDodecahedron + sNIcosahedron;
+
+	// Number of points in the shell of the given type.
+	constexpr int ShellSize(int shellType)
+	{
+		return(shellType == sDodecahedron ? sNDodecahedron : (shellType == sIcosahedron ? sNIcosahedron : sNGeodesic));
+	}
+
+}
+#endif
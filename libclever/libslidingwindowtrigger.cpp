@@ -0,0 +1,124 @@
+/**************************************************
+ * Splits a continuous stream of hits into candidate
+ * events with a sliding-window trigger.
+ * Inputs: hit times, charges and PMT positions of
+ * 			the stream
+ * Outputs: one event per candidate with the hits
+ * 			around it
+ *
+ * *************************************************/
+#include <iostream>
+#include <algorithm>
+#include <numeric> //iota()
+
+#include <libslidingwindowtrigger.hpp>
+
+//constructor function
+SlidingWindowTrigger::SlidingWindowTrigger(float window, int threshold, float preWindow, float postWindow)
+{
+	mWindow = window;
+	mThreshold = (threshold > 0) ? threshold : 0;
+	mPreWindow = preWindow;
+	mPostWindow = postWindow;
+}
+
+//destructor function
+SlidingWindowTrigger::~SlidingWindowTrigger()
+{
+}
+
+int SlidingWindowTrigger::SplitEvents(EventHits& stream, vector<EventHits>& candidatesVector)
+{
+	// Put the hits in time order, if they are not already.
+	int nHits = stream.nhits();
+	mOrderVector.resize(nHits);
+	iota(mOrderVector.begin(), mOrderVector.end(), 0);
+	if (!is_sorted(stream.times.begin(), stream.times.end()))
+	{
+		stable_sort(mOrderVector.begin(), mOrderVector.end(), [&stream] (int i, int j)
+		{
+			return(stream.times[i] < stream.times[j]);
+		});
+	}
+	mTimeVector.resize(nHits);
+	for (int hit = 0; hit < nHits; hit++)
+	{
+		mTimeVector[hit] = stream.times[mOrderVector[hit]];
+	}
+
+	int nCandidates = FindCandidates(mTimeVector, mFirstHitVector, mLastHitVector);
+	if ((int)candidatesVector.size() < nCandidates)
+	{
+		candidatesVector.resize(nCandidates);
+	}
+	for (int iCandidate = 0; iCandidate < nCandidates; iCandidate++)
+	{
+		EventHits& candidate = candidatesVector[iCandidate];
+		candidate.event = stream.event;
+		candidate.subEvent = iCandidate;
+		candidate.times.clear();
+		candidate.charges.clear();
+		candidate.pmtx.clear();
+		candidate.pmty.clear();
+		candidate.pmtz.clear();
+		for (int hit = mFirstHitVector[iCandidate]; hit < mLastHitVector[iCandidate]; hit++)
+		{
+			int index = mOrderVector[hit];
+			candidate.add_hit(stream.times[index], stream.charges[index], stream.pmtx[index], stream.pmty[index], stream.pmtz[index]);
+		}
+	}
+	return(nCandidates);
+}
+
+int SlidingWindowTrigger::FindCandidates(vector<float>& times, vector<int>& firstHitVector, vector<int>& lastHitVector)
+{
+	firstHitVector.clear();
+	lastHitVector.clear();
+
+	// The window holds the hits [back, front]. The start of the candidate
+	// only moves forwards with the back of the window, so a new candidate
+	// overlaps the open one if it starts before the open one ends.
+	int nHits = times.size();
+	int back = 0;
+	bool isOpen = false;
+	float candidateStart = 0;
+	float candidateEnd = 0;
+	for (int front = 0; front < nHits; front++)
+	{
+		while (times[front] - times[back] > mWindow)
+		{
+			back++;
+		}
+		if (front - back + 1 <= mThreshold)
+		{
+			continue;
+		}
+		float start = times[back] - mPreWindow;
+		float end = times[front] + mPostWindow;
+		if (isOpen && start <= candidateEnd)
+		{
+			candidateEnd = max(candidateEnd, end);
+			continue;
+		}
+		if (isOpen)
+		{
+			AddCandidate(times, candidateStart, candidateEnd, firstHitVector, lastHitVector);
+		}
+		candidateStart = start;
+		candidateEnd = end;
+		isOpen = true;
+	}
+	if (isOpen)
+	{
+		AddCandidate(times, candidateStart, candidateEnd, firstHitVector, lastHitVector);
+	}
+
+	return(firstHitVector.size());
+}
+
+void SlidingWindowTrigger::AddCandidate(vector<float>& times, float start, float end, vector<int>& firstHitVector, vector<int>& lastHitVector)
+{
+	// The candidate takes all hits with start <= time <= end.
+	firstHitVector.push_back(lower_bound(times.begin(), times.end(), start) - times.begin());
+	lastHitVector.push_back(upper_bound(times.begin(), times.end(), end) - times.begin());
+}
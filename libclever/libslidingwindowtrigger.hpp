@@ -0,0 +1,69 @@
+#ifndef LIBSLIDINGWINDOWTRIGGER_H
+#define LIBSLIDINGWINDOWTRIGGER_H
+
+//includes
+#include <vector>
+#include <libconstants.hpp>
+#include <libeventhits.hpp>
+
+using namespace std;
+
+/*
+ * class SlidingWindowTrigger
+ * Splits a continuous stream of hits (e.g. an untriggered readout window)
+ * into candidate events, so that the hit selection only ever sees the hits
+ * around one candidate rather than the whole stream.
+ * A window of the given width slides over the time-ordered hits (two
+ * pointers: the front hit is added, and hits more than the width before it
+ * are dropped from the back). Wherever the number of hits in the window
+ * exceeds the threshold, a candidate is formed which takes the hits
+ * from the pre-window before the first to the post-window after the last
+ * hit in the window. Candidates which overlap are merged into one.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class SlidingWindowTrigger
+{
+
+
+	// define the public functions and variables
+	public:
+
+		SlidingWindowTrigger(float window = libConstants::sTriggerWindow, int threshold = libConstants::sTriggerThreshold, float preWindow = libConstants::sTriggerPreWindow, float postWindow = libConstants::sTriggerPostWindow);
+		~SlidingWindowTrigger();
+
+		// Main function called from outside class.
+		// Fills one event for each candidate in the stream with the hits of
+		// the candidate, in time order. The candidates keep the event number
+		// of the stream and are numbered from 0 as sub-events. Returns the
+		// number of candidates (the first entries of candidatesVector).
+		int SplitEvents(EventHits& stream, vector<EventHits>& candidatesVector);
+
+		// Finds the candidates in a list of hit times in ascending order,
+		// as the ranges [first, last) of hits which they take.
+		int FindCandidates(vector<float>& times, vector<int>& firstHitVector, vector<int>& lastHitVector);
+
+	// define the private functions and variables
+	private:
+
+		void AddCandidate(vector<float>& times, float start, float end, vector<int>& firstHitVector, vector<int>& lastHitVector);
+
+		float mWindow;
+		int mThreshold;
+		float mPreWindow;
+		float mPostWindow;
+
+		// Time order of the hits of the stream, their times in that order
+		// and the hit ranges of the candidates, kept to avoid reallocation.
+		vector<int> mOrderVector;
+		vector<float> mTimeVector;
+		vector<int> mFirstHitVector;
+		vector<int> mLastHitVector;
+
+};
+
+#endif
@@ -0,0 +1,127 @@
+/**************************************************
+ * Unit tests for SlidingWindowTrigger class
+ *
+ * *************************************************/
+
+#include <libslidingwindowtrigger.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+namespace{
+
+// Stream of hits with one hit every 50 ns over [0, 10000) ns and bursts of
+// 10 hits, 1 ns apart, at the given times. The charge of each hit is its
+// time, to identify it.
+EventHits MakeStream(vector<float> burstTimes){
+
+	EventHits stream(7,0);
+	for (int hit = 0; hit < 200; hit++)
+	{
+		stream.add_hit(hit*50+25,hit*50+25,hit,0,0);
+	}
+	for (float burstTime : burstTimes)
+	{
+		for (int hit = 0; hit < 10; hit++)
+		{
+			stream.add_hit(burstTime+hit,burstTime+hit,hit,1,0);
+		}
+	}
+	return(stream);
+
+}
+
+TEST(SlidingWindowTriggerTest,TestFindCandidates){
+
+	// Window of 20 ns, more than 4 hits, 10 ns taken either side.
+	SlidingWindowTrigger trigger(20,4,10,10);
+	vector<float> times = {0,100,   200,201,202,203,204,   300,   400,405,410,415,419,   500};
+	vector<int> first, last;
+	ASSERT_EQ(trigger.FindCandidates(times,first,last),2);
+	EXPECT_EQ(first[0],2);
+	EXPECT_EQ(last[0],7);
+	EXPECT_EQ(first[1],8);
+	EXPECT_EQ(last[1],13);
+
+	// Four hits within the window are not enough.
+	vector<float> quiet = {0,5,10,15,100,105,110,115};
+	EXPECT_EQ(trigger.FindCandidates(quiet,first,last),0);
+	quiet.push_back(119);
+	EXPECT_EQ(trigger.FindCandidates(quiet,first,last),1);
+
+}
+
+TEST(SlidingWindowTriggerTest,TestSplitEvents){
+
+	SlidingWindowTrigger trigger(20,8,30,60);
+	vector<EventHits> candidatesVector;
+
+	// Two bursts far apart give two candidates with only their own hits
+	// (the burst and any stream hits within the pre- and post-windows).
+	EventHits stream = MakeStream({1000,6000});
+	ASSERT_EQ(trigger.SplitEvents(stream,candidatesVector),2);
+	for (int iCandidate = 0; iCandidate < 2; iCandidate++)
+	{
+		EventHits& candidate = candidatesVector[iCandidate];
+		float burstTime = (iCandidate == 0) ? 1000 : 6000;
+		EXPECT_EQ(candidate.event,7);
+		EXPECT_EQ(candidate.subEvent,iCandidate);
+		EXPECT_EQ(candidate.nhits(),12);
+		EXPECT_FLOAT_EQ(candidate.times.front(),burstTime-25);
+		EXPECT_FLOAT_EQ(candidate.times.back(),burstTime+25);
+		EXPECT_TRUE(is_sorted(candidate.times.begin(),candidate.times.end()));
+		for (int hit = 0; hit < candidate.nhits(); hit++)
+		{
+			EXPECT_EQ(candidate.charges[hit],candidate.times[hit]);
+		}
+	}
+
+	// Bursts whose candidates overlap are merged into one.
+	stream = MakeStream({3000,3070});
+	ASSERT_EQ(trigger.SplitEvents(stream,candidatesVector),1);
+	EXPECT_FLOAT_EQ(candidatesVector[0].times.front(),2975);
+	EXPECT_FLOAT_EQ(candidatesVector[0].times.back(),3125);
+	EXPECT_EQ(candidatesVector[0].nhits(),24);
+
+}
+
+
+TEST(SlidingWindowTriggerTest,TestNoisyStream){
+
+	// 1260 noise hits spread uniformly over 100 us and five events of 80
+	// hits, each within 100 ns, 18 us apart from 10 us. The charge of each
+	// hit is the number of its event from 1, or 0 for noise.
+	EventHits stream(3,0);
+	mt19937 generator(12345);
+	for (int hit = 0; hit < 1260; hit++)
+	{
+		stream.add_hit(1e5*(generator()/4294967296.),0,0,0,0);
+	}
+	for (int event = 0; event < 5; event++)
+	{
+		for (int hit = 0; hit < 80; hit++)
+		{
+			stream.add_hit(10000+18000*event+(hit*37)%100,event+1,0,0,0);
+		}
+	}
+
+	// With the default settings each event gives one candidate, which holds
+	// all of its hits and only a few noise hits.
+	SlidingWindowTrigger trigger;
+	vector<EventHits> candidatesVector;
+	ASSERT_EQ(trigger.SplitEvents(stream,candidatesVector),5);
+	for (int iCandidate = 0; iCandidate < 5; iCandidate++)
+	{
+		EventHits& candidate = candidatesVector[iCandidate];
+		EXPECT_EQ(candidate.subEvent,iCandidate);
+		int nEventHits = count(candidate.charges.begin(),candidate.charges.end(),iCandidate+1);
+		int nNoiseHits = count(candidate.charges.begin(),candidate.charges.end(),0);
+		EXPECT_EQ(nEventHits,80);
+		EXPECT_EQ(nNoiseHits+nEventHits,candidate.nhits());
+		EXPECT_LT(nNoiseHits,20);
+	}
+
+}
+
+}
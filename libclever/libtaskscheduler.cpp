@@ -0,0 +1,130 @@
+/**************************************************
+ * Shares the work of large events between the
+ * reconstruction workers by work stealing.
+ * Inputs: loops split into ranges of indices
+ * Outputs: each range run once, on any worker
+ *
+ * *************************************************/
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+#include <libtaskscheduler.hpp>
+
+//constructor function
+TaskScheduler::TaskScheduler(int nWorkers) : mQueues(nWorkers > 0 ? nWorkers : 1)
+{
+	mNWorkers = mQueues.size();
+	mNQueued.store(0, memory_order_relaxed);
+	mNActive.store(mNWorkers, memory_order_relaxed);
+}
+
+//destructor function
+TaskScheduler::~TaskScheduler()
+{
+}
+
+void TaskScheduler::ParallelFor(int worker, int n, int grain, function<void(int, int, int)> task)
+{
+	grain = (grain > 0) ? grain : 1;
+	int nTasks = (n + grain - 1)/grain;
+	if (nTasks <= 1)
+	{
+		if (n > 0)
+		{
+			task(worker, 0, n);
+		}
+		return;
+	}
+
+	// Queue all but the first range, last first, so that this worker takes
+	// them in order from the back while thieves take the far end.
+	TaskGroup group;
+	group.task = &task;
+	group.nRemaining.store(nTasks, memory_order_relaxed);
+	{
+		lock_guard<mutex> lock(mQueues[worker].mMutex);
+		for (int iTask = nTasks-1; iTask > 0; iTask--)
+		{
+			mQueues[worker].mTasks.push_back({&group, iTask*grain, min(n, (iTask+1)*grain)});
+		}
+	}
+	mNQueued.fetch_add(nTasks-1, memory_order_release);
+
+	Task first = {&group, 0, grain};
+	Execute(worker, first);
+
+	// Help with whatever is waiting until the stolen ranges have finished.
+	while (group.nRemaining.load(memory_order_acquire) > 0)
+	{
+		if (!RunTask(worker))
+		{
+			this_thread::yield();
+		}
+	}
+}
+
+bool TaskScheduler::RunTask(int worker)
+{
+	if (mNQueued.load(memory_order_acquire) == 0)
+	{
+		return(false);
+	}
+	Task task;
+	if (PopTask(worker, task) || StealTask(worker, task))
+	{
+		Execute(worker, task);
+		return(true);
+	}
+	return(false);
+}
+
+void TaskScheduler::Retire(int worker)
+{
+	mNActive.fetch_sub(1, memory_order_acq_rel);
+	while (mNActive.load(memory_order_acquire) > 0)
+	{
+		if (!RunTask(worker))
+		{
+			this_thread::yield();
+		}
+	}
+}
+
+bool TaskScheduler::PopTask(int worker, Task& task)
+{
+	WorkerQueue& queue = mQueues[worker];
+	lock_guard<mutex> lock(queue.mMutex);
+	if (queue.mTasks.empty())
+	{
+		return(false);
+	}
+	task = queue.mTasks.back();
+	queue.mTasks.pop_back();
+	mNQueued.fetch_sub(1, memory_order_relaxed);
+	return(true);
+}
+
+bool TaskScheduler::StealTask(int worker, Task& task)
+{
+	for (int offset = 1; offset < mNWorkers; offset++)
+	{
+		WorkerQueue& queue = mQueues[(worker + offset) % mNWorkers];
+		lock_guard<mutex> lock(queue.mMutex);
+		if (queue.mTasks.empty())
+		{
+			continue;
+		}
+		task = queue.mTasks.front();
+		queue.mTasks.pop_front();
+		mNQueued.fetch_sub(1, memory_order_relaxed);
+		return(true);
+	}
+	return(false);
+}
+
+void TaskScheduler::Execute(int worker, Task& task)
+{
+	(*task.group->task)(worker, task.first, task.last);
+	task.group->nRemaining.fetch_sub(1, memory_order_acq_rel);
+}
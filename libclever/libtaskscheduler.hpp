@@ -0,0 +1,94 @@
+#ifndef LIBTASKSCHEDULER_H
+#define LIBTASKSCHEDULER_H
+
+//includes
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+/*
+ * class TaskScheduler
+ * Work-stealing scheduler shared by the reconstruction workers, so that one
+ * large event does not hold up a worker while the others are idle. A
+ * worker reconstructing a large event splits a loop (cluster seeds, four-
+ * hit combinations, likelihood tiles) into tasks on its own queue with
+ * ParallelFor and works through them newest first; idle workers steal the
+ * oldest tasks from the other queues. While it waits for the last stolen
+ * tasks to finish, the worker runs any other waiting task itself. Small
+ * events never call ParallelFor, so they stay a single task.
+ * The workers are threads of an EventLoop, identified by their index.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class TaskScheduler
+{
+
+
+	// define the public functions and variables
+	public:
+
+		TaskScheduler(int nWorkers);
+		~TaskScheduler();
+
+		inline int NWorkers(void){
+			return(mNWorkers);
+		}
+
+		// Main function called from outside class.
+		// Calls task(worker, first, last) for the ranges [first, last) of
+		// grain indices which make up [0, n), on the calling worker and on
+		// any workers which steal them. Returns once all have run.
+		void ParallelFor(int worker, int n, int grain, function<void(int, int, int)> task);
+
+		// Run one waiting task: the newest on this worker's queue, or else
+		// the oldest on another worker's queue. Returns false if there were
+		// none.
+		bool RunTask(int worker);
+
+		// Called by a worker with no more work of its own: keep running
+		// stolen tasks until every worker has retired.
+		void Retire(int worker);
+
+	// define the private functions and variables
+	private:
+
+		// Tasks of one ParallelFor call and the number still to finish.
+		struct TaskGroup
+		{
+			function<void(int, int, int)>* task;
+			atomic<int> nRemaining;
+		};
+
+		struct Task
+		{
+			TaskGroup* group;
+			int first;
+			int last;
+		};
+
+		struct alignas(64) WorkerQueue
+		{
+			mutex mMutex;
+			deque<Task> mTasks;
+		};
+
+		bool PopTask(int worker, Task& task);
+		bool StealTask(int worker, Task& task);
+		void Execute(int worker, Task& task);
+
+		int mNWorkers;
+		vector<WorkerQueue> mQueues;
+		atomic<int> mNQueued; // tasks waiting on all queues
+		atomic<int> mNActive; // workers which have not retired
+
+};
+
+#endif
@@ -0,0 +1,86 @@
+/**************************************************
+ * Unit tests for TaskScheduler class
+ *
+ * *************************************************/
+
+#include <libtaskscheduler.hpp>
+#include <libeventloop.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <atomic>
+
+namespace{
+
+TEST(TaskSchedulerTest,TestParallelFor){
+
+	// One worker has a large loop, the others have nothing to do but
+	// steal from it. Every index is run exactly once.
+	EventLoop loop(4);
+	TaskScheduler scheduler(loop.NThreads());
+	int n = 10000;
+	vector<int> countVector(n, 0);
+	vector<int> workerVector(n, -1);
+	loop.RunWorkers([&] (int thread)
+	{
+		if (thread == 0)
+		{
+			scheduler.ParallelFor(thread, n, 7, [&] (int worker, int first, int last)
+			{
+				EXPECT_LT(worker, scheduler.NWorkers());
+				EXPECT_LE(last-first, 7);
+				for (int i = first; i < last; i++)
+				{
+					countVector[i]++;
+					workerVector[i] = worker;
+				}
+			});
+		}
+		scheduler.Retire(thread);
+	});
+	for (int i = 0; i < n; i++)
+	{
+		EXPECT_EQ(countVector[i], 1);
+		EXPECT_GE(workerVector[i], 0);
+	}
+
+}
+
+TEST(TaskSchedulerTest,TestMixedSizes){
+
+	// Every worker has events of its own, some of which are split. The
+	// result of each event is complete when its ParallelFor returns.
+	EventLoop loop(4);
+	TaskScheduler scheduler(loop.NThreads());
+	atomic<int> nextEvent(0);
+	int nEvents = 40;
+	vector<long> sumVector(nEvents, 0);
+	loop.RunWorkers([&] (int thread)
+	{
+		int event;
+		while ((event = nextEvent.fetch_add(1)) < nEvents)
+		{
+			int n = (event % 10 == 0) ? 20000 : 10;
+			vector<long> partialVector((n+99)/100, 0);
+			scheduler.ParallelFor(thread, n, 100, [&] (int, int first, int last)
+			{
+				for (int i = first; i < last; i++)
+				{
+					partialVector[first/100] += i;
+				}
+			});
+			for (long partial : partialVector)
+			{
+				sumVector[event] += partial;
+			}
+		}
+		scheduler.Retire(thread);
+	});
+	for (int event = 0; event < nEvents; event++)
+	{
+		long n = (event % 10 == 0) ? 20000 : 10;
+		EXPECT_EQ(sumVector[event], n*(n-1)/2);
+	}
+
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef LIBTESTHELPERS_H
+#define LIBTESTHELPERS_H
+
+//includes
+#include <vector>
+#include <math.h>
+#include <libconstants.hpp>
+#include <libhitinfo.hpp>
+#include <libpdf.hpp>
+
+using namespace std;
+
+/*
+ * Fixtures shared by the unit tests (lib*.test.cpp): a simple
+ * time-residual pdf and the hits of an ideal event.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+// Gaussian time-residual pdf (sigma 1.5 ns) over [-10, 30) ns.
+inline void MakePDF(TimeResidualPDF& pdf){
+
+	vector<float> contents(80);
+	for (int bin = 0; bin < 80; bin++)
+	{
+		float residual = -10 + (bin+0.5)*0.5;
+		contents[bin] = exp(-0.5*residual*residual/2.25) + 1e-3;
+	}
+	pdf.SetPDF(contents,-10,30);
+
+}
+
+// Hits on a 500 cm sphere around the origin from light emitted at the
+// vertex at time 10 ns.
+inline void MakeHits(vector<float> vertex, int nHits, vector<HitInfo>& hitInfoVector){
+
+	hitInfoVector.clear();
+	for (int iHit = 0; iHit < nHits; iHit++)
+	{
+		float cosTheta = -1 + 2*(iHit+0.5)/nHits;
+		float sinTheta = sqrt(1 - cosTheta*cosTheta);
+		float phi = iHit*2.39996;
+		float x = 500*sinTheta*cos(phi);
+		float y = 500*sinTheta*sin(phi);
+		float z = 500*cosTheta;
+		float dx = x-vertex[0], dy = y-vertex[1], dz = z-vertex[2];
+		float time = 10 + sqrt(dx*dx+dy*dy+dz*dz)/libConstants::sCmPerNs;
+		hitInfoVector.push_back(HitInfo(0,0,1,0,{},time,1,x,y,z));
+	}
+
+}
+
+#endif
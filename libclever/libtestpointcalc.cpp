@@ -22,7 +22,9 @@ using namespace Eigen;
 //constructor function
 TestPointCalc::TestPointCalc()
 {
-	CalculateTestPoints(hitinfo, rmax, zmax, testPointsVector);
+	ncombinations = 0;
+	zmax = 0;
+	rmax = 0;
 }
 
 //destructor function
@@ -36,6 +38,7 @@ int TestPointCalc::CalculateTestPoints(vector<HitInfo>& hitinfo, float rmax2, fl
 {
 
 	// Calculates vertices from four-hit combinations.
+	truncated = 0;
 	int nselected = size(hitinfo);
 
 	// Create a vector to store the upper bound of hit combinations for each 
@@ -46,12 +49,11 @@ int TestPointCalc::CalculateTestPoints(vector<HitInfo>& hitinfo, float rmax2, fl
 	// Define allowed ranges of hit numbers using absolute timing
 	// to give as close to the ideal number of combinations as possible.
 	// Also fills combos_upper_bounds with ranges for hit combinations.
-	FourHitCombos fourhitcombos;
 	ncombos = fourhitcombos.GetFourHitCombos(hitinfo,combos_upper_bounds);
 	
 	// For each hit, calculate a test point in front of each hit and add to 
 	// the testpoints vector (without averaging over nearby hits).
-	for (int hit=0; hit<ncombos-3; hit++)
+	for (int hit=0; hit<nselected; hit++)
 	{
 		FrontOfPMTTestPoints(hitinfo[hit].pmtx,hitinfo[hit].pmty,hitinfo[hit].pmtz, rmax2, zmax, testPointsVector);
 	}
@@ -104,12 +106,54 @@ void TestPointCalc::FrontOfPMTTestPoints(float pmtx, float pmty, float pmtz, flo
 
 }
 
-void TestPointCalc::FourHitComboTestPoints(vector<HitInfo> hitinfo, vector<int> combos_upper_bounds, vector<vector<float>>& fourHitTestPointsVector)
+void TestPointCalc::FourHitComboTestPoints(vector<HitInfo>& hitinfo, vector<int>& combos_upper_bounds, vector<vector<float>>& fourHitTestPointsVector)
 {
+	// Find the first hits from which combinations are drawn.
+	int nbounds = combos_upper_bounds.size();
+	int nfirsthits = 0;
+	while (nfirsthits<nbounds && nfirsthits<combos_upper_bounds[nfirsthits]-3)
+	{
+		nfirsthits++;
+	}
+
+	// Large events share the first hits with idle workers. Each task 
+	// fills its own list, and the lists are joined in order.
+	if (scheduler != nullptr && (int)hitinfo.size() >= libConstants::sParallelMinimumHits)
+	{
+		int grain = libConstants::sFourHitGrain;
+		int ntasks = (nfirsthits+grain-1)/grain;
+		vector<vector<vector<float>>> taskTestPointsVector(ntasks);
+		vector<int> task_truncated(ntasks, 0);
+		scheduler->ParallelFor(worker, nfirsthits, grain, [&] (int, int first, int last)
+		{
+			int task = first/grain;
+			task_truncated[task] = FourHitComboRange(hitinfo,combos_upper_bounds,first,last,taskTestPointsVector[task]);
+		});
+		for (int task = 0; task < ntasks; task++)
+		{
+			truncated |= task_truncated[task];
+			fourHitTestPointsVector.insert(fourHitTestPointsVector.end(), taskTestPointsVector[task].begin(), taskTestPointsVector[task].end());
+		}
+		return;
+	}
+
+	truncated |= FourHitComboRange(hitinfo,combos_upper_bounds,0,nfirsthits,fourHitTestPointsVector);
+
+}
+
+int TestPointCalc::FourHitComboRange(vector<HitInfo>& hitinfo, vector<int>& combos_upper_bounds, int firsthit, int lasthit, vector<vector<float>>& fourHitTestPointsVector)
+{
+	// Loop over all 4-hit combinations whose first hit is in the range.
+	// Returns 1 if the time budget ran out before the end.
 	int combo = 0;
-	// Loop over all 4-hit combinations.
-    for (int hit1=0; hit1<combos_upper_bounds[hit1]-3; hit1++)
-    {
+	for (int hit1=firsthit; hit1<lasthit; hit1++)
+	{
+		// Use only the combinations found so far once the time budget
+		// has run out.
+		if (combo > 0 && deadline.HasExpired())
+		{
+			return(1);
+		}
 		vector <int> fourhitcombo;
 		int last_hit = combos_upper_bounds[hit1];
 		
@@ -122,13 +166,14 @@ void TestPointCalc::FourHitComboTestPoints(vector<HitInfo> hitinfo, vector<int>
 					fourhitcombo = {hit1,hit2,hit3,hit4};
 					// Calculate the testpoint from the four-hit combination
 					// and add to a list of temporary testpoints.
-					FourHitVertex(hitinfo,fourhitcombo,combo,fourHitTestPointsVector);
+					FourHitVertex(hitinfo,fourhitcombo,fourHitTestPointsVector);
 					combo++;
 
 				}
 			}
 		}
 	}
+	return(0);
 
 }
 
@@ -152,7 +197,7 @@ void TestPointCalc::ReduceTestPoints(vector<vector<float>>& fourHitTestPointsVec
 // These are the subsidiary functions called by the principal functions 
 // which are in turn called by the main CalculateVertices function.
 
-void TestPointCalc::FourHitVertex(vector<HitInfo> hitinfo, vector<int> fourhitcombo,int combo,vector<vector<float>>& fourHitTestPointsVector)
+void TestPointCalc::FourHitVertex(vector<HitInfo>& hitinfo, vector<int>& fourhitcombo,vector<vector<float>>& fourHitTestPointsVector)
 {
 	
 	// Calculate testpoints from four-hit combinations.
@@ -169,86 +214,93 @@ void TestPointCalc::FourHitVertex(vector<HitInfo> hitinfo, vector<int> fourhitco
 		}
 	}
 
-	// Find the quad point X = (X,Y,Z,T).
-	// Make three vectors (which may or may not be co-planar) from the four 
-	// points by selecting the position vector of thefirst hit in time as x_0
-	// and then finding the line x_i-x_0.
-	// For co-planar vectors, the scalar triple product = 0; but we're not too
-	// worrried about that here.
-	// Set to zero the dot product of the coordinate difference vector for each
-	// of the potentially co-planar line vectors x_i-x_0 and the quad point X.
-	// (x_i - X)(x_i - X) = |x_i|**2 - 2x_iX + |X|**2 = 0
-	// The solution to these simultaneous equations (where i in (1,3) gives X.
-	// We express them in matrix form and use 'svd of an under-determined 
-	// system' to find the near-zero value to give us X.
-	
-	// Define vectors by finding the positions and times of the other hits 
-	// with respect to the first hit and fill a matrix with the quantities 
-	// for calculating the vertex.
-	// [1 -2dx -2dy -2dz -2dt s**2] . [|v|**2 vx vy vz 1]^T = 0
-	// Omitting |v|**2, define a 3 x 5 matrix (3 vectors with 5 values each)
-	// i.e. [-2dx -2dy -2dz +2dt s**2] . [vx vy vz 1]^T = 0
-	MatrixXf matrix(3,5);
-	VectorXf zero_vector{{0.,0.,0.,0.,0}};
-	float dx, dy, dz, dt;
+	// Find the quad point X = (X,Y,Z,T), the vertex from which light reaches
+	// the four hits at their hit times: |x_i - X| = c(t_i - T).
+	// Measuring positions and times from the first hit (d_i = x_i - x_0,
+	// dt_i = t_i - t_0) and the vertex as V = X - x_0, S = T - t_0, the
+	// difference between the equation of each other hit and that of the 
+	// first hit (|V| = -cS) is linear:
+	// 	2 d_i.V - 2c^2 dt_i S = |d_i|^2 - c^2 dt_i^2
+	// so solving the three equations gives V = A + B*S, and S is then a root
+	// of the quadratic |A + B*S|^2 = c^2 S^2.
+	float c2 = libConstants::sCmPerNs*libConstants::sCmPerNs;
+	Matrix3f matrix;
+	Vector3f constant, slope;
+	int row = 0;
 	for (int hit = 0; hit < 4; hit++)
 	{
-		if (hit != firsthit)
+		if (hit == firsthit)
 		{
-			dx = hitinfo[fourhitcombo[hit]].pmtx - hitinfo[fourhitcombo[firsthit]].pmtx;
-			dy = hitinfo[fourhitcombo[hit]].pmty - hitinfo[fourhitcombo[firsthit]].pmty;
-			dz = hitinfo[fourhitcombo[hit]].pmtz - hitinfo[fourhitcombo[firsthit]].pmtz;
-			dt = (hitinfo[fourhitcombo[hit]].time - hitinfo[fourhitcombo[firsthit]].time)*libConstants::sCmPerNs;
+			continue;
 		}
-
-		// Add line vectors to the matrix
-		matrix << -2*dx;
-		matrix << -2*dy;
-		matrix << -2*dz;
-		// Calculate 2*dt*cm_per_ns
-		matrix << 2*dt;
-		// Calculate dx**2 + dy**2 + dz**2 - (dt*cm_per_ns)**2
-		matrix << dx*dx * dy*dy + dz*dz - dt*dt;
+		float dx = hitinfo[fourhitcombo[hit]].pmtx - hitinfo[fourhitcombo[firsthit]].pmtx;
+		float dy = hitinfo[fourhitcombo[hit]].pmty - hitinfo[fourhitcombo[firsthit]].pmty;
+		float dz = hitinfo[fourhitcombo[hit]].pmtz - hitinfo[fourhitcombo[firsthit]].pmtz;
+		float dt = hitinfo[fourhitcombo[hit]].time - hitinfo[fourhitcombo[firsthit]].time;
+		matrix.row(row) << 2*dx, 2*dy, 2*dz;
+		constant[row] = dx*dx + dy*dy + dz*dz - c2*dt*dt;
+		slope[row] = 2*c2*dt;
+		row++;
 	}
 
-	// Now need to find solutions for the 3 x 5 matrix.
-	// Do this by performing Singular Value Decomposition (SVD) of the matrix
-	// using eigen bdcSvD algorithm to find least squares solution. 
-	// ComputeThinV gives a p x m matrix, such that the first m columns of V 
-	// are the right singular vectors of the matrix being decomposed.
-	// Find the least squares solution of Ax = 0
-	BDCSVD<MatrixXf> svd(matrix, ComputeThinU | ComputeThinV);
-	svd.solve(zero_vector);
-
-	const MatrixXf &V = svd.matrixV();
-	// U left singular vector maps contribution of data points to singular 
-	// values.
-	// S singular value importance of singular vectors decreasing rank order.
-	// For Ax = 0, the solutions for x are the right singular vectors V 
-	// corresponding to the  zero singular values(???)
-	// Loop over the columns of V and save the vectors 
-	for (int vtx = 0; vtx < V.cols(); vtx++)
+	// Solve for A and B. Hits which are (nearly) co-planar give no vertex.
+	float scale = matrix.cwiseAbs().maxCoeff();
+	if (fabs(matrix.determinant()) < 1e-6*scale*scale*scale)
+	{
+		return;
+	}
+	Matrix3f inverse = matrix.inverse();
+	Vector3f a = inverse*constant;
+	Vector3f b = inverse*slope;
+
+	// (B.B - c^2) S^2 + 2 A.B S + A.A = 0. The light is emitted before the
+	// first hit (S <= 0); take the latest such time. Without a real root,
+	// take the time of closest approach.
+	float qa = b.dot(b) - c2;
+	float qb = 2*a.dot(b);
+	float qc = a.dot(a);
+	float s;
+	float discriminant = qb*qb - 4*qa*qc;
+	if (fabs(qa) < 1e-6)
+	{
+		s = (fabs(qb) > 0) ? -qc/qb : 0;
+	}
+	else if (discriminant < 0)
 	{
-		vector <float> vertex(V.rows());
-		Map<MatrixXf>(vertex.data(), V.rows(),1) = V.col(vtx);
-		fourHitTestPointsVector[combo].push_back(vertex[0]+hitinfo[fourhitcombo[firsthit]].pmtx);
-		fourHitTestPointsVector[combo].push_back(vertex[1]+hitinfo[fourhitcombo[firsthit]].pmty);
-		fourHitTestPointsVector[combo].push_back(vertex[2]+hitinfo[fourhitcombo[firsthit]].pmtz);
-		fourHitTestPointsVector[combo].push_back(vertex[3]+hitinfo[fourhitcombo[firsthit]].time);
+		s = -qb/(2*qa);
 	}
+	else
+	{
+		float root = sqrt(discriminant);
+		float s1 = (-qb - root)/(2*qa);
+		float s2 = (-qb + root)/(2*qa);
+		if (s1 > s2)
+		{
+			swap(s1, s2);
+		}
+		s = (s2 <= 0) ? s2 : s1;
+	}
+	if (s > 0)
+	{
+		return;
+	}
+
+	Vector3f vertex = a + b*s;
+	fourHitTestPointsVector.push_back({vertex[0]+hitinfo[fourhitcombo[firsthit]].pmtx, vertex[1]+hitinfo[fourhitcombo[firsthit]].pmty, vertex[2]+hitinfo[fourhitcombo[firsthit]].pmtz, s+hitinfo[fourhitcombo[firsthit]].time});
 
 }
 
 	
-void TestPointCalc::FindClosePoint(vector<vector<float>> fourHitTestPointsVector, int point1, float sMinPointSeparation2)
+void TestPointCalc::FindClosePoint(vector<vector<float>>& fourHitTestPointsVector, int point1, float sMinPointSeparation2)
 {
 	float x1 = fourHitTestPointsVector[point1][0];
 	float y1 = fourHitTestPointsVector[point1][1];
 	float z1 = fourHitTestPointsVector[point1][2];
 	float x2, y2, z2;
-	int nclosepoints = 0;
+	int nclosepoints = 1;
 
-	for (int point2 = 0; point2 < fourHitTestPointsVector.size(); point2++)
+	// Points before point1 have already been averaged and kept.
+	for (int point2 = point1+1; point2 < fourHitTestPointsVector.size(); point2++)
 	{
 		x2 = fourHitTestPointsVector[point2][0];
 		y2 = fourHitTestPointsVector[point2][1];
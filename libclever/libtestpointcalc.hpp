@@ -4,6 +4,9 @@
 //includes
 #include <vector>
 #include <libhitinfo.hpp>
+#include <libdeadline.hpp>
+#include <libtaskscheduler.hpp>
+#include <libfourhitcombos.hpp>
 
 using namespace std;
 
@@ -32,19 +35,30 @@ class TestPointCalc
 		vector<vector<float>> testPointsVector;
 
 		// Main function called from outside class.
-		int CalculateTestPoints(vector<HitInfo>& hitinfo, float zmax, float rmax2, vector<vector<float>>& testPointsVector);
+		int CalculateTestPoints(vector<HitInfo>& hitinfo, float rmax2, float zmax, vector<vector<float>>& testPointsVector);
+
+		// Set the time budget for the event. If it runs out, no more 
+		// four-hit combinations are used and the test points are flagged
+		// as truncated.
+		void SetDeadline(Deadline& event_deadline){ deadline = event_deadline; };
+		int IsTruncated(){ return truncated; };
+
+		// Share the four-hit combinations of large events with the other
+		// workers of the scheduler (nullptr = use this worker only).
+		void SetScheduler(TaskScheduler* task_scheduler, int scheduler_worker){ scheduler = task_scheduler; worker = scheduler_worker; };
 
 		// Principal functions which perform the test point calculation and 
 		// which are called by the main CalculateTestPoints function.
 		// (Strictly private functions but public to be available for 
 		// running unit tests.)
 		void FrontOfPMTTestPoints(float pmtx, float pmty, float pmtz, float rmax2, float zmax, vector<vector<float>>& testPointsVector);
-		void FourHitComboTestPoints(vector<HitInfo> hitinfo,vector<int> combos_upper_bounds, vector<vector<float>>& testPointsVector_tmp);
+		void FourHitComboTestPoints(vector<HitInfo>& hitinfo,vector<int>& combos_upper_bounds, vector<vector<float>>& testPointsVector_tmp);
 		void ReduceTestPoints(vector<vector<float>>& fourHitTestPointsVector, float sMinPointSeparation2, vector<vector<float>>& testPointsVector);
 
 		// Subsidiary functions called by the the principal functions
-		void FourHitVertex(vector<HitInfo> hitinfo, vector<int> fourhitcombo, int combo, vector<vector<float>>& testPointsVector_tmp);
-		void FindClosePoint(vector<vector<float>> testPointsVector_tmp, int point1, float dmin);
+		int FourHitComboRange(vector<HitInfo>& hitinfo, vector<int>& combos_upper_bounds, int firsthit, int lasthit, vector<vector<float>>& testPointsVector_tmp);
+		void FourHitVertex(vector<HitInfo>& hitinfo, vector<int>& fourhitcombo, vector<vector<float>>& testPointsVector_tmp);
+		void FindClosePoint(vector<vector<float>>& testPointsVector_tmp, int point1, float dmin);
 
 
 	// define the private functions and variables
@@ -53,6 +67,11 @@ class TestPointCalc
 		int ncombinations;
 		float zmax;
 		float rmax;
+		Deadline deadline;
+		int truncated = 0;
+		TaskScheduler* scheduler = nullptr;
+		int worker = 0;
+		FourHitCombos fourhitcombos;
 		
 
 
@@ -10,20 +10,81 @@
 
 namespace{
 
+// Hit at a PMT position with the time light from the vertex would arrive.
+HitInfo VertexHit(vector<float> vertex, float x, float y, float z)
+{
+	vector<int> is_rel;
+	float dx = x - vertex[0];
+	float dy = y - vertex[1];
+	float dz = z - vertex[2];
+	float time = vertex[3] + sqrt(dx*dx + dy*dy + dz*dz)/libConstants::sCmPerNs;
+	return(HitInfo(0,0,0,0,is_rel,time,1,x,y,z));
+}
+
 TEST(PointCalcTest,TestFrontOfPMTTestPoints){
 
 }
 
 TEST(PointCalcTest,TestFourHitVertex){
 
+	TestPointCalc calc;
+	vector<float> vertex = {100., -50., 200., 10.};
+	vector<HitInfo> hitinfo;
+	hitinfo.push_back(VertexHit(vertex,1000.,0.,0.));
+	hitinfo.push_back(VertexHit(vertex,0.,1000.,300.));
+	hitinfo.push_back(VertexHit(vertex,0.,0.,1000.));
+	hitinfo.push_back(VertexHit(vertex,-700.,-700.,-400.));
+	vector<int> fourhitcombo = {0,1,2,3};
+	vector<vector<float>> points;
+
+	calc.FourHitVertex(hitinfo,fourhitcombo,points);
+	ASSERT_EQ((int)points.size(),1);
+	EXPECT_NEAR(points[0][0],vertex[0],1.);
+	EXPECT_NEAR(points[0][1],vertex[1],1.);
+	EXPECT_NEAR(points[0][2],vertex[2],1.);
+	EXPECT_NEAR(points[0][3],vertex[3],0.1);
 }
 
-TEST(PointCalcTest,TestFrontOfPMTTestPoints){
+TEST(PointCalcTest,TestFourHitVertexCoplanar){
+
+	// Four hits in one plane give no vertex.
+	TestPointCalc calc;
+	vector<float> vertex = {100., -50., 200., 10.};
+	vector<HitInfo> hitinfo;
+	hitinfo.push_back(VertexHit(vertex,1000.,0.,500.));
+	hitinfo.push_back(VertexHit(vertex,0.,1000.,500.));
+	hitinfo.push_back(VertexHit(vertex,-1000.,0.,500.));
+	hitinfo.push_back(VertexHit(vertex,-700.,-700.,500.));
+	vector<int> fourhitcombo = {0,1,2,3};
+	vector<vector<float>> points;
 
+	calc.FourHitVertex(hitinfo,fourhitcombo,points);
+	EXPECT_EQ((int)points.size(),0);
 }
 
-TEST(PointCalcTest,TestFrontOfPMTTestPoints){
+TEST(PointCalcTest,TestReduceTestPoints){
+
+	// Points closer than the separation are replaced by their average.
+	TestPointCalc calc;
+	vector<vector<float>> points = {{0.,0.,0.,0.},{1000.,0.,0.,0.},{10.,0.,0.,0.},{20.,0.,0.,0.}};
+	vector<vector<float>> reduced;
+
+	calc.ReduceTestPoints(points,libConstants::sMinPointSeparation2,reduced);
+	ASSERT_EQ((int)reduced.size(),2);
+	EXPECT_FLOAT_EQ(reduced[0][0],10.);
+	EXPECT_FLOAT_EQ(reduced[1][0],1000.);
+}
+
+TEST(PointCalcTest,TestFindClosePoint){
+
+	// Points before point1 have been kept already and are not merged again.
+	TestPointCalc calc;
+	vector<vector<float>> points = {{0.,0.,0.,0.},{10.,0.,0.,0.},{20.,0.,0.,0.}};
 
+	calc.FindClosePoint(points,1,libConstants::sMinPointSeparation2);
+	ASSERT_EQ((int)points.size(),2);
+	EXPECT_FLOAT_EQ(points[0][0],0.);
+	EXPECT_FLOAT_EQ(points[1][0],15.);
 }
 
 TEST(PointCalcTest,TestFourHitComboTestPoints){
@@ -0,0 +1,274 @@
+/**************************************************
+ * Reads the geometry, pdf and event hits from 
+ * plain text files.
+ * Inputs: geometry, pdf and hits text files
+ * Outputs: PMT positions, pdf bins and the hits of
+ * 			each event
+ *
+ * *************************************************/
+#include <iostream>
+#include <cstring>
+#include <charconv>
+
+#include <libtexthitreader.hpp>
+
+//constructor function
+TextHitReader::TextHitReader(size_t chunkSize)
+{
+	mFile = NULL;
+	mChunkSize = chunkSize;
+	mPosition = 0;
+	mEnd = 0;
+	mEndOfFile = true;
+	mLineNumber = 0;
+	mAttenuationLength = 0;
+}
+
+//destructor function
+TextHitReader::~TextHitReader()
+{
+	Close();
+}
+
+int TextHitReader::ReadGeometry(const char* filename, vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz)
+{
+	if (Open(filename) < 0)
+	{
+		return(-1);
+	}
+	mPMTX.clear();
+	mPMTY.clear();
+	mPMTZ.clear();
+	mAttenuationLength = 0;
+	const char* begin;
+	const char* end;
+	float values[3];
+	bool isFirstLine = true;
+	while (NextLine(begin, end))
+	{
+		int nValues = ParseValues(begin, end, values, 3);
+		if (isFirstLine && nValues == 1 && values[0] > 0)
+		{
+			mAttenuationLength = values[0];
+			isFirstLine = false;
+			continue;
+		}
+		isFirstLine = false;
+		if (nValues != 3)
+		{
+			Close();
+			return(-1);
+		}
+		mPMTX.push_back(values[0]);
+		mPMTY.push_back(values[1]);
+		mPMTZ.push_back(values[2]);
+	}
+	Close();
+	pmtx = mPMTX;
+	pmty = mPMTY;
+	pmtz = mPMTZ;
+	return(mPMTX.size());
+}
+
+int TextHitReader::ReadPDF(const char* filename, vector<float>& probabilityVector, float& tMin, float& tMax)
+{
+	if (Open(filename) < 0)
+	{
+		return(-1);
+	}
+	probabilityVector.clear();
+	const char* begin;
+	const char* end;
+	float values[2];
+	float firstResidual = 0, lastResidual = 0;
+	while (NextLine(begin, end))
+	{
+		if (ParseValues(begin, end, values, 2) != 2)
+		{
+			Close();
+			return(-1);
+		}
+		if (probabilityVector.empty())
+		{
+			firstResidual = values[0];
+		}
+		lastResidual = values[0];
+		probabilityVector.push_back(values[1]);
+	}
+	Close();
+	int nBins = probabilityVector.size();
+	if (nBins < 2)
+	{
+		return(-1);
+	}
+	// The residuals are the bin centres.
+	float binWidth = (lastResidual - firstResidual)/(nBins-1);
+	tMin = firstResidual - 0.5*binWidth;
+	tMax = lastResidual + 0.5*binWidth;
+	return(nBins);
+}
+
+int TextHitReader::Open(const char* filename)
+{
+	Close();
+	mFile = fopen(filename, "rb");
+	if (mFile == NULL)
+	{
+		return(-1);
+	}
+	mBuffer.resize(mChunkSize);
+	mPosition = 0;
+	mEnd = 0;
+	mEndOfFile = false;
+	mLineNumber = 0;
+	return(0);
+}
+
+void TextHitReader::Close()
+{
+	if (mFile != NULL)
+	{
+		fclose(mFile);
+		mFile = NULL;
+	}
+	mEndOfFile = true;
+}
+
+int TextHitReader::ReadEvent(EventHits& hits)
+{
+	const char* begin;
+	const char* end;
+	if (!NextLine(begin, end))
+	{
+		return(sEndOfFile);
+	}
+	// Event header: event, sub-event and number of hits.
+	int nhits;
+	if (!ParseValue(begin, end, hits.event) || !ParseValue(begin, end, hits.subEvent) || !ParseValue(begin, end, nhits) || !AtLineEnd(begin, end) || nhits < 0)
+	{
+		return(sParseError);
+	}
+	hits.times.clear();
+	hits.charges.clear();
+	hits.pmtx.clear();
+	hits.pmty.clear();
+	hits.pmtz.clear();
+
+	int nPMTs = mPMTX.size();
+	for (int hit = 0; hit < nhits; hit++)
+	{
+		int pmtId;
+		float time, charge;
+		if (!NextLine(begin, end) || !ParseValue(begin, end, pmtId) || !ParseValue(begin, end, time) || !ParseValue(begin, end, charge) || !AtLineEnd(begin, end))
+		{
+			return(sParseError);
+		}
+		if (pmtId < 0 || pmtId >= nPMTs)
+		{
+			return(sParseError);
+		}
+		hits.add_hit(time, charge, mPMTX[pmtId], mPMTY[pmtId], mPMTZ[pmtId]);
+	}
+	return(nhits);
+}
+
+bool TextHitReader::NextLine(const char*& begin, const char*& end)
+{
+	for (;;)
+	{
+		char* data = mBuffer.data();
+		char* newline = (char*)memchr(data + mPosition, '\n', mEnd - mPosition);
+		if (newline == NULL)
+		{
+			if (mEndOfFile || mFile == NULL)
+			{
+				// The last line may have no newline.
+				if (mPosition == mEnd)
+				{
+					return(false);
+				}
+				newline = data + mEnd;
+			}
+			else
+			{
+				// Move the partial line to the front and read the next chunk,
+				// growing the buffer if a single line does not fit.
+				size_t remaining = mEnd - mPosition;
+				memmove(data, data + mPosition, remaining);
+				mPosition = 0;
+				mEnd = remaining;
+				if (mBuffer.size() - mEnd < mChunkSize/2)
+				{
+					mBuffer.resize(mBuffer.size() + mChunkSize);
+				}
+				size_t nRead = fread(mBuffer.data() + mEnd, 1, mBuffer.size() - mEnd, mFile);
+				mEnd += nRead;
+				if (nRead == 0)
+				{
+					mEndOfFile = true;
+				}
+				continue;
+			}
+		}
+
+		begin = data + mPosition;
+		end = newline;
+		mPosition = (newline - data) + 1;
+		if (mPosition > mEnd)
+		{
+			mPosition = mEnd;
+		}
+		mLineNumber++;
+
+		// Skip blank lines and comments.
+		const char* first = begin;
+		while (first < end && (*first == ' ' || *first == '\t' || *first == '\r'))
+		{
+			first++;
+		}
+		if (first < end && *first != '#')
+		{
+			return(true);
+		}
+	}
+}
+
+int TextHitReader::ParseValues(const char* begin, const char* end, float* values, int nValues)
+{
+	int nParsed = 0;
+	const char* position = begin;
+	while (nParsed < nValues && ParseValue(position, end, values[nParsed]))
+	{
+		nParsed++;
+	}
+	if (!AtLineEnd(position, end))
+	{
+		return(-1);
+	}
+	return(nParsed);
+}
+
+template <class T>
+bool TextHitReader::ParseValue(const char*& position, const char* end, T& value)
+{
+	while (position < end && IsSeparator(*position))
+	{
+		position++;
+	}
+	auto result = from_chars(position, end, value);
+	if (result.ec != errc() || (result.ptr < end && !IsSeparator(*result.ptr)))
+	{
+		return(false);
+	}
+	position = result.ptr;
+	return(true);
+}
+
+bool TextHitReader::AtLineEnd(const char* position, const char* end)
+{
+	while (position < end && IsSeparator(*position))
+	{
+		position++;
+	}
+	return(position == end);
+}
@@ -0,0 +1,121 @@
+#ifndef LIBTEXTHITREADER_H
+#define LIBTEXTHITREADER_H
+
+//includes
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <libconstants.hpp>
+#include <libeventhits.hpp>
+
+using namespace std;
+
+/*
+ * class TextHitReader
+ * Reads the detector geometry, time-residual pdf and event hits from plain
+ * text files, so that clever can run without ROOT (e.g. for test stands 
+ * and toy studies). Values on a line are separated by commas and/or white
+ * space, and blank lines and lines starting with '#' are skipped:
+ * 	geometry	x, y, z					one line per inner PMT in cm; the
+ * 										PMT id is the line index. An
+ * 										optional first line with one value
+ * 										gives the attenuation length of
+ * 										the medium in cm
+ * 	pdf			residual, probability	one line per bin centre in ns,
+ * 										equally spaced
+ * 	hits		event, subEvent, nHits	followed by nHits lines of
+ * 				pmtId, time, charge		time in ns, charge in p.e.; the
+ * 										event numbers, nHits and pmtId
+ * 										are integers
+ * A line with anything after its last value is malformed.
+ * The file is read in large chunks and the numbers are parsed in place 
+ * with from_chars, without copying the lines or going through streams.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class TextHitReader
+{
+
+
+	// define the public functions and variables
+	public:
+
+		TextHitReader(size_t chunkSize = libConstants::sTextChunkSize);
+		~TextHitReader();
+
+		// Read the inner PMT positions. Returns the number of PMTs, or -1 if
+		// the file can not be read.
+		int ReadGeometry(const char* filename, vector<float>& pmtx, vector<float>& pmty, vector<float>& pmtz);
+
+		// Attenuation length from the last geometry file read (0 if it 
+		// gives none).
+		inline float AttenuationLength(void){
+			return(mAttenuationLength);
+		}
+
+		// Read the pdf bins. Returns the number of bins, or -1 if the file 
+		// can not be read.
+		int ReadPDF(const char* filename, vector<float>& probabilityVector, float& tMin, float& tMax);
+
+		// Open the hits file. The geometry must have been read first.
+		int Open(const char* filename);
+		void Close();
+
+		// Main function called from outside class.
+		// Read the next event into hits (reusing its buffers). Returns the
+		// number of hits, sEndOfFile at the end of the file or sParseError
+		// if the event is malformed (see LineNumber).
+		int ReadEvent(EventHits& hits);
+
+		// Line of the file last read.
+		inline int LineNumber(void){
+			return(mLineNumber);
+		}
+
+		static constexpr int sEndOfFile = -1;
+		static constexpr int sParseError = -2;
+
+	// define the private functions and variables
+	private:
+
+		// Get the next line which is not blank or a comment, refilling the
+		// buffer from the file as needed.
+		bool NextLine(const char*& begin, const char*& end);
+
+		// Parse up to nValues numbers from a line. Returns the number parsed,
+		// or -1 if something on the line is not a number or is left over.
+		int ParseValues(const char* begin, const char* end, float* values, int nValues);
+
+		// Parse the next number (float or int) on a line and move past it.
+		// Returns false if there is none, or if it is not followed by a 
+		// separator or the end of the line (e.g. a fraction for an int).
+		template <class T>
+		bool ParseValue(const char*& position, const char* end, T& value);
+
+		static inline bool IsSeparator(char character){
+			return(character == ',' || character == ' ' || character == '\t' || character == '\r');
+		}
+
+		// Whether only separators are left on the line.
+		bool AtLineEnd(const char* position, const char* end);
+
+		FILE* mFile;
+		vector<char> mBuffer;
+		size_t mChunkSize;
+		size_t mPosition; // start of the unread part of the buffer
+		size_t mEnd; // end of the data in the buffer
+		bool mEndOfFile;
+		int mLineNumber;
+
+		vector<float> mPMTX;
+		vector<float> mPMTY;
+		vector<float> mPMTZ;
+		float mAttenuationLength;
+
+};
+
+#endif
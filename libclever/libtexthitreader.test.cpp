@@ -0,0 +1,136 @@
+/**************************************************
+ * Unit tests for TextHitReader class
+ *
+ * *************************************************/
+
+#include <libtexthitreader.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+namespace{
+
+string WriteFile(string name, string text)
+{
+	string filename = testing::TempDir() + name;
+	FILE* file = fopen(filename.c_str(), "w");
+	fputs(text.c_str(), file);
+	fclose(file);
+	return(filename);
+}
+
+TEST(TextHitReaderTest,TestReadEvents){
+
+	string geometry = WriteFile("clever_geometry.csv",
+		"# attenuation length\n"
+		"8000\n"
+		"# x, y, z\n"
+		"100, 0, -50\n"
+		"0 100 0\n"
+		"-100,0,50.5\n");
+	string hits = WriteFile("clever_hits.csv",
+		"# event, subEvent, nHits\n"
+		"3, 0, 2\n"
+		"2, 10.25, 1.5\n"
+		"0, -3e1, 2\n"
+		"\n"
+		"3, 1, 0\n"
+		"4,0,1\n"
+		"1,7.5,0.25");
+
+	// A small chunk size makes lines cross the chunk boundaries.
+	for (size_t chunkSize : {8, 1 << 20})
+	{
+		TextHitReader reader(chunkSize);
+		vector<float> pmtx, pmty, pmtz;
+		EXPECT_EQ(reader.ReadGeometry(geometry.c_str(), pmtx, pmty, pmtz), 3);
+		EXPECT_FLOAT_EQ(pmtz[2], 50.5);
+		EXPECT_FLOAT_EQ(reader.AttenuationLength(), 8000);
+
+		EXPECT_EQ(reader.Open(hits.c_str()), 0);
+		EventHits event;
+		EXPECT_EQ(reader.ReadEvent(event), 2);
+		EXPECT_EQ(event.event, 3);
+		EXPECT_EQ(event.subEvent, 0);
+		EXPECT_FLOAT_EQ(event.times[0], 10.25);
+		EXPECT_FLOAT_EQ(event.charges[0], 1.5);
+		EXPECT_FLOAT_EQ(event.pmtx[0], -100);
+		EXPECT_FLOAT_EQ(event.times[1], -30);
+		EXPECT_FLOAT_EQ(event.pmtz[1], -50);
+
+		EXPECT_EQ(reader.ReadEvent(event), 0);
+		EXPECT_EQ(event.subEvent, 1);
+		EXPECT_EQ(event.nhits(), 0);
+
+		// The last line has no newline.
+		EXPECT_EQ(reader.ReadEvent(event), 1);
+		EXPECT_EQ(event.event, 4);
+		EXPECT_FLOAT_EQ(event.charges[0], 0.25);
+		EXPECT_EQ(reader.ReadEvent(event), TextHitReader::sEndOfFile);
+	}
+
+}
+
+TEST(TextHitReaderTest,TestErrors){
+
+	string geometry = WriteFile("clever_geometry.csv", "0,0,0\n");
+	string hits = WriteFile("clever_bad_hits.csv",
+		"1, 0, 2\n"
+		"0, 1.0, 1.0\n"
+		"1, 2.0, 1.0\n"
+		"2, 0, 1\n"
+		"0, x, 1.0\n"
+		"3.5, 0, 1\n"
+		"4, 0, 1\n"
+		"0.5, 1.0, 1.0\n"
+		"5, 0, 1\n"
+		"0, 1.0, 1.0 2\n"
+		"6, 0, 1\n"
+		"0, 1.0, 1.0,\n");
+	TextHitReader reader;
+	vector<float> pmtx, pmty, pmtz;
+	EXPECT_EQ(reader.ReadGeometry(geometry.c_str(), pmtx, pmty, pmtz), 1);
+	EXPECT_FLOAT_EQ(reader.AttenuationLength(), 0);
+	EXPECT_EQ(reader.Open(hits.c_str()), 0);
+
+	// PMT id out of range.
+	EventHits event;
+	EXPECT_EQ(reader.ReadEvent(event), TextHitReader::sParseError);
+	EXPECT_EQ(reader.LineNumber(), 3);
+	// Not a number.
+	EXPECT_EQ(reader.ReadEvent(event), TextHitReader::sParseError);
+	EXPECT_EQ(reader.LineNumber(), 5);
+	// The event number, the number of hits and the PMT id are integers.
+	EXPECT_EQ(reader.ReadEvent(event), TextHitReader::sParseError);
+	EXPECT_EQ(reader.LineNumber(), 6);
+	EXPECT_EQ(reader.ReadEvent(event), TextHitReader::sParseError);
+	EXPECT_EQ(reader.LineNumber(), 8);
+	// Values left over.
+	EXPECT_EQ(reader.ReadEvent(event), TextHitReader::sParseError);
+	EXPECT_EQ(reader.LineNumber(), 10);
+	EXPECT_EQ(reader.ReadEvent(event), 1);
+	EXPECT_EQ(event.event, 6);
+
+	EXPECT_EQ(reader.Open((testing::TempDir() + "clever_missing.csv").c_str()), -1);
+
+}
+
+TEST(TextHitReaderTest,TestReadPDF){
+
+	string pdf = WriteFile("clever_pdf.csv",
+		"-1.5, 0.1\n"
+		"-0.5, 0.2\n"
+		"0.5, 0.4\n"
+		"1.5, 0.3\n");
+	TextHitReader reader;
+	vector<float> probabilityVector;
+	float tMin = 0, tMax = 0;
+	EXPECT_EQ(reader.ReadPDF(pdf.c_str(), probabilityVector, tMin, tMax), 4);
+	EXPECT_FLOAT_EQ(tMin, -2);
+	EXPECT_FLOAT_EQ(tMax, 2);
+	EXPECT_FLOAT_EQ(probabilityVector[2], 0.4);
+
+}
+
+}
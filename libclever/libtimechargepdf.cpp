@@ -0,0 +1,69 @@
+/**************************************************
+ * Stores the joint time-residual and charge pdf as
+ * a table of negative log likelihoods for lookup 
+ * during the search.
+ * Inputs: bin contents and ranges of a binned 2D pdf
+ * 		   (e.g. taken from a ROOT histogram by the caller).
+ * Outputs: -log(p) for a time residual and charge.
+ *
+ * *************************************************/
+#include <iostream>
+#include <math.h>
+#include <numeric> //accumulate()
+#include <algorithm> //min_element()
+
+#include <libconstants.hpp>
+#include <libtimechargepdf.hpp>
+
+//constructor function
+TimeChargePDF::TimeChargePDF()
+{
+	// Start with a single flat bin so that lookups are always valid.
+	vector<float> flatVector = {1.};
+	SetPDF(flatVector, 1, -1., 1., 1, 0.1, 10.);
+}
+
+//destructor function
+TimeChargePDF::~TimeChargePDF()
+{
+}
+
+void TimeChargePDF::SetPDF(vector<float>& probabilityVector, int nTimeBins, float tMin, float tMax, int nChargeBins, float qMin, float qMax)
+{
+	mNTimeBins = nTimeBins;
+	mNChargeBins = nChargeBins;
+	mTMin = tMin;
+	float timeBinWidth = (tMax - tMin)/nTimeBins;
+	mInverseTimeBinWidth = 1./timeBinWidth;
+	mLogQMin = log(qMin);
+	float logChargeBinWidth = (log(qMax) - mLogQMin)/nChargeBins;
+	mInverseLogChargeBinWidth = 1./logChargeBinWidth;
+
+	// Normalise the pdf over time and log charge and take the negative log
+	// of each bin. Empty bins are set to the minimum probability so that 
+	// the log is defined.
+	int nBins = nTimeBins*nChargeBins;
+	float integral = accumulate(probabilityVector.begin(), probabilityVector.begin()+nBins, 0.0);
+	float binArea = timeBinWidth*logChargeBinWidth;
+	mNLLVector.resize(nBins);
+	for (int bin = 0; bin < nBins; bin++)
+	{
+		float probability = probabilityVector[bin]/(integral*binArea);
+		if (integral <= 0 || probability < libConstants::sMinimumProbabilityPDF)
+		{
+			probability = libConstants::sMinimumProbabilityPDF;
+		}
+		mNLLVector[bin] = -log(probability);
+	}
+	mMinimumNLL = *min_element(mNLLVector.begin(), mNLLVector.end());
+}
+
+int TimeChargePDF::FindChargeBin(float charge)
+{
+	if (charge <= 0)
+	{
+		return(0);
+	}
+	int bin = (int)((log(charge) - mLogQMin)*mInverseLogChargeBinWidth);
+	return((bin < 0) ? 0 : ((bin >= mNChargeBins) ? mNChargeBins-1 : bin));
+}
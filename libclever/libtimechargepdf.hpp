@@ -0,0 +1,107 @@
+#ifndef LIBTIMECHARGEPDF_H
+#define LIBTIMECHARGEPDF_H
+
+//includes
+#include <vector>
+
+using namespace std;
+
+/*
+ * class TimeChargePDF
+ * Stores the joint time-residual and charge probability density function
+ * as a dense table of negative log likelihoods, one row of time-residual 
+ * bins per charge bin. The charge axis is log-spaced. The charge row of 
+ * each hit does not depend on the vertex, so it is found once per event
+ * (ChargeRowOffset) and each lookup then only resolves the time residual.
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class TimeChargePDF
+{
+
+
+	// define the public functions and variables
+	public:
+
+		TimeChargePDF();
+		~TimeChargePDF();
+
+		// Fill the table from the bin contents of a binned 2D pdf, stored
+		// charge bin by charge bin (nChargeBins rows of nTimeBins), covering
+		// the time residual range [tMin, tMax) and the charge range 
+		// [qMin, qMax) in log-spaced bins (qMin > 0).
+		void SetPDF(vector<float>& probabilityVector, int nTimeBins, float tMin, float tMax, int nChargeBins, float qMin, float qMax);
+
+		// Charge bin for a charge. Charges outside the range take the 
+		// nearest edge bin.
+		int FindChargeBin(float charge);
+
+		// Offset of the row for a charge in the table, to be passed to the
+		// lookups below.
+		inline int ChargeRowOffset(float charge)
+		{
+			return(FindChargeBin(charge)*mNTimeBins);
+		}
+
+		// Negative log likelihood for a time residual in the charge row at
+		// rowOffset, interpolated linearly between time bin centres. 
+		// Residuals outside the range take the value of the nearest edge bin.
+		inline float NegativeLogLikelihood(float residual, int rowOffset)
+		{
+			float position = (residual - mTMin)*mInverseTimeBinWidth - 0.5;
+			if (position <= 0)
+			{
+				return(mNLLVector[rowOffset]);
+			}
+			if (position >= mNTimeBins-1)
+			{
+				return(mNLLVector[rowOffset+mNTimeBins-1]);
+			}
+			int bin = (int)position;
+			float fraction = position - bin;
+			float nll = mNLLVector[rowOffset+bin];
+			return(nll + fraction*(mNLLVector[rowOffset+bin+1]-nll));
+		}
+
+		// Negative log likelihood of the bin containing the residual, without
+		// interpolation.
+		inline float NegativeLogLikelihoodBinned(float residual, int rowOffset)
+		{
+			int bin = (int)((residual - mTMin)*mInverseTimeBinWidth);
+			bin = (bin < 0) ? 0 : ((bin >= mNTimeBins) ? mNTimeBins-1 : bin);
+			return(mNLLVector[rowOffset+bin]);
+		}
+
+		inline int NTimeBins(void){
+			return(mNTimeBins);
+		}
+
+		inline int NChargeBins(void){
+			return(mNChargeBins);
+		}
+
+		// Smallest negative log likelihood in the table, i.e. a lower bound
+		// on the contribution of any hit.
+		inline float MinimumNegativeLogLikelihood(void){
+			return(mMinimumNLL);
+		}
+
+	// define the private functions and variables
+	private:
+
+		int mNTimeBins;
+		int mNChargeBins;
+		float mTMin;
+		float mInverseTimeBinWidth;
+		float mLogQMin;
+		float mInverseLogChargeBinWidth;
+		float mMinimumNLL;
+		vector<float> mNLLVector; // -log(probability) per bin, row per charge bin
+
+};
+
+#endif
@@ -0,0 +1,52 @@
+/**************************************************
+ * Unit tests for TimeChargePDF class
+ *
+ * *************************************************/
+
+#include <libtimechargepdf.hpp>
+#include <libconstants.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+namespace{
+
+TEST(TimeChargePDFTest,TestChargeBins){
+
+	// Four log-spaced charge bins between 1 and 10000 p.e.: one per decade.
+	vector<float> contents(2*4,1);
+	TimeChargePDF pdf;
+	pdf.SetPDF(contents,2,0,2,4,1,10000);
+
+	EXPECT_EQ(pdf.FindChargeBin(0.5),0);
+	EXPECT_EQ(pdf.FindChargeBin(5),0);
+	EXPECT_EQ(pdf.FindChargeBin(50),1);
+	EXPECT_EQ(pdf.FindChargeBin(5000),3);
+	EXPECT_EQ(pdf.FindChargeBin(1e6),3);
+	EXPECT_EQ(pdf.ChargeRowOffset(500),4);
+
+}
+
+TEST(TimeChargePDFTest,TestLookup){
+
+	// Two time bins (1 ns) and two charge bins (1-10 and 10-100 p.e.).
+	// Low charge favours the first time bin, high charge the second.
+	vector<float> contents = {3,1,1,3};
+	TimeChargePDF pdf;
+	pdf.SetPDF(contents,2,0,2,2,1,100);
+
+	// Normalised over time and log(charge): p = content/(8*log(10)).
+	float nllLow = -log(1/(8*log(10)));
+	float nllHigh = -log(3/(8*log(10)));
+	int lowRow = pdf.ChargeRowOffset(2);
+	int highRow = pdf.ChargeRowOffset(20);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(0.5,lowRow),nllHigh,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(1.5,lowRow),nllLow,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(1.5,highRow),nllHigh,1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihood(1.0,highRow),0.5*(nllLow+nllHigh),1e-5);
+	EXPECT_NEAR(pdf.NegativeLogLikelihoodBinned(1.2,highRow),nllHigh,1e-5);
+	EXPECT_NEAR(pdf.MinimumNegativeLogLikelihood(),nllHigh,1e-5);
+
+}
+
+}
@@ -0,0 +1,196 @@
+//vim :set noexpandtab tabstop=4 wrap
+
+//includes
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <libconstants.hpp>
+#include <libtzero.hpp>
+
+// ************************************************************************** //
+// Strategies for finding the emission time t0 of a test vertex from the
+// t-tof values of the hits. Previously this was always done by filling a
+// ROOT histogram and fitting a parabola to the peak, which cost as much as
+// the likelihood sum itself.
+
+
+unique_ptr<TZeroEstimator> TZeroEstimator::Create(int method)
+{
+	if (method == sMeanShift)
+	{
+		return(make_unique<MeanShiftTZero>());
+	}
+	if (method == sIncremental)
+	{
+		return(make_unique<IncrementalTZero>());
+	}
+	return(make_unique<PeakFitTZero>());
+}
+
+int TZeroEstimator::FillHistogram(vector<float>& ttofVector)
+{
+	// Histogram the t-tof values with the peak-fit bin width. The range
+	// follows the t-tof values, but the buffer only grows, so after the
+	// first few test points no allocation is needed.
+	float binWidth = libConstants::sBinwidthPeakFitTTOF;
+	auto minmax = minmax_element(ttofVector.begin(),ttofVector.end());
+	mHistogramMin = *minmax.first;
+	mNBins = (int)((*minmax.second - mHistogramMin)/binWidth) + 1;
+	if ((int)mHistogram.size() < mNBins)
+	{
+		mHistogram.resize(mNBins);
+	}
+	fill(mHistogram.begin(), mHistogram.begin()+mNBins, 0);
+
+	for (float ttof : ttofVector)
+	{
+		mHistogram[(int)((ttof - mHistogramMin)/binWidth)]++;
+	}
+
+	// Find the peak time bin (i.e. the one with most hits)
+	return(max_element(mHistogram.begin(), mHistogram.begin()+mNBins) - mHistogram.begin());
+}
+
+
+//************************************************************************** //
+// Peak fit: the original method.
+
+float PeakFitTZero::FindTZero(vector<float>& ttofVector, vector<float>&)
+{
+	// Find the peak time in the t-tof vector.
+	// This is the time-residual range (default 0.4 ns bin width)
+	// with the highest number of hits.
+	// BONSAI only include hits with t-tof > 0 but we'll look at all hits here.
+	if (ttofVector.empty())
+	{
+		return(0);
+	}
+	float binWidth = libConstants::sBinwidthPeakFitTTOF;
+	int maxbin = FillHistogram(ttofVector);
+	// Define the approximate peak time as the centre of the peak time bin
+	float peakTTof = mHistogramMin + (maxbin+0.5)*binWidth;
+
+	// Do a least squares fit of a parabola to the bins within the fit range
+	// of the peak and take the position of its maximum.
+	// Default range for peak fit +/- 12 bins
+	int range = (int)libConstants::sRangePeakFitTTOF;
+	int firstBin = max(0, maxbin-range);
+	int lastBin = min(mNBins-1, maxbin+range);
+	// Sums for the normal equations, with x measured from the peak bin
+	// in units of bins.
+	double s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+	double y0 = 0, y1 = 0, y2 = 0;
+	for (int bin = firstBin; bin <= lastBin; bin++)
+	{
+		double x = bin - maxbin;
+		double y = mHistogram[bin];
+		s0 += 1; s1 += x; s2 += x*x; s3 += x*x*x; s4 += x*x*x*x;
+		y0 += y; y1 += x*y; y2 += x*x*y;
+	}
+	// Solve for y = a + bx + cx^2 by Cramer's rule.
+	double det = s0*(s2*s4-s3*s3) - s1*(s1*s4-s2*s3) + s2*(s1*s3-s2*s2);
+	if (fabs(det) > 0)
+	{
+		double b = (s0*(y1*s4-s3*y2) - y0*(s1*s4-s2*s3) + s2*(s1*y2-y1*s2))/det;
+		double c = (s0*(s2*y2-y1*s3) - s1*(s1*y2-y1*s2) + y0*(s1*s3-s2*s2))/det;
+		double xPeak = (c < 0) ? -b/(2*c) : 0;
+		// Only trust the fit if the maximum is within the fit range.
+		if (xPeak >= firstBin-maxbin && xPeak <= lastBin-maxbin)
+		{
+			peakTTof += xPeak*binWidth;
+		}
+	}
+
+	return(peakTTof);
+}
+
+
+//************************************************************************** //
+// Mean shift: no fit and no sort, just a few O(N) passes.
+
+float MeanShiftTZero::FindTZero(vector<float>& ttofVector, vector<float>&)
+{
+	if (ttofVector.empty())
+	{
+		return(0);
+	}
+	// Start from the centre of the histogram mode.
+	int maxbin = FillHistogram(ttofVector);
+	float t0 = mHistogramMin + (maxbin+0.5)*libConstants::sBinwidthPeakFitTTOF;
+	return(MeanShift(ttofVector, t0));
+}
+
+float MeanShiftTZero::MeanShift(vector<float>& ttofVector, float t0)
+{
+	float bandwidth = libConstants::sMeanShiftBandwidth;
+	for (int iteration = 0; iteration < libConstants::sMeanShiftIterations; iteration++)
+	{
+		float sum = 0;
+		int n = 0;
+		for (float ttof : ttofVector)
+		{
+			if (fabs(ttof - t0) < bandwidth)
+			{
+				sum += ttof;
+				n++;
+			}
+		}
+		if (n == 0)
+		{
+			break;
+		}
+		float shift = sum/n - t0;
+		t0 += shift;
+		if (fabs(shift) < libConstants::sMeanShiftPrecision)
+		{
+			break;
+		}
+	}
+	return(t0);
+}
+
+
+//************************************************************************** //
+// Incremental: when the vertex has only moved a little since the last call
+// (e.g. between the vertices of a dodecahedron) each t-tof has changed by at
+// most distance/c, so the previous t0 is a good starting point and the
+// histogram pass can be skipped.
+
+IncrementalTZero::IncrementalTZero()
+{
+	Reset();
+}
+
+void IncrementalTZero::Reset()
+{
+	mHasPrevious = false;
+}
+
+float IncrementalTZero::FindTZero(vector<float>& ttofVector, vector<float>& vertexVector)
+{
+	if (ttofVector.empty())
+	{
+		return(0);
+	}
+	float dx = vertexVector[0] - mPreviousX;
+	float dy = vertexVector[1] - mPreviousY;
+	float dz = vertexVector[2] - mPreviousZ;
+	float maxDistance = libConstants::sIncrementalTZeroDistance;
+
+	float t0;
+	if (mHasPrevious && dx*dx+dy*dy+dz*dz < maxDistance*maxDistance)
+	{
+		t0 = MeanShift(ttofVector, mPreviousTZero);
+	}
+	else
+	{
+		t0 = MeanShiftTZero::FindTZero(ttofVector, vertexVector);
+	}
+
+	mHasPrevious = true;
+	mPreviousX = vertexVector[0];
+	mPreviousY = vertexVector[1];
+	mPreviousZ = vertexVector[2];
+	mPreviousTZero = t0;
+	return(t0);
+}
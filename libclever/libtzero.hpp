@@ -0,0 +1,110 @@
+#ifndef LIBTZERO_H
+#define LIBTZERO_H
+
+//includes
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+/*
+ * class TZeroEstimator
+ * Interface for the strategies which estimate the emission time t0 of a
+ * test vertex from the time - time of flight (t-tof) values of the hits.
+ * The strategy used by the likelihood is selected with
+ * libConstants::sTZeroMethod so that speed and resolution can be compared:
+ * 	PeakFitTZero		histogram of t-tof and parabola fit to the peak
+ * 	MeanShiftTZero		histogram mode refined by mean shift (no fit)
+ * 	IncrementalTZero	mean shift started from the previous t0 when the
+ * 						vertex has only moved slightly
+ *
+ * Author	L.Kneale
+ * Date		26/04/2022
+ * Contact	e.kneale@sheffield.ac.uk
+ */
+
+
+class TZeroEstimator
+{
+
+
+	// define the public functions and variables
+	public:
+
+		virtual ~TZeroEstimator() {};
+
+		// Main function called from outside class.
+		// Returns t0 for the vertex {x, y, z, ...} given the t-tof values.
+		virtual float FindTZero(vector<float>& ttofVector, vector<float>& vertexVector) = 0;
+
+		// Clear any state kept between calls (e.g. at the start of an event).
+		virtual void Reset() {};
+
+		// Values of libConstants::sTZeroMethod
+		static const int sPeakFit = 0;
+		static const int sMeanShift = 1;
+		static const int sIncremental = 2;
+
+		// Create the estimator for the given method.
+		static unique_ptr<TZeroEstimator> Create(int method);
+
+	protected:
+
+		// Fill the t-tof histogram (bin width sBinwidthPeakFitTTOF) and
+		// return the index of the bin with the most hits. The histogram
+		// buffer is kept between calls so that it is not reallocated for
+		// every test point.
+		int FillHistogram(vector<float>& ttofVector);
+
+		vector<int> mHistogram;
+		float mHistogramMin;
+		int mNBins;
+
+};
+
+
+class PeakFitTZero : public TZeroEstimator
+{
+
+	public:
+
+		float FindTZero(vector<float>& ttofVector, vector<float>& vertexVector);
+
+};
+
+
+class MeanShiftTZero : public TZeroEstimator
+{
+
+	public:
+
+		float FindTZero(vector<float>& ttofVector, vector<float>& vertexVector);
+
+		// Move t0 to the mean of the t-tof values within the mean shift
+		// bandwidth until it stops moving.
+		float MeanShift(vector<float>& ttofVector, float t0);
+
+};
+
+
+class IncrementalTZero : public MeanShiftTZero
+{
+
+	public:
+
+		IncrementalTZero();
+
+		float FindTZero(vector<float>& ttofVector, vector<float>& vertexVector);
+		void Reset();
+
+	private:
+
+		bool mHasPrevious;
+		float mPreviousX;
+		float mPreviousY;
+		float mPreviousZ;
+		float mPreviousTZero;
+
+};
+
+#endif
@@ -0,0 +1,62 @@
+/**************************************************
+ * Unit tests for the t0 estimators
+ *
+ * *************************************************/
+
+#include <libtzero.hpp>
+#include <libconstants.hpp>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+namespace{
+
+// t-tof values peaked at 10 ns with a few early and late hits.
+vector<float> ttofs = {2.0,9.4,9.6,9.8,9.9,10.0,10.0,10.1,10.2,10.4,10.6,14.0,21.0};
+vector<float> vertex = {0,0,0};
+
+TEST(TZeroTest,TestPeakFitTZero){
+
+	PeakFitTZero peakfit;
+	float t0 = peakfit.FindTZero(ttofs,vertex);
+	EXPECT_NEAR(t0,10.0,0.4);
+
+}
+
+TEST(TZeroTest,TestMeanShiftTZero){
+
+	MeanShiftTZero meanshift;
+	float t0 = meanshift.FindTZero(ttofs,vertex);
+	EXPECT_NEAR(t0,10.0,0.2);
+
+}
+
+TEST(TZeroTest,TestIncrementalTZero){
+
+	IncrementalTZero incremental;
+	float t0 = incremental.FindTZero(ttofs,vertex);
+	EXPECT_NEAR(t0,10.0,0.2);
+
+	// Move the vertex slightly and shift all of the t-tof values by 1 ns:
+	// the estimate should follow without a new histogram.
+	vector<float> shifted = ttofs;
+	for (float& ttof : shifted)
+	{
+		ttof += 1.0;
+	}
+	vector<float> nearby = {10,0,0};
+	float t0Shifted = incremental.FindTZero(shifted,nearby);
+	EXPECT_NEAR(t0Shifted,11.0,0.2);
+
+}
+
+TEST(TZeroTest,TestCreate){
+
+	unique_ptr<TZeroEstimator> estimator = TZeroEstimator::Create(TZeroEstimator::sMeanShift);
+	EXPECT_NE(dynamic_cast<MeanShiftTZero*>(estimator.get()),nullptr);
+	estimator = TZeroEstimator::Create(TZeroEstimator::sPeakFit);
+	EXPECT_NE(dynamic_cast<PeakFitTZero*>(estimator.get()),nullptr);
+
+}
+
+}